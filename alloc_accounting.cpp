@@ -0,0 +1,106 @@
+/**
+ * Polynomial Solver - allocation accounting implementation
+ *
+ * Every replaceable form of operator new and delete is defined here so the
+ * standard library cannot mix our malloc-based allocations with its own.
+ */
+
+#include "alloc_accounting.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace alloc_accounting {
+
+namespace {
+
+std::atomic<bool> gEnabled{false};
+std::atomic<std::uint64_t> gAllocations[kSlots];
+std::atomic<std::uint64_t> gBytes[kSlots];
+thread_local int tSlot = kUnattributed;
+
+} // namespace
+
+void enable(bool on) {
+    gEnabled.store(on, std::memory_order_relaxed);
+}
+
+bool enabled() {
+    return gEnabled.load(std::memory_order_relaxed);
+}
+
+int setSlot(int slot) {
+    int previous = tSlot;
+    tSlot = slot >= 0 && slot < kSlots ? slot : kUnattributed;
+    return previous;
+}
+
+Counts read(int slot) {
+    Counts counts;
+    if (slot < 0 || slot >= kSlots) return counts;
+    counts.allocations = gAllocations[slot].load(std::memory_order_relaxed);
+    counts.bytes = gBytes[slot].load(std::memory_order_relaxed);
+    return counts;
+}
+
+} // namespace alloc_accounting
+
+namespace {
+
+inline void account(std::size_t size) {
+    using namespace alloc_accounting;
+    if (!gEnabled.load(std::memory_order_relaxed)) return;
+    gAllocations[tSlot].fetch_add(1, std::memory_order_relaxed);
+    gBytes[tSlot].fetch_add(size, std::memory_order_relaxed);
+}
+
+void* allocate(std::size_t size) {
+    account(size);
+    void* p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* allocateAligned(std::size_t size, std::align_val_t alignment) {
+    account(size);
+    std::size_t align = static_cast<std::size_t>(alignment);
+    if (align < sizeof(void*)) align = sizeof(void*);
+    // aligned_alloc wants a multiple of the alignment
+    void* p = std::aligned_alloc(align, (size + align - 1) / align * align);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+} // namespace
+
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return allocateAligned(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return allocateAligned(size, alignment); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try { return allocate(size); } catch (...) { return nullptr; }
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try { return allocate(size); } catch (...) { return nullptr; }
+}
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    try { return allocateAligned(size, alignment); } catch (...) { return nullptr; }
+}
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    try { return allocateAligned(size, alignment); } catch (...) { return nullptr; }
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
@@ -0,0 +1,42 @@
+/**
+ * Polynomial Solver - allocation accounting
+ *
+ * Replaces the global operator new/delete of the program it is linked
+ * into (the CLI, not libpolysolver) with malloc-backed versions that, once
+ * enabled, count allocations and requested bytes per slot. Each thread
+ * names the slot its allocations go to; --stats uses one slot per phase.
+ * While disabled the only cost is one relaxed atomic load per allocation.
+ */
+
+#ifndef ALLOC_ACCOUNTING_H
+#define ALLOC_ACCOUNTING_H
+
+#include <cstdint>
+
+namespace alloc_accounting {
+
+constexpr int kSlots = 8;
+constexpr int kUnattributed = kSlots - 1;   // allocations outside any named slot
+
+struct Counts {
+    std::uint64_t allocations = 0;
+    std::uint64_t bytes = 0;
+};
+
+void enable(bool on);
+bool enabled();
+
+/**
+ * Attribute the calling thread's later allocations to a slot
+ * @return: The previous slot, for restoring it
+ */
+int setSlot(int slot);
+
+/**
+ * Totals of a slot since the program started counting
+ */
+Counts read(int slot);
+
+} // namespace alloc_accounting
+
+#endif // ALLOC_ACCOUNTING_H
@@ -0,0 +1,386 @@
+/**
+ * Polynomial Solver - arithmetic policies for Lagrange interpolation
+ *
+ * PolynomialSolver::interpolate is written once as a template over a
+ * policy: a value type plus static inline operations on it, so every
+ * instantiation compiles to straight-line code with no virtual dispatch in
+ * the inner loops. A new backend is a new policy; parsing and the CLI do
+ * not change.
+ *
+ *   LongDoubleArithmetic         rounded reals (the historical float path)
+ *   Int128Arithmetic             exact integers, throws past 127 bits
+ *   BigIntArithmetic             exact integers of any size
+ *   PrimeFieldArithmetic<P>      integers mod a prime P < 2^63 (Mersenne61Arithmetic: 2^61 - 1)
+ *   GF256Arithmetic              GF(2^8), AES polynomial; ids 1-255, byte values
+ *   RnsArithmetic                residues mod three 61-62 bit primes (Z/M, M ~ 2^184)
+ *
+ * A policy provides:
+ *   Value                        the number type
+ *   kExact, kField               exact arithmetic; division by any nonzero value
+ *   kName                        short label for benchmarks
+ *   fromInt, fromBigInt          map an id or a decoded share value
+ *   isZero, add, sub, mul        in place: a += b etc.
+ *   mulDifference(a, b, c)       a *= (b - c)
+ *   div                          fields only: a /= b
+ *   gcd, divExact                exact rings only
+ */
+
+#ifndef ARITHMETIC_H
+#define ARITHMETIC_H
+
+#include "bigint.h"
+
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+/**
+ * An (x, y) point of the polynomial with y in the policy's value type
+ */
+template <class Arithmetic>
+struct BasicPoint {
+    long long x;
+    typename Arithmetic::Value y;
+
+    BasicPoint(long long x_val, typename Arithmetic::Value y_val) : x(x_val), y(std::move(y_val)) {}
+};
+
+struct LongDoubleArithmetic {
+    using Value = long double;
+    static constexpr bool kExact = false;
+    static constexpr bool kField = true;
+    static constexpr const char* kName = "float";
+
+    static Value fromInt(long long value) { return (Value)value; }
+    static Value fromBigInt(const BigInt& value) { return value.toLongDouble(); }
+    static bool isZero(Value a) { return a == 0.0L; }
+    static void add(Value& a, Value b) { a += b; }
+    static void sub(Value& a, Value b) { a -= b; }
+    static void mul(Value& a, Value b) { a *= b; }
+    static void mulDifference(Value& a, Value b, Value c) { a *= b - c; }
+
+    /**
+     * @throws invalid_argument: For a divisor too close to zero
+     */
+    static void div(Value& a, Value b) {
+        if (fabsl(b) < 1e-15L) {
+            throw std::invalid_argument("Points too close together for stable interpolation");
+        }
+        a /= b;
+    }
+};
+
+/**
+ * Exact integers in a machine register pair; every operation that would
+ * leave the signed 128-bit range throws overflow_error instead of wrapping
+ */
+struct Int128Arithmetic {
+    using Value = __int128;
+    static constexpr bool kExact = true;
+    static constexpr bool kField = false;
+    static constexpr const char* kName = "int128";
+
+    static Value fromInt(long long value) { return value; }
+
+    /**
+     * @throws overflow_error: When the value needs more than 127 bits
+     */
+    static Value fromBigInt(const BigInt& value) {
+        const std::vector<BigInt::Limb>& limbs = value.limbs();
+        if (limbs.size() > 2 || (limbs.size() == 2 && limbs[1] >> 63)) overflow();
+        unsigned __int128 magnitude = 0;
+        for (size_t i = limbs.size(); i-- > 0;) magnitude = magnitude << 64 | limbs[i];
+        return value.isNegative() ? -(Value)magnitude : (Value)magnitude;
+    }
+
+    static BigInt toBigInt(Value value) {
+        unsigned __int128 magnitude = value < 0 ? -(unsigned __int128)value : (unsigned __int128)value;
+        std::string hex(32, '0');
+        for (size_t i = hex.size(); i-- > 0; magnitude >>= 4) hex[i] = "0123456789abcdef"[(int)(magnitude & 15)];
+        BigInt result = BigInt::fromString(hex, 16);
+        return value < 0 ? -result : result;
+    }
+
+    static bool isZero(Value a) { return a == 0; }
+    static void add(Value& a, Value b) { if (__builtin_add_overflow(a, b, &a)) overflow(); }
+    static void sub(Value& a, Value b) { if (__builtin_sub_overflow(a, b, &a)) overflow(); }
+    static void mul(Value& a, Value b) { if (__builtin_mul_overflow(a, b, &a)) overflow(); }
+    static void mulDifference(Value& a, Value b, Value c) {
+        sub(b, c);
+        mul(a, b);
+    }
+
+    static Value gcd(Value a, Value b) {
+        unsigned __int128 x = a < 0 ? -(unsigned __int128)a : (unsigned __int128)a;
+        unsigned __int128 y = b < 0 ? -(unsigned __int128)b : (unsigned __int128)b;
+        while (y != 0) {
+            unsigned __int128 r = x % y;
+            x = y;
+            y = r;
+        }
+        if (x >> 127) overflow();   // gcd(-2^127, -2^127)
+        return (Value)x;
+    }
+
+    static Value divExact(Value a, Value b) {
+        if (b == 0) throw std::domain_error("Int128 division by zero");
+        if (b == -1) {
+            Value negated = 0;
+            sub(negated, a);
+            return negated;
+        }
+        return a / b;
+    }
+
+private:
+    [[noreturn]] static void overflow() {
+        throw std::overflow_error("Interpolation exceeds the 128-bit integer range");
+    }
+};
+
+struct BigIntArithmetic {
+    using Value = BigInt;
+    static constexpr bool kExact = true;
+    static constexpr bool kField = false;
+    static constexpr const char* kName = "bigint";
+
+    static Value fromInt(long long value) { return BigInt(value); }
+    static Value fromBigInt(const BigInt& value) { return value; }
+    static bool isZero(const Value& a) { return a.isZero(); }
+    static void add(Value& a, const Value& b) { a += b; }
+    static void sub(Value& a, const Value& b) { a -= b; }
+
+    static void mul(Value& a, const Value& b) {
+        // One-limb factors take the in-place word multiply, no allocation
+        if (b.fitsInt64()) {
+            a *= b.toInt64();
+        } else {
+            a *= b;
+        }
+    }
+
+    static void mulDifference(Value& a, const Value& b, const Value& c) {
+        long long difference;
+        if (b.fitsInt64() && c.fitsInt64() && !__builtin_sub_overflow(b.toInt64(), c.toInt64(), &difference)) {
+            a *= difference;
+        } else {
+            a *= b - c;
+        }
+    }
+
+    static Value gcd(const Value& a, const Value& b) { return BigInt::gcd(a, b); }
+    static Value divExact(const Value& a, const Value& b) { return BigInt::divExact(a, b); }
+};
+
+/**
+ * Integers modulo the prime P; values are kept reduced in [0, P)
+ */
+template <std::uint64_t P>
+struct PrimeFieldArithmetic {
+    static_assert(P > 2 && P < (1ULL << 63), "the modulus must be an odd prime below 2^63");
+
+    using Value = std::uint64_t;
+    static constexpr bool kExact = true;
+    static constexpr bool kField = true;
+    static constexpr const char* kName = "prime";
+    static constexpr std::uint64_t kModulus = P;
+
+    static Value fromInt(long long value) {
+        long long reduced = value % (long long)P;
+        return (Value)(reduced < 0 ? reduced + (long long)P : reduced);
+    }
+
+    static Value fromBigInt(const BigInt& value) {
+        const std::vector<BigInt::Limb>& limbs = value.limbs();
+        unsigned __int128 reduced = 0;
+        for (size_t i = limbs.size(); i-- > 0;) reduced = (reduced << 64 | limbs[i]) % P;
+        return value.isNegative() && reduced != 0 ? P - (Value)reduced : (Value)reduced;
+    }
+
+    static BigInt toBigInt(Value a) { return BigInt((long long)a); }
+
+    static bool isZero(Value a) { return a == 0; }
+    static void add(Value& a, Value b) {
+        a += b;
+        if (a >= P) a -= P;
+    }
+    static void sub(Value& a, Value b) { a = a >= b ? a - b : a + (P - b); }
+    static void mul(Value& a, Value b) { a = (Value)((unsigned __int128)a * b % P); }
+    static void mulDifference(Value& a, Value b, Value c) {
+        sub(b, c);
+        mul(a, b);
+    }
+
+    /**
+     * @throws invalid_argument: When b is zero mod P (e.g. two ids congruent mod P)
+     */
+    static void div(Value& a, Value b) {
+        if (b == 0) throw std::invalid_argument("Division by zero modulo " + std::to_string(P));
+        mul(a, power(b, P - 2));
+    }
+
+    static Value power(Value base, std::uint64_t exponent) {
+        Value result = 1;
+        for (; exponent > 0; exponent >>= 1) {
+            if (exponent & 1) mul(result, base);
+            mul(base, base);
+        }
+        return result;
+    }
+};
+
+using Mersenne61Arithmetic = PrimeFieldArithmetic<(1ULL << 61) - 1>;
+
+/**
+ * Log/exp tables of GF(2^8) over the generator 3, built at compile time
+ */
+struct GF256Tables {
+    std::uint8_t exp[512] = {};     // doubled so log a + log b needs no reduction
+    std::uint8_t log[256] = {};
+
+    constexpr GF256Tables() {
+        unsigned value = 1;
+        for (int i = 0; i < 255; i++) {
+            exp[i] = exp[i + 255] = (std::uint8_t)value;
+            log[value] = (std::uint8_t)i;
+            value ^= value << 1;    // times 3
+            if (value & 0x100) value ^= 0x11b;
+        }
+    }
+};
+inline constexpr GF256Tables kGF256Tables{};
+
+/**
+ * GF(2^8) with the AES polynomial x^8 + x^4 + x^3 + x + 1, the field of
+ * byte-wise Shamir splitting: ids are the nonzero elements 1-255 and every
+ * share value is one byte. Addition is XOR; multiplication and division
+ * are table lookups.
+ */
+struct GF256Arithmetic {
+    using Value = std::uint8_t;
+    static constexpr bool kExact = true;
+    static constexpr bool kField = true;
+    static constexpr const char* kName = "gf256";
+
+    /**
+     * @throws invalid_argument: Outside 0-255
+     */
+    static Value fromInt(long long value) {
+        if (value < 0 || value > 255) {
+            throw std::invalid_argument("Not a GF(2^8) element: " + std::to_string(value));
+        }
+        return (Value)value;
+    }
+
+    static Value fromBigInt(const BigInt& value) {
+        if (value.isNegative() || value.limbCount() > 1 || (value.limbCount() == 1 && value.limbs()[0] > 255)) {
+            throw std::invalid_argument("Not a GF(2^8) element: " + value.toString());
+        }
+        return (Value)value.toInt64();
+    }
+
+    static bool isZero(Value a) { return a == 0; }
+    static void add(Value& a, Value b) { a ^= b; }
+    static void sub(Value& a, Value b) { a ^= b; }
+    static void mul(Value& a, Value b) {
+        a = a == 0 || b == 0 ? 0 : kGF256Tables.exp[kGF256Tables.log[a] + kGF256Tables.log[b]];
+    }
+    static void mulDifference(Value& a, Value b, Value c) { mul(a, (Value)(b ^ c)); }
+
+    /**
+     * @throws invalid_argument: When b is zero
+     */
+    static void div(Value& a, Value b) {
+        if (b == 0) throw std::invalid_argument("Division by zero in GF(2^8)");
+        if (a != 0) a = kGF256Tables.exp[kGF256Tables.log[a] + 255 - kGF256Tables.log[b]];
+    }
+};
+
+/**
+ * Residue number system over the three NTT primes of the multiplier: each
+ * value is kept mod every prime independently (no carries between them),
+ * and toBigInt recombines by CRT. Exact for results with |P(x)| < M/2,
+ * about 2^183; shares may be of any size.
+ */
+struct RnsArithmetic {
+    using Field0 = PrimeFieldArithmetic<4179340454199820289ULL>;   // 29 * 2^57 + 1
+    using Field1 = PrimeFieldArithmetic<2485986994308513793ULL>;   // 69 * 2^55 + 1
+    using Field2 = PrimeFieldArithmetic<1945555039024054273ULL>;   // 27 * 2^56 + 1
+
+    struct Value {
+        std::uint64_t r0, r1, r2;
+
+        friend bool operator==(const Value& a, const Value& b) {
+            return a.r0 == b.r0 && a.r1 == b.r1 && a.r2 == b.r2;
+        }
+    };
+    static constexpr bool kExact = true;
+    static constexpr bool kField = true;    // Z/M is a product of fields; ids below the primes divide
+    static constexpr const char* kName = "rns";
+
+    static Value fromInt(long long value) {
+        return {Field0::fromInt(value), Field1::fromInt(value), Field2::fromInt(value)};
+    }
+    static Value fromBigInt(const BigInt& value) {
+        return {Field0::fromBigInt(value), Field1::fromBigInt(value), Field2::fromBigInt(value)};
+    }
+
+    /**
+     * The representative in (-M/2, M/2], by Garner's mixed-radix CRT
+     */
+    static BigInt toBigInt(const Value& a) {
+        const BigInt p0((long long)Field0::kModulus), p1((long long)Field1::kModulus),
+            p2((long long)Field2::kModulus);
+        // a = r0 + p0 * t1 + p0 * p1 * t2
+        std::uint64_t t1 = a.r1;
+        Field1::sub(t1, Field1::fromInt((long long)a.r0));
+        Field1::div(t1, Field1::fromInt((long long)Field0::kModulus));
+        std::uint64_t p0t1 = Field2::fromInt((long long)Field0::kModulus);
+        std::uint64_t p0p1 = p0t1;
+        Field2::mul(p0t1, Field2::fromInt((long long)t1));
+        Field2::mul(p0p1, Field2::fromInt((long long)Field1::kModulus));
+        std::uint64_t t2 = a.r2;
+        Field2::sub(t2, Field2::fromInt((long long)a.r0));
+        Field2::sub(t2, p0t1);
+        Field2::div(t2, p0p1);
+
+        BigInt modulus = p0 * p1 * p2;
+        BigInt result = (BigInt((long long)t2) * p1 + BigInt((long long)t1)) * p0 + BigInt((long long)a.r0);
+        if (modulus < result + result) result -= modulus;
+        return result;
+    }
+
+    static bool isZero(const Value& a) { return a.r0 == 0 && a.r1 == 0 && a.r2 == 0; }
+    static void add(Value& a, const Value& b) {
+        Field0::add(a.r0, b.r0);
+        Field1::add(a.r1, b.r1);
+        Field2::add(a.r2, b.r2);
+    }
+    static void sub(Value& a, const Value& b) {
+        Field0::sub(a.r0, b.r0);
+        Field1::sub(a.r1, b.r1);
+        Field2::sub(a.r2, b.r2);
+    }
+    static void mul(Value& a, const Value& b) {
+        Field0::mul(a.r0, b.r0);
+        Field1::mul(a.r1, b.r1);
+        Field2::mul(a.r2, b.r2);
+    }
+    static void mulDifference(Value& a, Value b, const Value& c) {
+        sub(b, c);
+        mul(a, b);
+    }
+
+    /**
+     * @throws invalid_argument: When b is zero modulo one of the primes
+     */
+    static void div(Value& a, const Value& b) {
+        Field0::div(a.r0, b.r0);
+        Field1::div(a.r1, b.r1);
+        Field2::div(a.r2, b.r2);
+    }
+};
+
+#endif // ARITHMETIC_H
@@ -0,0 +1,253 @@
+/**
+ * Polynomial Solver - host autotuning implementation
+ */
+
+#include "autotune.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <ostream>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+constexpr size_t kNever = SIZE_MAX / 4;
+
+/**
+ * Best per-call time over a few rounds, each long enough to be measurable
+ */
+double bestNsPerCall(const function<void()>& fn) {
+    using clock = chrono::steady_clock;
+    fn();   // warm caches and the per-thread power tables
+    double best = 1e300;
+    for (int round = 0; round < 3; round++) {
+        size_t calls = 0;
+        clock::time_point start = clock::now();
+        double elapsed = 0;
+        do {
+            fn();
+            calls++;
+            elapsed = (double)chrono::duration_cast<chrono::nanoseconds>(clock::now() - start).count();
+        } while (elapsed < 2e6 && calls < 100000);
+        best = min(best, elapsed / (double)calls);
+    }
+    return best;
+}
+
+BigInt randomLimbs(mt19937_64& rng, size_t limbs) {
+    static const char kHex[] = "0123456789abcdef";
+    string digits(limbs * 16, '0');
+    for (char& c : digits) c = kHex[rng() % 16];
+    digits[0] = 'f';
+    return BigInt::fromString(digits, 16);
+}
+
+/**
+ * Smallest sampled size from which `configure(n, true)` beats
+ * `configure(n, false)` at two consecutive sample sizes
+ */
+size_t findCrossover(const string& name, const string& slowName, size_t from, size_t to, double step,
+                     const function<void(size_t, bool)>& configure, mt19937_64& rng, ostream& log) {
+    size_t candidate = 0;
+    size_t n = from;
+    for (; n <= to; n = max(n + 1, (size_t)((double)n * step))) {
+        BigInt a = randomLimbs(rng, n);
+        BigInt b = randomLimbs(rng, n);
+        configure(n, false);
+        double slow = bestNsPerCall([&] { BigInt p = a * b; });
+        configure(n, true);
+        double fast = bestNsPerCall([&] { BigInt p = a * b; });
+
+        log << "  " << left << setw(10) << name << right << " n=" << setw(6) << n
+            << "  " << slowName << " " << fixed << setprecision(1) << slow / 1000.0 << "us  "
+            << name << " " << fast / 1000.0 << "us\n";
+        log.flush();
+
+        if (fast < slow) {
+            if (candidate != 0) return candidate;
+            candidate = n;
+        } else {
+            candidate = 0;
+        }
+    }
+    // No clear win inside the range: start past the largest size sampled
+    return candidate != 0 ? candidate : n;
+}
+
+size_t pickFastest(const string& name, const vector<size_t>& candidates,
+                   const function<double(size_t)>& timeWith, ostream& log) {
+    size_t best = candidates.front();
+    double bestNs = 1e300;
+    for (size_t candidate : candidates) {
+        double ns = timeWith(candidate);
+        log << "  " << left << setw(10) << name << right << " leaf=" << setw(4) << candidate
+            << "  " << fixed << setprecision(1) << ns / 1000.0 << "us\n";
+        log.flush();
+        if (ns < bestNs) {
+            bestNs = ns;
+            best = candidate;
+        }
+    }
+    return best;
+}
+
+bool parseSize(const string& text, size_t& value) {
+    if (text.empty() || text.find_first_not_of("0123456789") != string::npos || text.size() > 12) {
+        return false;
+    }
+    value = (size_t)strtoull(text.c_str(), nullptr, 10);
+    return value > 0;
+}
+
+size_t* tuningField(Tuning& tuning, const string& key) {
+    if (key == "mul.karatsuba") return &tuning.mul.karatsuba;
+    if (key == "mul.toom3") return &tuning.mul.toom3;
+    if (key == "mul.ntt") return &tuning.mul.ntt;
+    if (key == "convert.from_string_leaf_chunks") return &tuning.conversion.fromStringLeafChunks;
+    if (key == "convert.to_string_leaf_limbs") return &tuning.conversion.toStringLeafLimbs;
+    return nullptr;
+}
+
+string trimmed(const string& text) {
+    size_t start = text.find_first_not_of(" \t\r");
+    if (start == string::npos) return "";
+    size_t end = text.find_last_not_of(" \t\r");
+    return text.substr(start, end - start + 1);
+}
+
+} // namespace
+
+Tuning currentTuning() {
+    Tuning tuning;
+    tuning.mul = BigInt::mulThresholds();
+    tuning.conversion = BigInt::conversionThresholds();
+    return tuning;
+}
+
+void applyTuning(const Tuning& tuning) {
+    BigInt::setMulThresholds(tuning.mul);
+    BigInt::setConversionThresholds(tuning.conversion);
+}
+
+string defaultTuningPath() {
+    const char* explicitPath = getenv("POLYSOLVER_TUNING");
+    if (explicitPath && *explicitPath) return explicitPath;
+    const char* xdg = getenv("XDG_CONFIG_HOME");
+    if (xdg && *xdg) return string(xdg) + "/polysolver/tuning.conf";
+    const char* home = getenv("HOME");
+    if (home && *home) return string(home) + "/.config/polysolver/tuning.conf";
+    return "polysolver-tuning.conf";
+}
+
+bool loadTuning(const string& path, Tuning& tuning, string& error) {
+    ifstream file(path);
+    if (!file.is_open()) {
+        error = "Cannot open tuning file: " + path;
+        return false;
+    }
+
+    Tuning loaded = tuning;
+    string line;
+    int lineNumber = 0;
+    while (getline(file, line)) {
+        lineNumber++;
+        string content = trimmed(line.substr(0, line.find('#')));
+        if (content.empty()) continue;
+
+        size_t equals = content.find('=');
+        string key = trimmed(content.substr(0, equals));
+        size_t* field = equals == string::npos ? nullptr : tuningField(loaded, key);
+        size_t value = 0;
+        if (!field || !parseSize(trimmed(content.substr(equals + 1)), value)) {
+            error = path + ":" + to_string(lineNumber) + ": invalid tuning entry '" + content + "'";
+            return false;
+        }
+        *field = value;
+    }
+
+    tuning = loaded;
+    return true;
+}
+
+bool saveTuning(const string& path, const Tuning& tuning, string& error) {
+    filesystem::path parent = filesystem::path(path).parent_path();
+    error_code ec;
+    if (!parent.empty()) filesystem::create_directories(parent, ec);
+
+    ofstream file(path, ios::trunc);
+    if (!file.is_open()) {
+        error = "Cannot write tuning file: " + path;
+        return false;
+    }
+    file << "# Polynomial Solver algorithm crossovers, written by --autotune\n"
+         << "# Multiplication: smaller factor size in 64-bit limbs\n"
+         << "mul.karatsuba = " << tuning.mul.karatsuba << "\n"
+         << "mul.toom3 = " << tuning.mul.toom3 << "\n"
+         << "mul.ntt = " << tuning.mul.ntt << "\n"
+         << "# Conversion: largest operand handled by the quadratic loops\n"
+         << "convert.from_string_leaf_chunks = " << tuning.conversion.fromStringLeafChunks << "\n"
+         << "convert.to_string_leaf_limbs = " << tuning.conversion.toStringLeafLimbs << "\n";
+    file.close();
+    if (!file) {
+        error = "Cannot write tuning file: " + path;
+        return false;
+    }
+    return true;
+}
+
+Tuning autotune(ostream& log) {
+    const Tuning saved = currentTuning();
+    Tuning tuned = saved;
+    mt19937_64 rng(20250917);
+
+    // Each crossover is searched with the faster algorithms above it disabled
+    log << "Multiplication crossovers (smaller factor, limbs):\n";
+    tuned.mul.karatsuba = findCrossover(
+        "karatsuba", "schoolbook", 8, 256, 1.2,
+        [](size_t n, bool use) { BigInt::setMulThresholds({use ? n : n + 1, kNever, kNever}); },
+        rng, log);
+    tuned.mul.toom3 = findCrossover(
+        "toom3", "karatsuba", max<size_t>(tuned.mul.karatsuba * 2, 24), 4096, 1.25,
+        [&](size_t n, bool use) { BigInt::setMulThresholds({tuned.mul.karatsuba, use ? n : n + 1, kNever}); },
+        rng, log);
+    tuned.mul.ntt = findCrossover(
+        "ntt", "toom3", max<size_t>(tuned.mul.toom3, 256), 16384, 1.4,
+        [&](size_t n, bool use) {
+            BigInt::setMulThresholds({tuned.mul.karatsuba, tuned.mul.toom3, use ? n : n + 1});
+        },
+        rng, log);
+    BigInt::setMulThresholds(tuned.mul);
+
+    // Conversion leaves, timed on 40000-digit decimal numbers
+    log << "Conversion leaf sizes:\n";
+    string digits(40000, '0');
+    for (char& c : digits) c = (char)('0' + rng() % 10);
+    digits[0] = '9';
+    BigInt value = BigInt::fromString(digits, 10);
+    const vector<size_t> leaves = {4, 8, 16, 32, 64, 128};
+
+    tuned.conversion.fromStringLeafChunks = pickFastest("parse", leaves, [&](size_t leaf) {
+        ConversionThresholds t = tuned.conversion;
+        t.fromStringLeafChunks = leaf;
+        BigInt::setConversionThresholds(t);
+        return bestNsPerCall([&] { BigInt parsed = BigInt::fromString(digits, 10); });
+    }, log);
+    tuned.conversion.toStringLeafLimbs = pickFastest("print", leaves, [&](size_t leaf) {
+        ConversionThresholds t = tuned.conversion;
+        t.toStringLeafLimbs = leaf;
+        BigInt::setConversionThresholds(t);
+        return bestNsPerCall([&] { string printed = value.toString(10); });
+    }, log);
+
+    applyTuning(saved);
+    return tuned;
+}
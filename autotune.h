@@ -0,0 +1,57 @@
+/**
+ * Polynomial Solver - host autotuning of algorithm crossovers
+ *
+ * `--autotune` times the big integer kernels on this machine and writes the
+ * crossover sizes to a small `key = value` file; the CLI loads that file at
+ * startup so the engine picks algorithms by operand size for the host it
+ * runs on. Values are in limbs (64 bits) or base chunks, see bigint.h.
+ */
+
+#ifndef AUTOTUNE_H
+#define AUTOTUNE_H
+
+#include "bigint.h"
+
+#include <iosfwd>
+#include <string>
+
+/**
+ * Every runtime-tunable crossover of the engine
+ */
+struct Tuning {
+    MulThresholds mul;
+    ConversionThresholds conversion;
+};
+
+Tuning currentTuning();
+void applyTuning(const Tuning& tuning);
+
+/**
+ * Tuning file used when none is given: $POLYSOLVER_TUNING, else
+ * $XDG_CONFIG_HOME/polysolver/tuning.conf, else ~/.config/polysolver/tuning.conf
+ */
+std::string defaultTuningPath();
+
+/**
+ * Read a tuning file; keys missing from the file keep their value in `tuning`
+ * @param path: File written by saveTuning (or by hand)
+ * @param tuning: Updated in place
+ * @param error: Reason on failure
+ * @return: false when the file cannot be read or holds an unknown key or bad value
+ */
+bool loadTuning(const std::string& path, Tuning& tuning, std::string& error);
+
+/**
+ * Write a tuning file, creating its directory when needed
+ * @return: false (with error set) when the file cannot be written
+ */
+bool saveTuning(const std::string& path, const Tuning& tuning, std::string& error);
+
+/**
+ * Time the kernels on this host and return the crossovers that won.
+ * Takes several seconds; progress lines go to `log`. The process-wide
+ * thresholds are restored before returning.
+ */
+Tuning autotune(std::ostream& log);
+
+#endif // AUTOTUNE_H
@@ -0,0 +1,390 @@
+/**
+ * Polynomial Solver - benchmark harness implementation
+ */
+
+#include "bench.h"
+#include "output_writer.h"
+#include "polynomial_solver.h"
+#include "workload.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fcntl.h>
+#include <iomanip>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <unistd.h>
+
+using namespace std;
+
+namespace {
+
+using Clock = chrono::steady_clock;
+
+double medianOfSorted(const vector<double>& sorted) {
+    size_t n = sorted.size();
+    return n % 2 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2.0;
+}
+
+/**
+ * Unsigned integer following "key": at or after from, within [from, end)
+ */
+bool readField(const string& line, const string& key, size_t from, size_t end, unsigned long long& value) {
+    size_t pos = line.find("\"" + key + "\":", from);
+    if (pos == string::npos || pos >= end) return false;
+    pos += key.size() + 3;
+    if (pos >= line.size() || !isdigit((unsigned char)line[pos])) return false;
+    value = strtoull(line.c_str() + pos, nullptr, 10);
+    return true;
+}
+
+} // namespace
+
+const char* benchPhaseName(BenchPhase phase) {
+    switch (phase) {
+        case BenchPhase::Parse:       return "parse";
+        case BenchPhase::Convert:     return "convert";
+        case BenchPhase::Interpolate: return "interpolate";
+        case BenchPhase::Output:      return "output";
+        case BenchPhase::Total:       return "total";
+    }
+    return "unknown";
+}
+
+PhaseStats summarize(vector<uint64_t> samples) {
+    PhaseStats stats;
+    if (samples.empty()) return stats;
+
+    vector<double> sorted(samples.begin(), samples.end());
+    sort(sorted.begin(), sorted.end());
+    stats.median = medianOfSorted(sorted);
+    size_t rank = (size_t)ceil(0.99 * (double)sorted.size());
+    stats.p99 = sorted[max<size_t>(rank, 1) - 1];
+
+    vector<double> deviations;
+    deviations.reserve(sorted.size());
+    for (double sample : sorted) deviations.push_back(fabs(sample - stats.median));
+    sort(deviations.begin(), deviations.end());
+    stats.mad = medianOfSorted(deviations);
+    return stats;
+}
+
+vector<BenchCase> runBench(const BenchConfig& config, string* hardwareNote) {
+    PolynomialSolver solver;
+    solver.setBackend(config.backend);
+    DocumentTape tape;
+    SolveResult result;
+    WorkloadGenerator generator(config.seed);
+    vector<BenchCase> cases;
+
+    PerfCounterGroup counters;
+    PerfPhaseObserver observer(counters);
+    if (counters.available()) {
+        solver.setObserver(&observer);
+    } else if (hardwareNote) {
+        *hardwareNote = counters.unavailableReason();
+    }
+
+    // Output is rendered for real and written to /dev/null
+    int sink = open("/dev/null", O_WRONLY | O_CLOEXEC);
+    if (sink < 0) throw runtime_error("Cannot open /dev/null");
+    OutputWriter writer(sink, sink, OutputFormat::NDJSON);
+
+    for (int n : config.ns) {
+        for (int k : config.ks) {
+            if (k > n) continue;
+            for (int base : config.bases) {
+                for (int digits : config.digits) {
+                    WorkloadSpec spec;
+                    spec.n = n;
+                    spec.k = k;
+                    spec.bases = {base};
+                    spec.digits = (size_t)digits;
+                    GeneratedDocument generated = generator.next(spec);
+                    string json = generated.toJson();
+
+                    vector<uint64_t> samples[kBenchPhaseCount];
+                    vector<uint64_t> events[kSolvePhaseCount][kHardwareEventCount];
+                    for (int rep = -config.warmup; rep < config.repetitions; rep++) {
+                        observer.reset();
+                        solver.solveFromJSON(json, tape, result);
+                        Clock::time_point outputStart = Clock::now();
+                        writer.writeResult("bench", result);
+                        writer.flush();
+                        uint64_t outputNs = (uint64_t)chrono::duration_cast<chrono::nanoseconds>(
+                            Clock::now() - outputStart).count();
+
+                        if (rep == -config.warmup &&
+                            (!result.ok() || !result.exact || result.exactSecret != generated.secret)) {
+                            close(sink);
+                            throw runtime_error("Generated document n=" + to_string(n) + " k=" +
+                                                to_string(k) + " base=" + to_string(base) +
+                                                " did not solve to its secret");
+                        }
+                        if (rep < 0) continue;
+
+                        samples[(int)BenchPhase::Parse].push_back(result.timings.parseNs);
+                        samples[(int)BenchPhase::Convert].push_back(result.timings.convertNs);
+                        samples[(int)BenchPhase::Interpolate].push_back(result.timings.interpolateNs);
+                        samples[(int)BenchPhase::Output].push_back(outputNs);
+                        samples[(int)BenchPhase::Total].push_back(result.timings.totalNs + outputNs);
+                        for (int phase = 0; phase < kSolvePhaseCount; phase++) {
+                            for (int event = 0; event < kHardwareEventCount; event++) {
+                                events[phase][event].push_back(observer.phase((SolvePhase)phase).values[event]);
+                            }
+                        }
+                    }
+
+                    BenchCase benchCase;
+                    benchCase.n = n;
+                    benchCase.k = k;
+                    benchCase.base = base;
+                    benchCase.digits = digits;
+                    benchCase.documentBytes = json.size();
+                    for (int phase = 0; phase < kBenchPhaseCount; phase++) {
+                        benchCase.phases[phase] = summarize(samples[phase]);
+                        benchCase.samples[phase] = std::move(samples[phase]);
+                    }
+                    benchCase.hardware = counters.available();
+                    benchCase.shares = result.counters.sharesDecoded;
+                    for (int phase = 0; benchCase.hardware && phase < kSolvePhaseCount; phase++) {
+                        for (int event = 0; event < kHardwareEventCount; event++) {
+                            benchCase.hardwareMedian[phase].values[event] =
+                                (uint64_t)llround(summarize(events[phase][event]).median);
+                        }
+                    }
+                    cases.push_back(benchCase);
+                }
+            }
+        }
+    }
+
+    writer.flush();
+    close(sink);
+    return cases;
+}
+
+void printBenchTable(ostream& out, const BenchConfig& config, const vector<BenchCase>& cases) {
+    out << "Benchmark: " << config.repetitions << " repetitions after " << config.warmup
+        << " warm-up, seed " << config.seed << ", " << exactBackendName(config.backend)
+        << " backend; times in microseconds, median (MAD)\n\n";
+    out << "     n      k  base  digits    bytes |         parse       convert   interpolate        output"
+           " |         total      p99\n";
+
+    auto cell = [&](const PhaseStats& stats) {
+        ostringstream text;
+        text << fixed << setprecision(1) << stats.median / 1000.0 << " (" << stats.mad / 1000.0 << ")";
+        out << setw(14) << text.str();
+    };
+    for (const BenchCase& c : cases) {
+        out << setw(6) << c.n << setw(7) << c.k << setw(6) << c.base << setw(8) << c.digits
+            << setw(9) << c.documentBytes << " |";
+        for (int phase = 0; phase < (int)BenchPhase::Total; phase++) cell(c.phases[phase]);
+        out << " |";
+        cell(c.phases[(int)BenchPhase::Total]);
+        out << setw(9) << fixed << setprecision(1) << c.phases[(int)BenchPhase::Total].p99 / 1000.0 << "\n";
+    }
+
+    if (cases.empty() || !cases[0].hardware) return;
+    out << "\nHardware counters, median per solve: IPC, cache misses / share, branch misses / share\n\n";
+    out << "     n      k  base  digits |              parse            convert        interpolate\n";
+    for (const BenchCase& c : cases) {
+        out << setw(6) << c.n << setw(7) << c.k << setw(6) << c.base << setw(8) << c.digits << " |";
+        double shares = (double)max<uint64_t>(c.shares, 1);
+        for (SolvePhase phase : {SolvePhase::Parse, SolvePhase::Convert, SolvePhase::Interpolate}) {
+            const HardwareCounts& counts = c.hardwareMedian[(int)phase];
+            ostringstream text;
+            text << fixed << setprecision(2) << counts.ipc() << " " << setprecision(1)
+                 << (double)counts[HardwareEvent::CacheMisses] / shares << " "
+                 << (double)counts[HardwareEvent::BranchMisses] / shares;
+            out << setw(19) << text.str();
+        }
+        out << "\n";
+    }
+}
+
+void printBenchJson(ostream& out, const BenchConfig& config, const vector<BenchCase>& cases) {
+    out << "{\"benchmark\":\"polynomial_solver\",\"backend\":\"" << exactBackendName(config.backend)
+        << "\",\"seed\":" << config.seed
+        << ",\"warmup\":" << config.warmup << ",\"repetitions\":" << config.repetitions << ",\"cases\":[";
+    out << fixed << setprecision(0);
+    for (size_t i = 0; i < cases.size(); i++) {
+        const BenchCase& c = cases[i];
+        if (i > 0) out << ",";
+        out << "\n  {\"n\":" << c.n << ",\"k\":" << c.k << ",\"base\":" << c.base
+            << ",\"digits\":" << c.digits << ",\"bytes\":" << c.documentBytes << ",\"phases\":{";
+        for (int phase = 0; phase < kBenchPhaseCount; phase++) {
+            const PhaseStats& stats = c.phases[phase];
+            if (phase > 0) out << ",";
+            out << "\"" << benchPhaseName((BenchPhase)phase) << "\":{\"median_ns\":" << stats.median
+                << ",\"p99_ns\":" << stats.p99 << ",\"mad_ns\":" << stats.mad << ",\"samples_ns\":[";
+            for (size_t s = 0; s < c.samples[phase].size(); s++) {
+                out << (s ? "," : "") << c.samples[phase][s];
+            }
+            out << "]}";
+        }
+        out << "}";
+        if (c.hardware) {
+            out << ",\"shares\":" << c.shares << ",\"hardware\":{";
+            for (int phase = 0; phase < kSolvePhaseCount; phase++) {
+                out << (phase ? "," : "") << "\"" << solvePhaseName((SolvePhase)phase) << "\":{";
+                for (int event = 0; event < kHardwareEventCount; event++) {
+                    out << (event ? "," : "") << "\"" << hardwareEventName((HardwareEvent)event)
+                        << "\":" << c.hardwareMedian[phase].values[event];
+                }
+                out << "}";
+            }
+            out << "}";
+        }
+        out << "}";
+    }
+    out << "\n]}\n";
+}
+
+bool readBenchJson(istream& in, vector<BenchCase>& cases, string& error, BenchConfig* config) {
+    // printBenchJson writes one case per line, so the reader can go line by line
+    vector<BenchCase> parsed;
+    BenchConfig settings;
+    string line;
+    bool header = false;
+    while (getline(in, line)) {
+        if (line.rfind("{\"benchmark\":\"polynomial_solver\"", 0) == 0) {
+            size_t name = line.find("\"backend\":\"");
+            size_t close = name == string::npos ? string::npos : line.find('"', name + 11);
+            string backend = close == string::npos ? "" : line.substr(name + 11, close - name - 11);
+            unsigned long long seed;
+            if (!parseExactBackend(backend, settings.backend) || !readField(line, "seed", 0, line.size(), seed)) {
+                error = "Benchmark header has no backend or seed";
+                return false;
+            }
+            settings.seed = seed;
+            header = true;
+        }
+        if (line.rfind("  {\"n\":", 0) != 0) continue;
+
+        BenchCase c;
+        unsigned long long n, k, base, digits, bytes;
+        if (!readField(line, "n", 0, line.size(), n) || !readField(line, "k", 0, line.size(), k) ||
+            !readField(line, "base", 0, line.size(), base) ||
+            !readField(line, "digits", 0, line.size(), digits) ||
+            !readField(line, "bytes", 0, line.size(), bytes)) {
+            error = "Malformed benchmark case: " + line.substr(0, 60);
+            return false;
+        }
+        c.n = (int)n;
+        c.k = (int)k;
+        c.base = (int)base;
+        c.digits = (int)digits;
+        c.documentBytes = (size_t)bytes;
+
+        for (int phase = 0; phase < kBenchPhaseCount; phase++) {
+            string name = string("\"") + benchPhaseName((BenchPhase)phase) + "\":{";
+            size_t start = line.find(name);
+            size_t end = start == string::npos ? string::npos : line.find('}', start);
+            size_t list = start == string::npos ? string::npos : line.find("\"samples_ns\":[", start);
+            if (end == string::npos || list == string::npos || list > end) {
+                error = "Benchmark case n=" + to_string(n) + " k=" + to_string(k) + " has no raw " +
+                        benchPhaseName((BenchPhase)phase) + " samples (rerun with --bench-json)";
+                return false;
+            }
+            for (size_t pos = list + 14; pos < end && isdigit((unsigned char)line[pos]);) {
+                char* next = nullptr;
+                c.samples[phase].push_back(strtoull(line.c_str() + pos, &next, 10));
+                pos = (size_t)(next - line.c_str());
+                if (pos < end && line[pos] == ',') pos++;
+            }
+            c.phases[phase] = summarize(c.samples[phase]);
+        }
+        parsed.push_back(std::move(c));
+    }
+    if (!header) {
+        error = "Not a --bench-json file";
+        return false;
+    }
+    cases = std::move(parsed);
+    if (config) {
+        config->seed = settings.seed;
+        config->backend = settings.backend;
+    }
+    return true;
+}
+
+double mannWhitneyGreater(const vector<uint64_t>& baseline, const vector<uint64_t>& current) {
+    size_t n1 = current.size(), n2 = baseline.size(), total = n1 + n2;
+    if (n1 == 0 || n2 == 0) return 1.0;
+
+    // Rank the pooled samples, ties sharing their average rank
+    vector<pair<uint64_t, bool>> pooled;     // (value, from current)
+    pooled.reserve(total);
+    for (uint64_t v : current) pooled.push_back({v, true});
+    for (uint64_t v : baseline) pooled.push_back({v, false});
+    sort(pooled.begin(), pooled.end());
+
+    double rankSum = 0, tieTerm = 0;
+    for (size_t i = 0; i < total;) {
+        size_t j = i;
+        while (j < total && pooled[j].first == pooled[i].first) j++;
+        double rank = (double)(i + j + 1) / 2.0;     // ranks i+1 .. j
+        for (size_t m = i; m < j; m++) {
+            if (pooled[m].second) rankSum += rank;
+        }
+        double t = (double)(j - i);
+        tieTerm += t * t * t - t;
+        i = j;
+    }
+
+    double u = rankSum - (double)n1 * (double)(n1 + 1) / 2.0;
+    double mean = (double)n1 * (double)n2 / 2.0;
+    double variance = (double)n1 * (double)n2 / 12.0 *
+                      ((double)(total + 1) - tieTerm / ((double)total * (double)(total - 1)));
+    if (variance <= 0) return 1.0;
+    double z = (u - mean - 0.5) / sqrt(variance);
+    return 0.5 * erfc(z / sqrt(2.0));
+}
+
+bool sameBenchCell(const BenchCase& a, const BenchCase& b) {
+    return a.n == b.n && a.k == b.k && a.base == b.base && a.digits == b.digits;
+}
+
+vector<BenchRegression> compareBench(const vector<BenchCase>& baseline, const vector<BenchCase>& current,
+                                     double maxRegression, double alpha) {
+    vector<BenchRegression> regressions;
+    for (const BenchCase& c : current) {
+        auto match = find_if(baseline.begin(), baseline.end(),
+                             [&](const BenchCase& b) { return sameBenchCell(b, c); });
+        if (match == baseline.end()) continue;
+
+        for (int phase = 0; phase < kBenchPhaseCount; phase++) {
+            double before = match->phases[phase].median;
+            double after = c.phases[phase].median;
+            if (after <= before * (1.0 + maxRegression)) continue;
+            double p = mannWhitneyGreater(match->samples[phase], c.samples[phase]);
+            if (p < alpha) regressions.push_back({&c, (BenchPhase)phase, before, after, p});
+        }
+    }
+    return regressions;
+}
+
+bool parseIntList(const string& text, vector<int>& values) {
+    vector<int> parsed;
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t comma = text.find(',', start);
+        if (comma == string::npos) comma = text.size();
+        string item = text.substr(start, comma - start);
+        if (item.empty() || item.size() > 9 || item.find_first_not_of("0123456789") != string::npos) {
+            return false;
+        }
+        int value = atoi(item.c_str());
+        if (value <= 0) return false;
+        parsed.push_back(value);
+        start = comma + 1;
+    }
+    values = parsed;
+    return true;
+}
@@ -0,0 +1,122 @@
+/**
+ * Polynomial Solver - end-to-end benchmark harness (--bench)
+ *
+ * Solves generated share documents over a grid of n, k, bases and value
+ * lengths and times parsing, conversion, interpolation and output
+ * separately, after a warm-up, reporting median, p99 and MAD per phase.
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "perf_counters.h"
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+struct BenchConfig {
+    std::vector<int> ns = {8, 64};
+    std::vector<int> ks = {3, 8, 64};           // cells with k > n are skipped
+    std::vector<int> bases = {10, 16};
+    std::vector<int> digits = {20, 200, 2000};  // decimal digits per coefficient
+    int warmup = 3;
+    int repetitions = 15;
+    std::uint64_t seed = 1;
+    ExactBackend backend = ExactBackend::InTree;
+};
+
+enum class BenchPhase { Parse, Convert, Interpolate, Output, Total };
+constexpr int kBenchPhaseCount = 5;
+
+const char* benchPhaseName(BenchPhase phase);
+
+/**
+ * Order statistics of one phase's samples, in nanoseconds
+ */
+struct PhaseStats {
+    double median = 0;
+    double p99 = 0;             // nearest rank
+    double mad = 0;             // median absolute deviation from the median
+};
+
+/**
+ * Median, p99 and MAD of the samples (all zero when there are none)
+ */
+PhaseStats summarize(std::vector<std::uint64_t> samples);
+
+struct BenchCase {
+    int n = 0;
+    int k = 0;
+    int base = 10;
+    int digits = 0;
+    size_t documentBytes = 0;
+    PhaseStats phases[kBenchPhaseCount];
+    std::vector<std::uint64_t> samples[kBenchPhaseCount];  // raw, in run order
+
+    bool hardware = false;                                  // counters below are valid
+    std::uint64_t shares = 0;                               // decoded per solve
+    HardwareCounts hardwareMedian[kSolvePhaseCount];        // per event, per solve
+};
+
+/**
+ * Run every grid cell, reading hardware counters per phase when the host
+ * allows it
+ * @param hardwareNote: Set to the reason when counters are unavailable
+ * @throws runtime_error: When a generated document does not solve to its
+ *         known secret (the numbers would be meaningless)
+ */
+std::vector<BenchCase> runBench(const BenchConfig& config, std::string* hardwareNote = nullptr);
+
+void printBenchTable(std::ostream& out, const BenchConfig& config, const std::vector<BenchCase>& cases);
+void printBenchJson(std::ostream& out, const BenchConfig& config, const std::vector<BenchCase>& cases);
+
+/**
+ * Read back the cases written by printBenchJson (raw samples included)
+ * @param config: When given, set to the seed and backend of that run
+ * @return: false with error set when the input is not in that format
+ */
+bool readBenchJson(std::istream& in, std::vector<BenchCase>& cases, std::string& error,
+                   BenchConfig* config = nullptr);
+
+/**
+ * One-sided Mann-Whitney U test that `current` tends to be larger than
+ * `baseline` (normal approximation with tie and continuity corrections)
+ * @return: p-value; 1 when either side has no samples or all are tied
+ */
+double mannWhitneyGreater(const std::vector<std::uint64_t>& baseline,
+                          const std::vector<std::uint64_t>& current);
+
+/**
+ * A phase of a grid cell that got slower than the baseline allows
+ */
+struct BenchRegression {
+    const BenchCase* current;
+    BenchPhase phase;
+    double baselineMedian;
+    double currentMedian;
+    double pValue;
+};
+
+/**
+ * Whether two cases measure the same grid cell (n, k, base and digits)
+ */
+bool sameBenchCell(const BenchCase& a, const BenchCase& b);
+
+/**
+ * Compare every cell present in both runs. A phase regresses when its
+ * median grew by more than maxRegression (0.05 = 5%) and the Mann-Whitney
+ * test says the slowdown is real (p < alpha).
+ */
+std::vector<BenchRegression> compareBench(const std::vector<BenchCase>& baseline,
+                                          const std::vector<BenchCase>& current,
+                                          double maxRegression, double alpha = 0.01);
+
+/**
+ * Parse a comma separated list of positive integers ("3,8,64")
+ * @return: false for an empty list or any entry that is not a positive integer
+ */
+bool parseIntList(const std::string& text, std::vector<int>& values);
+
+#endif // BENCH_H
@@ -0,0 +1,561 @@
+/**
+ * Polynomial Solver - arbitrary precision integers implementation
+ */
+
+#include "bigint.h"
+#include "bigint_internal.h"
+#include "probes.h"
+
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cmath>
+#include <deque>
+#include <stdexcept>
+
+using namespace std;
+
+using namespace bigint_detail;
+
+/**
+ * Gives the magnitude helpers below access to BigInt internals
+ */
+class BigIntAccess {
+public:
+    static Mag& mag(BigInt& value) { return value.mag_; }
+    static const Mag& mag(const BigInt& value) { return value.mag_; }
+    static BigInt make(Mag mag, bool negative) {
+        BigInt result;
+        result.mag_ = std::move(mag);
+        result.negative_ = negative;
+        result.normalize();
+        return result;
+    }
+};
+
+namespace bigint_detail {
+
+void trim(Mag& a) {
+    while (!a.empty() && a.back() == 0) a.pop_back();
+}
+
+int compareMag(const Mag& a, const Mag& b) {
+    if (a.size() != b.size()) return a.size() < b.size() ? -1 : 1;
+    for (size_t i = a.size(); i-- > 0;) {
+        if (a[i] != b[i]) return a[i] < b[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+// a += b
+void addMagInPlace(Mag& a, const Mag& b) {
+    if (a.size() < b.size()) a.resize(b.size(), 0);
+    Limb carry = 0;
+    size_t i = 0;
+    for (; i < b.size(); i++) {
+        u128 sum = (u128)a[i] + b[i] + carry;
+        a[i] = (Limb)sum;
+        carry = (Limb)(sum >> 64);
+    }
+    for (; carry && i < a.size(); i++) {
+        a[i] += carry;
+        carry = a[i] == 0;
+    }
+    if (carry) a.push_back(carry);
+}
+
+// a -= b, requires |a| >= |b|
+void subMagInPlace(Mag& a, const Mag& b) {
+    Limb borrow = 0;
+    size_t i = 0;
+    for (; i < b.size(); i++) {
+        Limb ai = a[i];
+        Limb diff = ai - b[i];
+        Limb borrowOut = ai < b[i];
+        a[i] = diff - borrow;
+        borrowOut += diff < borrow;
+        borrow = borrowOut;
+    }
+    for (; borrow && i < a.size(); i++) {
+        borrow = a[i] == 0;
+        a[i]--;
+    }
+    trim(a);
+}
+
+// a = a * factor + addend
+void mulWordAddInPlace(Mag& a, Limb factor, Limb addend) {
+    Limb carry = addend;
+    for (Limb& limb : a) {
+        u128 t = (u128)limb * factor + carry;
+        limb = (Limb)t;
+        carry = (Limb)(t >> 64);
+    }
+    if (carry) a.push_back(carry);
+    trim(a);
+}
+
+} // namespace bigint_detail
+
+namespace {
+
+// Below these sizes the quadratic leaf routines beat recursion
+ConversionThresholds gConversion;
+
+const char kDigitChars[] = "0123456789abcdef";
+
+/**
+ * Knuth's algorithm D (TAOCP 4.3.1) for a divisor of two or more limbs
+ */
+void divModMag(const Mag& a, const Mag& b, Mag& quotient, Mag& remainder) {
+    if (compareMag(a, b) < 0) {
+        quotient.clear();
+        remainder = a;
+        return;
+    }
+    if (b.size() == 1) {
+        quotient = a;
+        Limb r = divWordInPlace(quotient, b[0]);
+        remainder.assign(r ? 1 : 0, r);
+        return;
+    }
+
+    size_t n = b.size();
+    size_t m = a.size() - n;
+    int shift = __builtin_clzll(b.back());
+
+    // Normalise so the divisor's top bit is set
+    Mag bn(n), an(a.size() + 1);
+    for (size_t i = n; i-- > 0;) {
+        bn[i] = (b[i] << shift) | (shift && i > 0 ? b[i - 1] >> (64 - shift) : 0);
+    }
+    an[a.size()] = shift ? a.back() >> (64 - shift) : 0;
+    for (size_t i = a.size(); i-- > 0;) {
+        an[i] = (a[i] << shift) | (shift && i > 0 ? a[i - 1] >> (64 - shift) : 0);
+    }
+
+    quotient.assign(m + 1, 0);
+    Limb top = bn[n - 1];
+    Limb second = bn[n - 2];
+
+    for (size_t j = m + 1; j-- > 0;) {
+        u128 numerator = ((u128)an[j + n] << 64) | an[j + n - 1];
+        u128 qhat = numerator / top;
+        u128 rhat = numerator % top;
+        while ((qhat >> 64) != 0 || qhat * second > ((rhat << 64) | an[j + n - 2])) {
+            qhat--;
+            rhat += top;
+            if ((rhat >> 64) != 0) break;
+        }
+
+        // an[j..j+n] -= qhat * bn
+        Limb q = (Limb)qhat;
+        Limb carry = 0;
+        Limb borrow = 0;
+        for (size_t i = 0; i < n; i++) {
+            u128 product = (u128)q * bn[i] + carry;
+            carry = (Limb)(product >> 64);
+            Limb low = (Limb)product;
+            Limb ai = an[i + j];
+            Limb diff = ai - low;
+            Limb borrowOut = ai < low;
+            an[i + j] = diff - borrow;
+            borrowOut += diff < borrow;
+            borrow = borrowOut;
+        }
+        Limb ai = an[j + n];
+        Limb diff = ai - carry;
+        Limb borrowOut = ai < carry;
+        an[j + n] = diff - borrow;
+        borrowOut += diff < borrow;
+
+        // qhat was one too large: add the divisor back
+        if (borrowOut) {
+            q--;
+            Limb c = 0;
+            for (size_t i = 0; i < n; i++) {
+                u128 sum = (u128)an[i + j] + bn[i] + c;
+                an[i + j] = (Limb)sum;
+                c = (Limb)(sum >> 64);
+            }
+            an[j + n] += c;
+        }
+        quotient[j] = q;
+    }
+    trim(quotient);
+
+    remainder.assign(n, 0);
+    for (size_t i = 0; i < n; i++) {
+        remainder[i] = (an[i] >> shift) | (shift ? an[i + 1] << (64 - shift) : 0);
+    }
+    trim(remainder);
+}
+
+/**
+ * Largest m with base^m < 2^64, and base^m itself
+ */
+struct ChunkInfo {
+    size_t digits;
+    Limb value;
+    WordDivisor divisor;    // value with its reciprocal, for printing
+};
+
+struct ChunkTable {
+    ChunkInfo entries[17];
+
+    ChunkTable() : entries() {
+        for (int b = 2; b <= 16; b++) {
+            Limb value = 1;
+            size_t digits = 0;
+            while (value <= UINT64_MAX / (Limb)b) {
+                value *= (Limb)b;
+                digits++;
+            }
+            entries[b] = {digits, value, WordDivisor(value)};
+        }
+    }
+};
+
+const ChunkInfo& chunkInfo(int base) {
+    static const ChunkTable table;
+    return table.entries[base];
+}
+
+/**
+ * chunk^(2^level) for the base, cached per thread so steady-state
+ * conversions never recompute (or lock around) the powers. A deque keeps
+ * references valid while deeper levels are appended.
+ */
+thread_local BigInt::PowerCacheCounts powerCacheLookups;
+
+const Mag& chunkPower(int base, size_t level) {
+    thread_local deque<Mag> cache[17];
+    deque<Mag>& powers = cache[base];
+    if (powers.size() > level) {
+        PS_PROBE2(power__cache__hit, base, level);
+        powerCacheLookups.hits++;
+        return powers[level];
+    }
+    PS_PROBE2(power__cache__miss, base, level);
+    powerCacheLookups.misses++;
+    if (powers.empty()) powers.push_back(Mag{chunkInfo(base).value});
+    while (powers.size() <= level) {
+        powers.push_back(multiply(powers.back(), powers.back()));
+    }
+    return powers[level];
+}
+
+int digitValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool isPowerOfTwo(int base) {
+    return (base & (base - 1)) == 0;
+}
+
+Mag fromDigitsLeaf(const char* digits, size_t len, int base) {
+    const ChunkInfo& info = chunkInfo(base);
+    Mag result;
+    size_t first = len % info.digits;
+    if (first == 0) first = info.digits;
+
+    size_t pos = 0;
+    while (pos < len) {
+        size_t take = pos == 0 ? first : info.digits;
+        Limb chunk = 0;
+        Limb scale = 1;
+        for (size_t i = 0; i < take; i++) {
+            chunk = chunk * (Limb)base + (Limb)digitValue(digits[pos + i]);
+            scale *= (Limb)base;
+        }
+        mulWordAddInPlace(result, scale, chunk);
+        pos += take;
+    }
+    return result;
+}
+
+Mag fromDigitsRec(const char* digits, size_t len, int base) {
+    size_t chunkDigits = chunkInfo(base).digits;
+    if (len <= chunkDigits * gConversion.fromStringLeafChunks) return fromDigitsLeaf(digits, len, base);
+
+    // Low half is exactly chunk^(2^level) digits so the cached power applies
+    size_t level = 0;
+    while ((chunkDigits << (level + 1)) < len) level++;
+    size_t lowLen = chunkDigits << level;
+
+    Mag high = fromDigitsRec(digits, len - lowLen, base);
+    Mag low = fromDigitsRec(digits + len - lowLen, lowLen, base);
+    Mag result = multiply(high, chunkPower(base, level));
+    addMagInPlace(result, low);
+    return result;
+}
+
+Mag fromDigitsPowerOfTwo(const char* digits, size_t len, int base) {
+    int bits = __builtin_ctz((unsigned)base);
+    Mag result((len * (size_t)bits + 63) / 64, 0);
+    size_t bitPos = 0;
+    for (size_t i = len; i-- > 0;) {
+        Limb value = (Limb)digitValue(digits[i]);
+        size_t limb = bitPos / 64;
+        size_t offset = bitPos % 64;
+        result[limb] |= value << offset;
+        if (offset + (size_t)bits > 64) result[limb + 1] |= value >> (64 - offset);
+        bitPos += (size_t)bits;
+    }
+    trim(result);
+    return result;
+}
+
+/**
+ * Append exactly `width` digits of a value below chunk (width 0: no padding)
+ */
+void appendChunk(string& out, Limb chunk, int base, size_t width) {
+    char buffer[64];
+    size_t len = 0;
+    while (chunk != 0) {
+        buffer[len++] = kDigitChars[chunk % (Limb)base];
+        chunk /= (Limb)base;
+    }
+    while (len < width) buffer[len++] = '0';
+    while (len > 0) out.push_back(buffer[--len]);
+}
+
+void toDigitsLeaf(Mag value, int base, string& out, size_t width) {
+    const ChunkInfo& info = chunkInfo(base);
+    vector<Limb> chunks;
+    chunks.reserve(value.size() * 2 + 1);
+    while (!value.empty()) chunks.push_back(divWordInPlace(value, info.divisor));
+
+    size_t produced = 0;
+    if (!chunks.empty()) {
+        Limb topChunk = chunks.back();
+        for (Limb t = topChunk; t != 0; t /= (Limb)base) produced++;
+        produced += (chunks.size() - 1) * info.digits;
+    }
+    if (width > produced) out.append(width - produced, '0');
+    if (chunks.empty()) return;
+
+    appendChunk(out, chunks.back(), base, 0);
+    for (size_t i = chunks.size() - 1; i-- > 0;) appendChunk(out, chunks[i], base, info.digits);
+}
+
+void toDigitsRec(Mag value, int base, string& out, size_t width) {
+    if (value.size() <= gConversion.toStringLeafLimbs) {
+        toDigitsLeaf(std::move(value), base, out, width);
+        return;
+    }
+
+    // Split near the middle: chunk^(2^level) with about half the limbs
+    size_t level = 0;
+    while (chunkPower(base, level + 1).size() <= (value.size() + 1) / 2) level++;
+    size_t lowWidth = chunkInfo(base).digits << level;
+
+    Mag high, low;
+    divModMag(value, chunkPower(base, level), high, low);
+    value.clear();
+    value.shrink_to_fit();
+
+    if (high.empty()) {
+        toDigitsRec(std::move(low), base, out, width);
+        return;
+    }
+    toDigitsRec(std::move(high), base, out, width > lowWidth ? width - lowWidth : 0);
+    toDigitsRec(std::move(low), base, out, lowWidth);
+}
+
+void toDigitsPowerOfTwo(const Mag& value, int base, string& out) {
+    int bits = __builtin_ctz((unsigned)base);
+    size_t totalBits = value.size() * 64 - (size_t)__builtin_clzll(value.back());
+    size_t digits = (totalBits + (size_t)bits - 1) / (size_t)bits;
+    Limb mask = (Limb)base - 1;
+    for (size_t d = digits; d-- > 0;) {
+        size_t bitPos = d * (size_t)bits;
+        size_t limb = bitPos / 64;
+        size_t offset = bitPos % 64;
+        Limb v = value[limb] >> offset;
+        if (offset + (size_t)bits > 64 && limb + 1 < value.size()) v |= value[limb + 1] << (64 - offset);
+        out.push_back(kDigitChars[v & mask]);
+    }
+}
+
+} // namespace
+
+BigInt::BigInt(long long value) {
+    if (value != 0) {
+        negative_ = value < 0;
+        mag_.push_back(negative_ ? (Limb)0 - (Limb)value : (Limb)value);
+    }
+}
+
+void BigInt::normalize() {
+    trim(mag_);
+    if (mag_.empty()) negative_ = false;
+}
+
+BigInt BigInt::fromString(string_view digits, int base) {
+    if (digits.empty() || base < 2 || base > 16) {
+        throw invalid_argument("Invalid base (" + to_string(base) + ") or empty value");
+    }
+
+    // Validate right to left so errors match convertToDecimal
+    for (size_t i = digits.size(); i-- > 0;) {
+        int value = digitValue(digits[i]);
+        if (value < 0) {
+            char shown = (char)tolower((unsigned char)digits[i]);
+            throw invalid_argument("Invalid character '" + string(1, shown) + "' in number");
+        }
+        if (value >= base) {
+            throw invalid_argument("Digit " + to_string(value) + " invalid for base " + to_string(base));
+        }
+    }
+
+    Mag mag = isPowerOfTwo(base) ? fromDigitsPowerOfTwo(digits.data(), digits.size(), base)
+                                 : fromDigitsRec(digits.data(), digits.size(), base);
+    return BigIntAccess::make(std::move(mag), false);
+}
+
+BigInt BigInt::fromLimbs(vector<Limb> limbs, bool negative) {
+    return BigIntAccess::make(std::move(limbs), negative);
+}
+
+BigInt BigInt::fromLimbs(const Limb* limbs, size_t count, bool negative) {
+    return BigIntAccess::make(Mag(limbs, limbs + count), negative);
+}
+
+void BigInt::assignLimbs(const Limb* limbs, size_t count, bool negative) {
+    mag_.assign(limbs, limbs + count);
+    negative_ = negative;
+    normalize();
+}
+
+string BigInt::toString(int base) const {
+    if (base < 2 || base > 16) {
+        throw invalid_argument("Invalid output base (" + to_string(base) + ")");
+    }
+    if (mag_.empty()) return "0";
+
+    string out;
+    out.reserve(mag_.size() * 64 / (size_t)(31 - __builtin_clz((unsigned)base)) + 2);
+    if (negative_) out.push_back('-');
+    if (isPowerOfTwo(base)) {
+        toDigitsPowerOfTwo(mag_, base, out);
+    } else {
+        toDigitsRec(mag_, base, out, 0);
+    }
+    return out;
+}
+
+bool BigInt::fitsInt64() const {
+    if (mag_.size() > 1) return false;
+    if (mag_.empty()) return true;
+    return negative_ ? mag_[0] <= (Limb)1 << 63 : mag_[0] <= (Limb)LLONG_MAX;
+}
+
+long long BigInt::toInt64() const {
+    if (mag_.empty()) return 0;
+    return negative_ ? (long long)((Limb)0 - mag_[0]) : (long long)mag_[0];
+}
+
+long double BigInt::toLongDouble() const {
+    if (mag_.empty()) return 0.0L;
+    size_t n = mag_.size();
+    long double top = (long double)mag_[n - 1];
+    if (n >= 2) top = top * 18446744073709551616.0L + (long double)mag_[n - 2];
+    long double result = ldexpl(top, (int)(64 * (n >= 2 ? n - 2 : 0)));
+    return negative_ ? -result : result;
+}
+
+BigInt BigInt::operator-() const {
+    BigInt result = *this;
+    if (!result.mag_.empty()) result.negative_ = !result.negative_;
+    return result;
+}
+
+BigInt& BigInt::operator+=(const BigInt& other) {
+    if (negative_ == other.negative_) {
+        addMagInPlace(mag_, other.mag_);
+    } else if (compareMag(mag_, other.mag_) >= 0) {
+        subMagInPlace(mag_, other.mag_);
+    } else {
+        Mag result = other.mag_;
+        subMagInPlace(result, mag_);
+        mag_ = std::move(result);
+        negative_ = other.negative_;
+    }
+    normalize();
+    return *this;
+}
+
+BigInt& BigInt::operator-=(const BigInt& other) {
+    return *this += -other;
+}
+
+BigInt& BigInt::operator*=(const BigInt& other) {
+    mag_ = bigint_detail::multiply(mag_, other.mag_);
+    negative_ = negative_ != other.negative_;
+    normalize();
+    return *this;
+}
+
+BigInt& BigInt::operator*=(long long factor) {
+    Limb magnitude = factor < 0 ? (Limb)0 - (Limb)factor : (Limb)factor;
+    if (magnitude == 0) {
+        mag_.clear();
+    } else {
+        mulWordAddInPlace(mag_, magnitude, 0);
+    }
+    negative_ = negative_ != (factor < 0);
+    normalize();
+    return *this;
+}
+
+int BigInt::compare(const BigInt& a, const BigInt& b) {
+    if (a.negative_ != b.negative_) return a.negative_ ? -1 : 1;
+    int magnitude = compareMag(a.mag_, b.mag_);
+    return a.negative_ ? -magnitude : magnitude;
+}
+
+void BigInt::divMod(const BigInt& a, const BigInt& b, BigInt& quotient, BigInt& remainder) {
+    if (b.mag_.empty()) throw domain_error("BigInt division by zero");
+
+    Mag q, r;
+    divModMag(a.mag_, b.mag_, q, r);
+    quotient = BigIntAccess::make(std::move(q), a.negative_ != b.negative_);
+    remainder = BigIntAccess::make(std::move(r), a.negative_);
+}
+
+BigInt BigInt::divExact(const BigInt& a, const BigInt& b) {
+    if (b.mag_.empty()) throw domain_error("BigInt division by zero");
+    return BigIntAccess::make(bigint_detail::divExact(a.mag_, b.mag_), a.negative_ != b.negative_);
+}
+
+BigInt BigInt::multiply(const BigInt& a, const BigInt& b, MulAlgorithm algorithm) {
+    return BigIntAccess::make(bigint_detail::multiply(a.mag_, b.mag_, algorithm), a.negative_ != b.negative_);
+}
+
+BigInt::PowerCacheCounts BigInt::powerCacheCounts() {
+    return powerCacheLookups;
+}
+
+const ConversionThresholds& BigInt::conversionThresholds() {
+    return gConversion;
+}
+
+void BigInt::setConversionThresholds(const ConversionThresholds& thresholds) {
+    gConversion = thresholds;
+}
+
+BigInt BigInt::gcd(BigInt a, BigInt b) {
+    a.negative_ = b.negative_ = false;
+    Mag q, r;
+    while (!b.mag_.empty()) {
+        divModMag(a.mag_, b.mag_, q, r);
+        a.mag_ = std::move(b.mag_);
+        b.mag_ = std::move(r);
+        r.clear();
+    }
+    return a;
+}
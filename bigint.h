@@ -0,0 +1,172 @@
+/**
+ * Polynomial Solver - arbitrary precision integers
+ *
+ * Sign-magnitude integers over 64-bit limbs (least significant first),
+ * used for exact share decoding, exact Lagrange interpolation and printing
+ * exact secrets. Parsing and printing in bases 2-16 use divide-and-conquer
+ * over cached powers of the largest per-limb chunk of the base
+ * (10^19 for decimal); power-of-two bases are converted by bit slicing.
+ * Multiplication moves from schoolbook to Karatsuba, Toom-3 and a
+ * three-prime NTT as operands grow, and everything built on it (parsing,
+ * interpolation) speeds up with it.
+ */
+
+#ifndef BIGINT_H
+#define BIGINT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Multiplication algorithms; Auto picks by operand size using MulThresholds
+ */
+enum class MulAlgorithm {
+    Auto,
+    Schoolbook,
+    Karatsuba,
+    Toom3,
+    NTT             // three-prime number theoretic transform
+};
+
+/**
+ * Size of the smaller factor, in limbs, from which each algorithm takes
+ * over from the previous one. Process-wide: set once at startup (e.g. from
+ * an autotune profile) before any solving threads run.
+ */
+struct MulThresholds {
+    size_t karatsuba = 32;
+    size_t toom3 = 160;
+    size_t ntt = 20000;
+};
+
+/**
+ * Operand sizes up to which parsing and printing use the quadratic
+ * chunk-at-a-time loops before switching to divide-and-conquer. Same
+ * process-wide rules as MulThresholds.
+ */
+struct ConversionThresholds {
+    size_t fromStringLeafChunks = 32;   // in base chunks (19 decimal digits)
+    size_t toStringLeafLimbs = 32;
+};
+
+class BigInt {
+public:
+    using Limb = std::uint64_t;
+
+    BigInt() = default;
+    BigInt(long long value);
+
+    /**
+     * Parse digits in the given base
+     * @param digits: Digits 0-9, a-f/A-F (no sign, no prefix)
+     * @param base: Base of the digits (2-16)
+     * @return: Parsed value
+     * @throws invalid_argument: Same conditions as PolynomialSolver::convertToDecimal
+     */
+    static BigInt fromString(std::string_view digits, int base);
+
+    /**
+     * Value from a magnitude in limbs, least significant first (high zero
+     * limbs are dropped), e.g. exported from another integer library
+     */
+    static BigInt fromLimbs(std::vector<Limb> limbs, bool negative = false);
+    static BigInt fromLimbs(const Limb* limbs, size_t count, bool negative = false);
+
+    /**
+     * Same as fromLimbs, but overwrites this value in place and keeps its
+     * storage, so refilling one BigInt does not allocate
+     */
+    void assignLimbs(const Limb* limbs, size_t count, bool negative = false);
+
+    /**
+     * Format in the given base, lowercase digits, '-' prefix when negative
+     * @param base: Output base (2-16)
+     * @throws invalid_argument: For a base outside 2-16
+     */
+    std::string toString(int base = 10) const;
+
+    bool isZero() const { return mag_.empty(); }
+    bool isNegative() const { return negative_; }
+    size_t limbCount() const { return mag_.size(); }
+    const std::vector<Limb>& limbs() const { return mag_; }
+
+    bool fitsInt64() const;
+    long long toInt64() const;          // only meaningful when fitsInt64()
+    long double toLongDouble() const;   // nearest value, may round
+
+    BigInt operator-() const;
+    BigInt& operator+=(const BigInt& other);
+    BigInt& operator-=(const BigInt& other);
+    BigInt& operator*=(const BigInt& other);
+    BigInt& operator*=(long long factor);
+
+    friend BigInt operator+(BigInt a, const BigInt& b) { return a += b; }
+    friend BigInt operator-(BigInt a, const BigInt& b) { return a -= b; }
+    friend BigInt operator*(BigInt a, const BigInt& b) { return a *= b; }
+    friend BigInt operator*(BigInt a, long long b) { return a *= b; }
+
+    friend bool operator==(const BigInt& a, const BigInt& b) {
+        return a.negative_ == b.negative_ && a.mag_ == b.mag_;
+    }
+    friend bool operator!=(const BigInt& a, const BigInt& b) { return !(a == b); }
+    friend bool operator<(const BigInt& a, const BigInt& b) { return compare(a, b) < 0; }
+
+    /**
+     * Three-way comparison
+     * @return: negative, zero or positive as a <, ==, > b
+     */
+    static int compare(const BigInt& a, const BigInt& b);
+
+    /**
+     * Truncating division: a = q*b + r with |r| < |b|, r has a's sign
+     * @throws domain_error: When b is zero
+     */
+    static void divMod(const BigInt& a, const BigInt& b, BigInt& quotient, BigInt& remainder);
+
+    /**
+     * a / b when b is known to divide a; works from the low limbs and costs
+     * about one multiplication. The result is meaningless if b does not
+     * divide a, so check q * b == a when that is not guaranteed.
+     * @throws domain_error: When b is zero
+     */
+    static BigInt divExact(const BigInt& a, const BigInt& b);
+
+    /**
+     * Greatest common divisor of |a| and |b| (non-negative)
+     */
+    static BigInt gcd(BigInt a, BigInt b);
+
+    /**
+     * Product using one specific algorithm at every recursion level
+     * (benchmarks and cross-checks; operator* uses MulAlgorithm::Auto)
+     */
+    static BigInt multiply(const BigInt& a, const BigInt& b, MulAlgorithm algorithm);
+
+    /**
+     * Lookups in the calling thread's cache of chunk powers (parsing and
+     * printing beyond the leaf sizes), counted since the thread started
+     */
+    struct PowerCacheCounts {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+    };
+    static PowerCacheCounts powerCacheCounts();
+
+    static const MulThresholds& mulThresholds();
+    static void setMulThresholds(const MulThresholds& thresholds);
+    static const ConversionThresholds& conversionThresholds();
+    static void setConversionThresholds(const ConversionThresholds& thresholds);
+
+private:
+    std::vector<Limb> mag_;     // magnitude, no high zero limbs
+    bool negative_ = false;     // never set for zero
+
+    void normalize();
+
+    friend class BigIntAccess;
+};
+
+#endif // BIGINT_H
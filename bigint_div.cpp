@@ -0,0 +1,217 @@
+/**
+ * Polynomial Solver - big integer division by words and exact division
+ *
+ * Word division uses a precomputed reciprocal instead of a hardware divide.
+ * Exact division (the divisor is known to divide the dividend, as in the
+ * last step of exact Lagrange interpolation) works from the low limbs with
+ * 2-adic inverses: limb by limb for short operands, and for long ones a
+ * Newton-iterated inverse of the divisor followed by a single product, so
+ * the whole step costs a few multiplications rather than long division.
+ */
+
+#include "bigint.h"
+#include "bigint_internal.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace bigint_detail {
+
+namespace {
+
+// Quotient and divisor both at least this long: Newton inverse + product
+constexpr size_t kDivExactNewtonLimbs = 96;
+
+/**
+ * (u1:u0) / normalized for u1 < normalized; returns the quotient limb
+ */
+inline Limb divTwoByOne(Limb u1, Limb u0, const WordDivisor& d, Limb& remainder) {
+    u128 q = (u128)d.reciprocal * u1;
+    q += ((u128)(u1 + 1) << 64) | u0;
+    Limb q1 = (Limb)(q >> 64);
+    Limb q0 = (Limb)q;
+    Limb r = u0 - q1 * d.normalized;
+    if (r > q0) {
+        q1--;
+        r += d.normalized;
+    }
+    if (r >= d.normalized) {
+        q1++;
+        r -= d.normalized;
+    }
+    remainder = r;
+    return q1;
+}
+
+// a >> (64 * limbs + bits), bits < 64
+Mag shiftedRight(const Mag& a, size_t limbs, int bits) {
+    if (limbs >= a.size()) return Mag();
+    Mag result(a.begin() + (ptrdiff_t)limbs, a.end());
+    if (bits) {
+        for (size_t i = 0; i < result.size(); i++) {
+            result[i] = (result[i] >> bits) |
+                        (i + 1 < result.size() ? result[i + 1] << (64 - bits) : 0);
+        }
+    }
+    trim(result);
+    return result;
+}
+
+void truncate(Mag& a, size_t limbs) {
+    if (a.size() > limbs) a.resize(limbs);
+    trim(a);
+}
+
+/**
+ * b^-1 mod 2^(64 * limbs) for odd b by Newton iteration x' = x(2 - bx).
+ * With x correct to p limbs, bx = 1 + h * 2^(64p), so only the product
+ * x * h contributes the new limbs: x' = x - (x * h) * 2^(64p).
+ */
+Mag inverseModPower(const Mag& b, size_t limbs) {
+    Mag x{inverseModWord(b[0])};
+    size_t precision = 1;
+    while (precision < limbs) {
+        size_t next = min(2 * precision, limbs);
+
+        Mag bLow(b.begin(), b.begin() + (ptrdiff_t)min(b.size(), next));
+        trim(bLow);
+        Mag e = multiply(bLow, x);
+        e.resize(next, 0);
+        Mag h(e.begin() + (ptrdiff_t)precision, e.end());
+        trim(h);
+
+        Mag t = multiply(x, h);
+        t.resize(next - precision, 0);
+
+        // Append -t mod 2^(64 * (next - precision)) above the known limbs
+        x.resize(precision, 0);
+        Limb carry = 1;
+        for (Limb limb : t) {
+            u128 sum = (u128)(~limb) + carry;
+            x.push_back((Limb)sum);
+            carry = (Limb)(sum >> 64);
+        }
+        trim(x);
+        precision = next;
+    }
+    return x;
+}
+
+/**
+ * Exact quotient limb by limb from the bottom (Jebelean): only the low
+ * qn limbs of the running dividend are ever updated
+ */
+Mag divExactBasecase(const Mag& a, const Mag& b, size_t qn) {
+    Limb inv = inverseModWord(b[0]);
+    Mag quotient(qn);
+    Mag rest(a.begin(), a.begin() + (ptrdiff_t)qn);
+
+    for (size_t i = 0; i < qn; i++) {
+        Limb q = rest[i] * inv;
+        quotient[i] = q;
+
+        // rest[i..qn) -= q * b
+        size_t len = min(b.size(), qn - i);
+        Limb carry = 0;
+        Limb borrow = 0;
+        for (size_t j = 0; j < len; j++) {
+            u128 product = (u128)q * b[j] + carry;
+            carry = (Limb)(product >> 64);
+            Limb low = (Limb)product;
+            Limb ri = rest[i + j];
+            Limb diff = ri - low;
+            Limb borrowOut = ri < low;
+            rest[i + j] = diff - borrow;
+            borrowOut += diff < borrow;
+            borrow = borrowOut;
+        }
+        Limb pending = carry + borrow;
+        for (size_t j = i + len; pending && j < qn; j++) {
+            Limb ri = rest[j];
+            rest[j] = ri - pending;
+            pending = ri < pending;
+        }
+    }
+    trim(quotient);
+    return quotient;
+}
+
+} // namespace
+
+WordDivisor::WordDivisor(Limb d)
+    : divisor(d),
+      normalized(d << __builtin_clzll(d)),
+      reciprocal((Limb)(~(u128)0 / (d << __builtin_clzll(d)))),
+      shift(__builtin_clzll(d)) {}
+
+Limb divWordInPlace(Mag& a, const WordDivisor& d) {
+    if (a.empty()) return 0;
+    int s = d.shift;
+    Limb remainder = s ? a.back() >> (64 - s) : 0;
+    for (size_t i = a.size(); i-- > 0;) {
+        Limb u0 = (a[i] << s) | (s && i > 0 ? a[i - 1] >> (64 - s) : 0);
+        a[i] = divTwoByOne(remainder, u0, d, remainder);
+    }
+    trim(a);
+    return remainder >> s;
+}
+
+Limb divWordInPlace(Mag& a, Limb divisor) {
+    return divWordInPlace(a, WordDivisor(divisor));
+}
+
+Limb inverseModWord(Limb odd) {
+    Limb inv = odd;                                 // correct to 3 bits
+    for (int i = 0; i < 5; i++) inv *= 2 - odd * inv;
+    return inv;
+}
+
+void divExactWordInPlace(Mag& a, Limb divisor) {
+    if (a.empty()) return;
+    int zeros = __builtin_ctzll(divisor);
+    if (zeros) {
+        a = shiftedRight(a, 0, zeros);
+        divisor >>= zeros;
+    }
+    Limb inv = inverseModWord(divisor);
+    Limb borrow = 0;
+    for (Limb& limb : a) {
+        Limb t = limb - borrow;
+        Limb under = limb < borrow;
+        limb = t * inv;
+        borrow = (Limb)(((u128)limb * divisor) >> 64) + under;
+    }
+    trim(a);
+}
+
+Mag divExact(const Mag& a, const Mag& b) {
+    if (a.empty()) return Mag();
+
+    // Remove the power of two from both so the divisor is odd
+    size_t zeroLimbs = 0;
+    while (b[zeroLimbs] == 0) zeroLimbs++;
+    int zeroBits = __builtin_ctzll(b[zeroLimbs]);
+    Mag x = shiftedRight(a, zeroLimbs, zeroBits);
+    Mag y = shiftedRight(b, zeroLimbs, zeroBits);
+
+    if (y.size() == 1) {
+        divExactWordInPlace(x, y[0]);
+        return x;
+    }
+    if (x.size() < y.size()) return Mag();
+
+    // The quotient fits in qn limbs, so everything is computed mod 2^(64 qn)
+    size_t qn = x.size() - y.size() + 1;
+    if (qn < kDivExactNewtonLimbs || y.size() < kDivExactNewtonLimbs) {
+        return divExactBasecase(x, y, qn);
+    }
+
+    Mag inverse = inverseModPower(y, qn);
+    truncate(x, qn);
+    Mag quotient = multiply(x, inverse);
+    truncate(quotient, qn);
+    return quotient;
+}
+
+} // namespace bigint_detail
@@ -0,0 +1,64 @@
+/**
+ * Polynomial Solver - big integer magnitude kernels (internal)
+ *
+ * Unsigned limb-vector routines shared by bigint.cpp, bigint_mul.cpp and
+ * bigint_div.cpp.
+ * Magnitudes are little-endian limb vectors without high zero limbs.
+ * Not part of the public interface; use BigInt instead.
+ */
+
+#ifndef BIGINT_INTERNAL_H
+#define BIGINT_INTERNAL_H
+
+#include "bigint.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace bigint_detail {
+
+using Limb = BigInt::Limb;
+using Mag = std::vector<Limb>;
+using u128 = unsigned __int128;
+
+void trim(Mag& a);
+int compareMag(const Mag& a, const Mag& b);
+void addMagInPlace(Mag& a, const Mag& b);           // a += b
+void subMagInPlace(Mag& a, const Mag& b);           // a -= b, requires a >= b
+void mulWordAddInPlace(Mag& a, Limb factor, Limb addend);
+
+/**
+ * Word divisor with its precomputed reciprocal (Moller-Granlund 2-by-1),
+ * so each limb of a division costs two multiplications instead of a
+ * hardware 128-by-64 divide. Build once per divisor and reuse.
+ */
+struct WordDivisor {
+    Limb divisor = 1;
+    Limb normalized = 1ULL << 63;   // divisor << shift
+    Limb reciprocal = ~0ULL;        // floor((2^128 - 1) / normalized) - 2^64
+    int shift = 63;
+
+    WordDivisor() = default;
+    explicit WordDivisor(Limb d);
+};
+
+Limb divWordInPlace(Mag& a, const WordDivisor& divisor);   // returns the remainder
+Limb divWordInPlace(Mag& a, Limb divisor);
+void divExactWordInPlace(Mag& a, Limb divisor);     // requires divisor | a
+Limb inverseModWord(Limb odd);                      // odd^-1 mod 2^64
+
+/**
+ * a / b when b is known to divide a (Hensel / Jebelean exact division from
+ * the low limbs); the result is meaningless when it does not
+ */
+Mag divExact(const Mag& a, const Mag& b);
+
+/**
+ * a * b, choosing schoolbook, Karatsuba, Toom-3 or NTT from the current
+ * MulThresholds (or forcing one algorithm at every level)
+ */
+Mag multiply(const Mag& a, const Mag& b, MulAlgorithm algorithm = MulAlgorithm::Auto);
+
+} // namespace bigint_detail
+
+#endif // BIGINT_INTERNAL_H
@@ -0,0 +1,456 @@
+/**
+ * Polynomial Solver - big integer multiplication
+ *
+ * Schoolbook for small operands, Karatsuba and Toom-3 (Bodrato's
+ * interpolation sequence, points 0, 1, -1, -2, inf) for medium ones, and a
+ * three-prime NTT with CRT recombination for very large ones. Unbalanced
+ * products are cut into balanced slices of the longer factor first.
+ */
+
+#include "bigint.h"
+#include "bigint_internal.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+namespace bigint_detail {
+
+namespace {
+
+// Forced algorithms still bottom out in schoolbook below these sizes
+constexpr size_t kMinKaratsuba = 4;
+constexpr size_t kMinToom3 = 12;
+
+MulThresholds gThresholds;
+
+void mulDispatch(Limb* r, const Limb* a, size_t an, const Limb* b, size_t bn, MulAlgorithm forced);
+
+// r[0..rn) += a[0..an), an <= rn; the sum must fit in rn limbs
+void addInto(Limb* r, size_t rn, const Limb* a, size_t an) {
+    Limb carry = 0;
+    size_t i = 0;
+    for (; i < an; i++) {
+        u128 sum = (u128)r[i] + a[i] + carry;
+        r[i] = (Limb)sum;
+        carry = (Limb)(sum >> 64);
+    }
+    for (; carry && i < rn; i++) {
+        r[i] += carry;
+        carry = r[i] == 0;
+    }
+}
+
+// r[0..rn) -= a[0..an), an <= rn; r must be >= a
+void subFrom(Limb* r, size_t rn, const Limb* a, size_t an) {
+    Limb borrow = 0;
+    size_t i = 0;
+    for (; i < an; i++) {
+        Limb ri = r[i];
+        Limb diff = ri - a[i];
+        Limb borrowOut = ri < a[i];
+        r[i] = diff - borrow;
+        borrowOut += diff < borrow;
+        borrow = borrowOut;
+    }
+    for (; borrow && i < rn; i++) {
+        borrow = r[i] == 0;
+        r[i]--;
+    }
+}
+
+void mulSchoolbook(Limb* r, const Limb* a, size_t an, const Limb* b, size_t bn) {
+    memset(r, 0, (an + bn) * sizeof(Limb));
+    for (size_t i = 0; i < bn; i++) {
+        Limb carry = 0;
+        Limb bi = b[i];
+        for (size_t j = 0; j < an; j++) {
+            u128 t = (u128)a[j] * bi + r[i + j] + carry;
+            r[i + j] = (Limb)t;
+            carry = (Limb)(t >> 64);
+        }
+        r[i + an] = carry;
+    }
+}
+
+/**
+ * Slice the longer factor into bn-limb pieces and accumulate piece * b
+ */
+void mulUnbalanced(Limb* r, const Limb* a, size_t an, const Limb* b, size_t bn, MulAlgorithm forced) {
+    memset(r, 0, (an + bn) * sizeof(Limb));
+    Mag piece(2 * bn);
+    for (size_t offset = 0; offset < an; offset += bn) {
+        size_t len = min(bn, an - offset);
+        mulDispatch(piece.data(), a + offset, len, b, bn, forced);
+        addInto(r + offset, an + bn - offset, piece.data(), len + bn);
+    }
+}
+
+/**
+ * Karatsuba for bn > ceil(an/2): three half-size products
+ */
+void mulKaratsuba(Limb* r, const Limb* a, size_t an, const Limb* b, size_t bn, MulAlgorithm forced) {
+    size_t m = (an + 1) / 2;
+    size_t a1n = an - m;
+    size_t b1n = bn - m;
+
+    // z0 = a0*b0 into r[0, 2m), z2 = a1*b1 into r[2m, an+bn)
+    mulDispatch(r, a, m, b, m, forced);
+    mulDispatch(r + 2 * m, a + m, a1n, b + m, b1n, forced);
+
+    // z1 = (a0 + a1)(b0 + b1) - z0 - z2
+    Mag sa(m + 1, 0), sb(m + 1, 0);
+    memcpy(sa.data(), a, m * sizeof(Limb));
+    addInto(sa.data(), m + 1, a + m, a1n);
+    memcpy(sb.data(), b, m * sizeof(Limb));
+    addInto(sb.data(), m + 1, b + m, b1n);
+
+    size_t san = sa[m] ? m + 1 : m;
+    size_t sbn = sb[m] ? m + 1 : m;
+    Mag z1(san + sbn);
+    mulDispatch(z1.data(), sa.data(), san, sb.data(), sbn, forced);
+    subFrom(z1.data(), z1.size(), r, 2 * m);
+    subFrom(z1.data(), z1.size(), r + 2 * m, a1n + b1n);
+
+    size_t z1n = z1.size();
+    while (z1n > 0 && z1[z1n - 1] == 0) z1n--;
+    addInto(r + m, an + bn - m, z1.data(), z1n);
+}
+
+/**
+ * Signed magnitude used by the Toom-3 evaluation and interpolation
+ */
+struct Signed {
+    Mag mag;
+    bool negative = false;
+};
+
+Signed add(const Signed& a, const Signed& b) {
+    Signed r;
+    if (a.negative == b.negative) {
+        r.mag = a.mag;
+        addMagInPlace(r.mag, b.mag);
+        r.negative = a.negative;
+    } else if (compareMag(a.mag, b.mag) >= 0) {
+        r.mag = a.mag;
+        subMagInPlace(r.mag, b.mag);
+        r.negative = a.negative;
+    } else {
+        r.mag = b.mag;
+        subMagInPlace(r.mag, a.mag);
+        r.negative = b.negative;
+    }
+    if (r.mag.empty()) r.negative = false;
+    return r;
+}
+
+Signed sub(const Signed& a, Signed b) {
+    if (!b.mag.empty()) b.negative = !b.negative;
+    return add(a, b);
+}
+
+void shiftLeftOne(Mag& a) {
+    Limb carry = 0;
+    for (Limb& limb : a) {
+        Limb next = limb >> 63;
+        limb = (limb << 1) | carry;
+        carry = next;
+    }
+    if (carry) a.push_back(carry);
+}
+
+void shiftRightOne(Mag& a) {
+    for (size_t i = 0; i < a.size(); i++) {
+        a[i] = (a[i] >> 1) | (i + 1 < a.size() ? a[i + 1] << 63 : 0);
+    }
+    trim(a);
+}
+
+Signed mulSigned(const Signed& a, const Signed& b, MulAlgorithm forced) {
+    Signed r;
+    if (a.mag.empty() || b.mag.empty()) return r;
+    r.mag.assign(a.mag.size() + b.mag.size(), 0);
+    mulDispatch(r.mag.data(), a.mag.data(), a.mag.size(), b.mag.data(), b.mag.size(), forced);
+    trim(r.mag);
+    r.negative = a.negative != b.negative;
+    return r;
+}
+
+Signed slice(const Limb* p, size_t n, size_t from, size_t len) {
+    Signed r;
+    if (from < n) {
+        r.mag.assign(p + from, p + min(n, from + len));
+        trim(r.mag);
+    }
+    return r;
+}
+
+/**
+ * Toom-3: five third-size products instead of nine
+ */
+void mulToom3(Limb* r, const Limb* a, size_t an, const Limb* b, size_t bn, MulAlgorithm forced) {
+    size_t m = (an + 2) / 3;
+    Signed a0 = slice(a, an, 0, m), a1 = slice(a, an, m, m), a2 = slice(a, an, 2 * m, an);
+    Signed b0 = slice(b, bn, 0, m), b1 = slice(b, bn, m, m), b2 = slice(b, bn, 2 * m, bn);
+
+    // Evaluate at 1, -1, -2 (0 and infinity are a0/b0 and a2/b2)
+    auto evaluate = [](const Signed& x0, const Signed& x1, const Signed& x2,
+                       Signed& at1, Signed& atMinus1, Signed& atMinus2) {
+        Signed p = add(x0, x2);
+        at1 = add(p, x1);
+        atMinus1 = sub(p, x1);
+        atMinus2 = add(atMinus1, x2);
+        shiftLeftOne(atMinus2.mag);
+        atMinus2 = sub(atMinus2, x0);
+    };
+    Signed pa1, paMinus1, paMinus2, pb1, pbMinus1, pbMinus2;
+    evaluate(a0, a1, a2, pa1, paMinus1, paMinus2);
+    evaluate(b0, b1, b2, pb1, pbMinus1, pbMinus2);
+
+    Signed r0 = mulSigned(a0, b0, forced);
+    Signed r1 = mulSigned(pa1, pb1, forced);
+    Signed rMinus1 = mulSigned(paMinus1, pbMinus1, forced);
+    Signed rMinus2 = mulSigned(paMinus2, pbMinus2, forced);
+    Signed rInf = mulSigned(a2, b2, forced);
+
+    // Bodrato's interpolation; every division below is exact
+    Signed t3 = sub(rMinus2, r1);
+    divExactWordInPlace(t3.mag, 3);
+    Signed t1 = sub(r1, rMinus1);
+    shiftRightOne(t1.mag);
+    Signed t2 = sub(rMinus1, r0);
+    t3 = sub(t2, t3);
+    shiftRightOne(t3.mag);
+    Signed twoInf = rInf;
+    shiftLeftOne(twoInf.mag);
+    t3 = add(t3, twoInf);
+    t2 = sub(add(t2, t1), rInf);
+    t1 = sub(t1, t3);
+
+    // Coefficients of the product polynomial are all non-negative
+    size_t rn = an + bn;
+    memset(r, 0, rn * sizeof(Limb));
+    const Mag* coefficients[5] = {&r0.mag, &t1.mag, &t2.mag, &t3.mag, &rInf.mag};
+    for (size_t i = 0; i < 5; i++) {
+        const Mag& c = *coefficients[i];
+        if (c.empty()) continue;
+        addInto(r + i * m, rn - i * m, c.data(), c.size());
+    }
+}
+
+/**
+ * Arithmetic modulo one NTT prime in Montgomery form (R = 2^64)
+ */
+struct NttPrime {
+    Limb p;
+    Limb negInv;    // -p^-1 mod 2^64
+    Limb r2;        // R^2 mod p
+    Limb generator;
+
+    NttPrime(Limb prime, Limb g) : p(prime), generator(g) {
+        negInv = (Limb)0 - inverseModWord(prime);
+        Limb r1 = (Limb)(((u128)1 << 64) % prime);
+        r2 = (Limb)((u128)r1 * r1 % prime);
+    }
+
+    Limb reduce(u128 t) const {
+        Limb m = (Limb)t * negInv;
+        Limb u = (Limb)((t + (u128)m * p) >> 64);
+        return u >= p ? u - p : u;
+    }
+    Limb mul(Limb a, Limb b) const { return reduce((u128)a * b); }
+    Limb toMont(Limb a) const { return mul(a % p, r2); }
+    Limb fromMont(Limb a) const { return reduce(a); }
+    Limb addMod(Limb a, Limb b) const { Limb s = a + b; return s >= p ? s - p : s; }
+    Limb subMod(Limb a, Limb b) const { return a >= b ? a - b : a + p - b; }
+
+    Limb pow(Limb base, Limb exponent) const {     // Montgomery in, Montgomery out
+        Limb result = toMont(1);
+        while (exponent) {
+            if (exponent & 1) result = mul(result, base);
+            base = mul(base, base);
+            exponent >>= 1;
+        }
+        return result;
+    }
+};
+
+const NttPrime kPrimes[3] = {
+    NttPrime(4179340454199820289ULL, 3),   // 29 * 2^57 + 1
+    NttPrime(2485986994308513793ULL, 5),   // 69 * 2^55 + 1
+    NttPrime(1945555039024054273ULL, 5),   // 27 * 2^56 + 1
+};
+
+void ntt(vector<Limb>& a, const NttPrime& prime, bool inverse) {
+    size_t n = a.size();
+    for (size_t i = 1, j = 0; i < n; i++) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) swap(a[i], a[j]);
+    }
+
+    vector<Limb> roots(n / 2);
+    for (size_t len = 2; len <= n; len <<= 1) {
+        Limb w = prime.pow(prime.toMont(prime.generator), (prime.p - 1) / len);
+        if (inverse) w = prime.pow(w, prime.p - 2);
+        size_t half = len / 2;
+        roots[0] = prime.toMont(1);
+        for (size_t k = 1; k < half; k++) roots[k] = prime.mul(roots[k - 1], w);
+
+        for (size_t i = 0; i < n; i += len) {
+            for (size_t k = 0; k < half; k++) {
+                Limb u = a[i + k];
+                Limb v = prime.mul(a[i + k + half], roots[k]);
+                a[i + k] = prime.addMod(u, v);
+                a[i + k + half] = prime.subMod(u, v);
+            }
+        }
+    }
+
+    if (inverse) {
+        Limb nInv = prime.pow(prime.toMont(n), prime.p - 2);
+        for (Limb& x : a) x = prime.mul(x, nInv);
+    }
+}
+
+Limb powMod(Limb base, Limb exponent, Limb mod) {
+    u128 result = 1, b = base % mod;
+    while (exponent) {
+        if (exponent & 1) result = result * b % mod;
+        b = b * b % mod;
+        exponent >>= 1;
+    }
+    return (Limb)result;
+}
+
+/**
+ * Convolution of the limb vectors modulo three primes, recombined by
+ * Garner's CRT. Each coefficient is below n * 2^128 < p1*p2*p3.
+ */
+void mulNtt(Limb* r, const Limb* a, size_t an, const Limb* b, size_t bn) {
+    size_t need = an + bn - 1;
+    size_t len = 1;
+    while (len < need) len <<= 1;
+
+    vector<Limb> residues[3];
+    for (int t = 0; t < 3; t++) {
+        const NttPrime& prime = kPrimes[t];
+        vector<Limb> fa(len, 0), fb(len, 0);
+        for (size_t i = 0; i < an; i++) fa[i] = prime.toMont(a[i]);
+        for (size_t i = 0; i < bn; i++) fb[i] = prime.toMont(b[i]);
+        ntt(fa, prime, false);
+        ntt(fb, prime, false);
+        for (size_t i = 0; i < len; i++) fa[i] = prime.mul(fa[i], fb[i]);
+        ntt(fa, prime, true);
+        for (size_t i = 0; i < need; i++) fa[i] = prime.fromMont(fa[i]);
+        residues[t] = std::move(fa);
+    }
+
+    const Limb p1 = kPrimes[0].p, p2 = kPrimes[1].p, p3 = kPrimes[2].p;
+    const Limb inv1mod2 = powMod(p1, p2 - 2, p2);
+    const Limb inv1mod3 = powMod(p1, p3 - 2, p3);
+    const Limb inv2mod3 = powMod(p2, p3 - 2, p3);
+    const u128 p12 = (u128)p1 * p2;
+    const Limb p12lo = (Limb)p12, p12hi = (Limb)(p12 >> 64);
+
+    // Running 192-bit carry: (carryHi:carryLo)
+    u128 carryLo = 0;
+    Limb carryHi = 0;
+    size_t rn = an + bn;
+    for (size_t i = 0; i < rn; i++) {
+        u128 acc = carryLo;
+        Limb accHi = carryHi;
+
+        if (i < need) {
+            Limb x1 = residues[0][i];
+            Limb x2 = (Limb)((u128)((residues[1][i] + p2 - x1 % p2) % p2) * inv1mod2 % p2);
+            Limb t = (Limb)((u128)((residues[2][i] + p3 - x1 % p3) % p3) * inv1mod3 % p3);
+            Limb x3 = (Limb)((u128)((t + p3 - x2 % p3) % p3) * inv2mod3 % p3);
+
+            // value = x1 + x2*p1 + x3*p1*p2 as three limbs (v0, v1, v2)
+            u128 low = (u128)x2 * p1 + x1;
+            u128 mid = (u128)x3 * p12lo;
+            u128 high = (u128)x3 * p12hi;
+            u128 v0 = (u128)(Limb)low + (Limb)mid;
+            u128 v1 = (low >> 64) + (mid >> 64) + (Limb)high + (v0 >> 64);
+            Limb v2 = (Limb)(high >> 64) + (Limb)(v1 >> 64);
+
+            u128 sum = acc + (((u128)(Limb)v1 << 64) | (Limb)v0);
+            accHi += v2 + (sum < acc ? 1 : 0);
+            acc = sum;
+        }
+
+        r[i] = (Limb)acc;
+        carryLo = (acc >> 64) | ((u128)accHi << 64);
+        carryHi = 0;
+    }
+}
+
+void mulDispatch(Limb* r, const Limb* a, size_t an, const Limb* b, size_t bn, MulAlgorithm forced) {
+    if (an < bn) {
+        swap(a, b);
+        swap(an, bn);
+    }
+    if (bn == 0) {
+        memset(r, 0, an * sizeof(Limb));
+        return;
+    }
+
+    MulAlgorithm algorithm = forced;
+    if (algorithm == MulAlgorithm::Auto) {
+        algorithm = bn < gThresholds.karatsuba ? MulAlgorithm::Schoolbook
+                  : bn < gThresholds.toom3     ? MulAlgorithm::Karatsuba
+                  : bn < gThresholds.ntt       ? MulAlgorithm::Toom3
+                                               : MulAlgorithm::NTT;
+    }
+    if ((algorithm == MulAlgorithm::Karatsuba && bn < kMinKaratsuba) ||
+        (algorithm == MulAlgorithm::Toom3 && bn < kMinToom3)) {
+        algorithm = MulAlgorithm::Schoolbook;
+    }
+
+    switch (algorithm) {
+        case MulAlgorithm::Schoolbook:
+            mulSchoolbook(r, a, an, b, bn);
+            return;
+        case MulAlgorithm::NTT:
+            mulNtt(r, a, an, b, bn);
+            return;
+        case MulAlgorithm::Karatsuba:
+            if (bn <= (an + 1) / 2) {
+                mulUnbalanced(r, a, an, b, bn, forced);
+            } else {
+                mulKaratsuba(r, a, an, b, bn, forced);
+            }
+            return;
+        case MulAlgorithm::Toom3:
+        case MulAlgorithm::Auto:
+            if (bn <= (an + 1) / 2) {
+                mulUnbalanced(r, a, an, b, bn, forced);
+            } else {
+                mulToom3(r, a, an, b, bn, forced);
+            }
+            return;
+    }
+}
+
+} // namespace
+
+Mag multiply(const Mag& a, const Mag& b, MulAlgorithm algorithm) {
+    if (a.empty() || b.empty()) return Mag();
+    Mag result(a.size() + b.size());
+    mulDispatch(result.data(), a.data(), a.size(), b.data(), b.size(), algorithm);
+    trim(result);
+    return result;
+}
+
+} // namespace bigint_detail
+
+const MulThresholds& BigInt::mulThresholds() {
+    return bigint_detail::gThresholds;
+}
+
+void BigInt::setMulThresholds(const MulThresholds& thresholds) {
+    bigint_detail::gThresholds = thresholds;
+}
@@ -0,0 +1,457 @@
+/**
+ * Polynomial Solver - compile-time share sets
+ *
+ * A share document compiled into the binary (a built-in recovery key, the
+ * interactive test cases) can be solved by the compiler itself:
+ *
+ *   constexpr char kKey[] = R"({"keys": {"n": 3, "k": 2}, "1": {...}, ...})";
+ *   constexpr FixedInt<4> kSecret = embeddedSecret(kKey);
+ *   static_assert(kSecret == 42, "recovery key changed");
+ *
+ * Everything here is constexpr: a JSON-lite reader (objects, strings
+ * without escapes, integers; anything else is skipped), digit decoding
+ * into a fixed-width integer, and Lagrange at x = 0 with int64
+ * coefficients. Shares are chosen like solveFromJSON: ids 1..n in order,
+ * shares with bad digits skipped, the first k used. A malformed document,
+ * a value wider than the FixedInt, a non-integer secret or a keys.prime
+ * (shares modulo a prime; solveFromJSON handles those) throws, which in a
+ * constant expression is a compile error. The same functions also run at
+ * runtime.
+ *
+ * Meant for small embedded sets. Coefficients are products of ids and must
+ * fit in 63 bits (k up to about 15 with small ids).
+ */
+
+#ifndef EMBEDDED_SHARES_H
+#define EMBEDDED_SHARES_H
+
+#include "bigint.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Not constexpr on purpose: reaching one during constant evaluation fails
+// the build with the call in the diagnostic
+[[noreturn]] inline void embeddedParseError(const char* expected, std::size_t offset) {
+    throw std::invalid_argument(std::string("Embedded shares: expected ") + expected + " at byte " +
+                                std::to_string(offset));
+}
+
+[[noreturn]] inline void embeddedError(const char* message) {
+    throw std::invalid_argument(std::string("Embedded shares: ") + message);
+}
+
+[[noreturn]] inline void embeddedOverflow(const char* message) {
+    throw std::overflow_error(std::string("Embedded shares: ") + message);
+}
+
+/**
+ * Signed integer of Words 64-bit limbs (sign and magnitude, least
+ * significant limb first, like BigInt)
+ */
+template <std::size_t Words>
+class FixedInt {
+public:
+    constexpr FixedInt() : limbs_{}, negative_(false) {}
+
+    constexpr FixedInt(long long value) : limbs_{}, negative_(value < 0) {
+        limbs_[0] = value < 0 ? 0 - (std::uint64_t)value : (std::uint64_t)value;
+    }
+
+    constexpr bool isZero() const {
+        for (std::size_t i = 0; i < Words; i++) {
+            if (limbs_[i] != 0) return false;
+        }
+        return true;
+    }
+
+    constexpr bool isNegative() const { return negative_; }
+
+    /**
+     * Magnitude = magnitude * factor + addend
+     * @throws overflow_error: When the result needs more than Words limbs
+     */
+    constexpr void mulAdd(std::uint64_t factor, std::uint64_t addend) {
+        unsigned __int128 carry = addend;
+        for (std::size_t i = 0; i < Words; i++) {
+            carry += (unsigned __int128)limbs_[i] * factor;
+            limbs_[i] = (std::uint64_t)carry;
+            carry >>= 64;
+        }
+        if (carry != 0) embeddedOverflow("value does not fit the FixedInt");
+    }
+
+    /**
+     * Multiply by a signed word
+     * @throws overflow_error: When the result needs more than Words limbs
+     */
+    constexpr void mul(long long factor) {
+        mulAdd(factor < 0 ? 0 - (std::uint64_t)factor : (std::uint64_t)factor, 0);
+        if (factor < 0) negative_ = !negative_;
+        normalize();
+    }
+
+    /**
+     * Divide by a positive word, truncating toward zero
+     * @return: Remainder of the magnitude
+     */
+    constexpr std::uint64_t divide(std::uint64_t divisor) {
+        unsigned __int128 remainder = 0;
+        for (std::size_t i = Words; i-- > 0;) {
+            remainder = (remainder << 64) | limbs_[i];
+            limbs_[i] = (std::uint64_t)(remainder / divisor);
+            remainder %= divisor;
+        }
+        normalize();
+        return (std::uint64_t)remainder;
+    }
+
+    /**
+     * @throws overflow_error: When the sum needs more than Words limbs
+     */
+    constexpr FixedInt& operator+=(const FixedInt& other) {
+        if (negative_ == other.negative_) {
+            addMagnitude(other);
+        } else if (compareMagnitude(other) >= 0) {
+            subtractMagnitude(other);
+        } else {
+            FixedInt larger = other;
+            larger.subtractMagnitude(*this);
+            *this = larger;
+        }
+        normalize();
+        return *this;
+    }
+
+    friend constexpr bool operator==(const FixedInt& a, const FixedInt& b) {
+        if (a.negative_ != b.negative_) return false;
+        for (std::size_t i = 0; i < Words; i++) {
+            if (a.limbs_[i] != b.limbs_[i]) return false;
+        }
+        return true;
+    }
+
+    friend constexpr bool operator!=(const FixedInt& a, const FixedInt& b) { return !(a == b); }
+
+    BigInt toBigInt() const { return BigInt::fromLimbs(std::vector<BigInt::Limb>(limbs_.begin(), limbs_.end()), negative_); }
+
+private:
+    std::array<std::uint64_t, Words> limbs_;
+    bool negative_;
+
+    constexpr void normalize() {
+        if (isZero()) negative_ = false;
+    }
+
+    constexpr int compareMagnitude(const FixedInt& other) const {
+        for (std::size_t i = Words; i-- > 0;) {
+            if (limbs_[i] != other.limbs_[i]) return limbs_[i] < other.limbs_[i] ? -1 : 1;
+        }
+        return 0;
+    }
+
+    constexpr void addMagnitude(const FixedInt& other) {
+        std::uint64_t carry = 0;
+        for (std::size_t i = 0; i < Words; i++) {
+            unsigned __int128 sum = (unsigned __int128)limbs_[i] + other.limbs_[i] + carry;
+            limbs_[i] = (std::uint64_t)sum;
+            carry = (std::uint64_t)(sum >> 64);
+        }
+        if (carry != 0) embeddedOverflow("sum does not fit the FixedInt");
+    }
+
+    // Requires |this| >= |other|
+    constexpr void subtractMagnitude(const FixedInt& other) {
+        std::uint64_t borrow = 0;
+        for (std::size_t i = 0; i < Words; i++) {
+            std::uint64_t subtrahend = other.limbs_[i] + borrow;
+            borrow = (subtrahend < borrow || limbs_[i] < subtrahend) ? 1 : 0;
+            limbs_[i] -= subtrahend;
+        }
+    }
+};
+
+/**
+ * One share as written in the document; digits point into the document
+ */
+struct EmbeddedShare {
+    long long id = 0;
+    int base = 0;               // 0 when missing or not a number
+    std::string_view digits;
+};
+
+template <std::size_t MaxShares>
+struct EmbeddedShareSet {
+    int n = 0;
+    int k = 0;
+    std::size_t count = 0;
+    std::array<EmbeddedShare, MaxShares> shares{};
+};
+
+/**
+ * Cursor over a JSON-lite document
+ */
+class EmbeddedReader {
+public:
+    constexpr explicit EmbeddedReader(std::string_view text) : text_(text), pos_(0) {}
+
+    constexpr void skipSpace() {
+        while (pos_ < text_.size() &&
+               (text_[pos_] == ' ' || text_[pos_] == '\t' || text_[pos_] == '\n' || text_[pos_] == '\r')) {
+            pos_++;
+        }
+    }
+
+    constexpr bool consume(char c) {
+        skipSpace();
+        if (pos_ < text_.size() && text_[pos_] == c) {
+            pos_++;
+            return true;
+        }
+        return false;
+    }
+
+    constexpr void expect(char c, const char* what) {
+        if (!consume(c)) embeddedParseError(what, pos_);
+    }
+
+    constexpr char peek() {
+        skipSpace();
+        return pos_ < text_.size() ? text_[pos_] : '\0';
+    }
+
+    constexpr void expectEnd() {
+        skipSpace();
+        if (pos_ != text_.size()) embeddedParseError("end of document", pos_);
+    }
+
+    constexpr std::string_view readString() {
+        expect('"', "'\"'");
+        std::size_t start = pos_;
+        while (pos_ < text_.size() && text_[pos_] != '"') {
+            if (text_[pos_] == '\\') embeddedParseError("a string without escapes", pos_);
+            pos_++;
+        }
+        if (pos_ == text_.size()) embeddedParseError("closing '\"'", start);
+        return text_.substr(start, pos_++ - start);
+    }
+
+    constexpr long long readInteger() {
+        skipSpace();
+        std::size_t start = pos_;
+        bool negative = pos_ < text_.size() && text_[pos_] == '-';
+        if (negative) pos_++;
+        long long value = 0;
+        while (pos_ < text_.size() && text_[pos_] >= '0' && text_[pos_] <= '9') {
+            if (__builtin_mul_overflow(value, 10, &value) || __builtin_add_overflow(value, text_[pos_] - '0', &value)) {
+                embeddedParseError("an integer that fits 63 bits", start);
+            }
+            pos_++;
+        }
+        if (pos_ == start + (negative ? 1 : 0)) embeddedParseError("an integer", start);
+        return negative ? -value : value;
+    }
+
+    /**
+     * Skip any value: string, number, literal, object or array
+     */
+    constexpr void skipValue() {
+        char c = peek();
+        if (c == '"') {
+            readString();
+        } else if (c == '{' || c == '[') {
+            char close = c == '{' ? '}' : ']';
+            pos_++;
+            if (consume(close)) return;
+            do {
+                if (close == '}') {
+                    readString();
+                    expect(':', "':'");
+                }
+                skipValue();
+            } while (consume(','));
+            expect(close, close == '}' ? "'}'" : "']'");
+        } else {
+            std::size_t start = pos_;
+            while (pos_ < text_.size() && (text_[pos_] == '-' || text_[pos_] == '+' || text_[pos_] == '.' ||
+                                           (text_[pos_] >= '0' && text_[pos_] <= '9') ||
+                                           (text_[pos_] >= 'a' && text_[pos_] <= 'z') ||
+                                           (text_[pos_] >= 'A' && text_[pos_] <= 'Z'))) {
+                pos_++;
+            }
+            if (pos_ == start) embeddedParseError("a value", start);
+        }
+    }
+
+private:
+    std::string_view text_;
+    std::size_t pos_;
+};
+
+/**
+ * Share id of a member key: a decimal number without leading zeros, else 0
+ */
+constexpr long long embeddedShareId(std::string_view key) {
+    if (key.empty() || key.size() > 18 || (key[0] == '0')) return 0;
+    long long id = 0;
+    for (char c : key) {
+        if (c < '0' || c > '9') return 0;
+        id = id * 10 + (c - '0');
+    }
+    return id;
+}
+
+/**
+ * Read "keys" and the share objects of a document
+ * @throws invalid_argument: Malformed document (with byte offset), or more than MaxShares shares
+ */
+template <std::size_t MaxShares = 32>
+constexpr EmbeddedShareSet<MaxShares> parseEmbeddedShares(std::string_view json) {
+    EmbeddedShareSet<MaxShares> set;
+    EmbeddedReader reader(json);
+    reader.expect('{', "'{'");
+    if (!reader.consume('}')) {
+        do {
+            std::string_view key = reader.readString();
+            reader.expect(':', "':'");
+            long long id = embeddedShareId(key);
+            if (key == "keys" && reader.peek() == '{') {
+                reader.expect('{', "'{'");
+                if (reader.consume('}')) continue;
+                do {
+                    std::string_view name = reader.readString();
+                    reader.expect(':', "':'");
+                    if (name == "n" || name == "k") {
+                        long long value = reader.readInteger();
+                        (name == "n" ? set.n : set.k) = value > 0 && value <= 1000000 ? (int)value : 0;
+                    } else if (name == "prime") {
+                        embeddedError("keys.prime (shares modulo a prime) is not supported at compile time");
+                    } else {
+                        reader.skipValue();
+                    }
+                } while (reader.consume(','));
+                reader.expect('}', "'}'");
+            } else if (id != 0 && reader.peek() == '{') {
+                if (set.count == MaxShares) embeddedError("more shares than MaxShares");
+                EmbeddedShare& share = set.shares[set.count++];
+                share.id = id;
+                reader.expect('{', "'{'");
+                if (reader.consume('}')) continue;
+                do {
+                    std::string_view name = reader.readString();
+                    reader.expect(':', "':'");
+                    if ((name == "base" || name == "value") && reader.peek() == '"') {
+                        std::string_view text = reader.readString();
+                        if (name == "value") {
+                            share.digits = text;
+                        } else {
+                            long long base = embeddedShareId(text);
+                            share.base = base >= 2 && base <= 16 ? (int)base : 0;
+                        }
+                    } else {
+                        reader.skipValue();
+                    }
+                } while (reader.consume(','));
+                reader.expect('}', "'}'");
+            } else {
+                reader.skipValue();
+            }
+        } while (reader.consume(','));
+    }
+    reader.expect('}', "'}'");
+    reader.expectEnd();
+    return set;
+}
+
+/**
+ * Decode digits (either case) in base 2-16
+ * @return: false for an empty string or a digit outside the base
+ * @throws overflow_error: When the value needs more than Words limbs
+ */
+template <std::size_t Words>
+constexpr bool decodeEmbedded(std::string_view digits, int base, FixedInt<Words>& value) {
+    value = FixedInt<Words>();
+    if (digits.empty() || base < 2 || base > 16) return false;
+    for (char c : digits) {
+        int digit = c >= '0' && c <= '9' ? c - '0'
+                    : c >= 'a' && c <= 'f' ? c - 'a' + 10
+                    : c >= 'A' && c <= 'F' ? c - 'A' + 10
+                                           : 16;
+        if (digit >= base) return false;
+        value.mulAdd((std::uint64_t)base, (std::uint64_t)digit);
+    }
+    return true;
+}
+
+constexpr long long embeddedCheckedMul(long long a, long long b) {
+    long long product = 0;
+    if (__builtin_mul_overflow(a, b, &product)) embeddedOverflow("Lagrange coefficient past 63 bits");
+    return product;
+}
+
+/**
+ * Secret P(0) of a share document, computed exactly
+ * @throws invalid_argument: Malformed document, bad n/k, fewer than k valid shares, or a non-integer secret
+ * @throws overflow_error: A share value wider than Words limbs, or ids too large for int64 coefficients
+ */
+template <std::size_t Words = 4, std::size_t MaxShares = 32>
+constexpr FixedInt<Words> embeddedSecret(std::string_view json) {
+    EmbeddedShareSet<MaxShares> set = parseEmbeddedShares<MaxShares>(json);
+    if (set.n <= 0 || set.k <= 0 || set.k > set.n) embeddedError("invalid n or k (k must be <= n)");
+
+    // Ids 1..n in order, first occurrence of each, undecodable ones skipped
+    std::array<long long, MaxShares> xs{};
+    std::array<FixedInt<Words>, MaxShares> ys{};
+    std::size_t used = 0;
+    long long previous = 0;
+    while (used < (std::size_t)set.k) {
+        std::size_t next = MaxShares;
+        for (std::size_t i = 0; i < set.count; i++) {
+            const EmbeddedShare& share = set.shares[i];
+            if (share.id > previous && share.id <= set.n && (next == MaxShares || share.id < set.shares[next].id)) {
+                next = i;
+            }
+        }
+        if (next == MaxShares) embeddedError("not enough valid shares");
+        previous = set.shares[next].id;
+        if (decodeEmbedded(set.shares[next].digits, set.shares[next].base, ys[used])) {
+            xs[used++] = previous;
+        }
+    }
+
+    // secret = sum of y_i * num_i / den_i; scale every term to the common
+    // denominator so the sum stays integral until one final division
+    std::array<long long, MaxShares> numerators{};
+    std::array<long long, MaxShares> denominators{};
+    long long common = 1;
+    for (std::size_t i = 0; i < used; i++) {
+        long long numerator = 1;
+        long long denominator = 1;
+        for (std::size_t j = 0; j < used; j++) {
+            if (j == i) continue;
+            numerator = embeddedCheckedMul(numerator, xs[j]);
+            denominator = embeddedCheckedMul(denominator, xs[j] - xs[i]);
+        }
+        long long divisor = std::gcd(numerator, denominator);
+        numerators[i] = (denominator < 0 ? -numerator : numerator) / divisor;
+        denominators[i] = (denominator < 0 ? -denominator : denominator) / divisor;
+        common = embeddedCheckedMul(common / std::gcd(common, denominators[i]), denominators[i]);
+    }
+
+    FixedInt<Words> sum;
+    for (std::size_t i = 0; i < used; i++) {
+        FixedInt<Words> term = ys[i];
+        term.mul(embeddedCheckedMul(numerators[i], common / denominators[i]));
+        sum += term;
+    }
+    if (sum.divide((std::uint64_t)common) != 0) embeddedError("secret is not an integer");
+    return sum;
+}
+
+#endif // EMBEDDED_SHARES_H
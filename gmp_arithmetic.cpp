@@ -0,0 +1,82 @@
+/**
+ * Polynomial Solver - GNU MP backend implementation
+ */
+
+#include "gmp_arithmetic.h"
+
+#ifdef POLYSOLVER_HAVE_GMP
+
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+/**
+ * Temporaries of the calling thread; they keep their limbs between calls
+ */
+struct GmpScratch {
+    GmpInteger value;
+    GmpInteger difference;
+    vector<BigInt::Limb> limbs;
+    string text;
+};
+
+thread_local GmpScratch scratch;
+
+} // namespace
+
+GmpInteger GmpArithmetic::fromBigInt(const BigInt& value) {
+    GmpInteger result;
+    const vector<BigInt::Limb>& limbs = value.limbs();
+    mpz_import(result.get(), limbs.size(), -1, sizeof(BigInt::Limb), 0, 0, limbs.data());
+    if (value.isNegative()) mpz_neg(result.get(), result.get());
+    return result;
+}
+
+BigInt GmpArithmetic::toBigInt(const GmpInteger& value) {
+    vector<BigInt::Limb>& limbs = scratch.limbs;
+    limbs.resize(mpz_size(value.get()));
+    size_t count = 0;
+    mpz_export(limbs.data(), &count, -1, sizeof(BigInt::Limb), 0, 0, value.get());
+    limbs.resize(count);
+    return BigInt::fromLimbs(limbs, mpz_sgn(value.get()) < 0);
+}
+
+BigInt GmpArithmetic::decode(string_view digits, int base) {
+    // mpz_set_str also takes whitespace, signs and (past base 16) more
+    // letters; anything outside plain digits gets BigInt's exact message
+    bool plain = base >= 2 && base <= 16 && !digits.empty() &&
+                 digits.find_first_not_of("0123456789abcdefABCDEF") == string_view::npos;
+    if (plain) scratch.text.assign(digits);     // mpz_set_str wants a terminated string
+    if (!plain || mpz_set_str(scratch.value.get(), scratch.text.c_str(), base) != 0) {
+        return BigInt::fromString(digits, base);    // throws
+    }
+    return toBigInt(scratch.value);
+}
+
+string GmpArithmetic::encode(const BigInt& value, int base) {
+    if (base < 2 || base > 16) {
+        throw invalid_argument("Invalid output base (" + to_string(base) + ")");
+    }
+    const vector<BigInt::Limb>& limbs = value.limbs();
+    mpz_import(scratch.value.get(), limbs.size(), -1, sizeof(BigInt::Limb), 0, 0, limbs.data());
+    if (value.isNegative()) mpz_neg(scratch.value.get(), scratch.value.get());
+    scratch.text.resize(mpz_sizeinbase(scratch.value.get(), base) + 2);
+    mpz_get_str(&scratch.text[0], base, scratch.value.get());
+    return string(scratch.text.c_str());
+}
+
+void GmpArithmetic::mulDifference(GmpInteger& a, const GmpInteger& b, const GmpInteger& c) {
+    long difference;
+    if (mpz_fits_slong_p(b.get()) && mpz_fits_slong_p(c.get()) &&
+        !__builtin_sub_overflow(mpz_get_si(b.get()), mpz_get_si(c.get()), &difference)) {
+        mpz_mul_si(a.get(), a.get(), difference);
+    } else {
+        mpz_sub(scratch.difference.get(), b.get(), c.get());
+        mpz_mul(a.get(), a.get(), scratch.difference.get());
+    }
+}
+
+#endif // POLYSOLVER_HAVE_GMP
@@ -0,0 +1,111 @@
+/**
+ * Polynomial Solver - GNU MP backend (--backend gmp)
+ *
+ * An arithmetic policy (see arithmetic.h) over GMP integers, plus share
+ * decoding with mpz_set_str and printing with mpz_get_str. Only built when
+ * the Makefile finds libgmp (POLYSOLVER_HAVE_GMP); the in-tree BigInt is
+ * used otherwise. Decoding, printing and mixed-size products reuse
+ * per-thread mpz temporaries, so a solve allocates only its own values.
+ *
+ * This is the yardstick for the in-tree engine: same algorithm, GMP's
+ * kernels underneath.
+ */
+
+#ifndef GMP_ARITHMETIC_H
+#define GMP_ARITHMETIC_H
+
+#ifdef POLYSOLVER_HAVE_GMP
+
+#include "bigint.h"
+
+#include <gmp.h>
+
+#include <string>
+#include <string_view>
+
+/**
+ * Owning mpz_t with value semantics
+ */
+class GmpInteger {
+public:
+    GmpInteger() { mpz_init(value_); }
+    GmpInteger(long long value) { mpz_init_set_si(value_, (long)value); }
+    GmpInteger(const GmpInteger& other) { mpz_init_set(value_, other.value_); }
+    GmpInteger(GmpInteger&& other) noexcept {
+        mpz_init(value_);
+        mpz_swap(value_, other.value_);
+    }
+    ~GmpInteger() { mpz_clear(value_); }
+
+    GmpInteger& operator=(const GmpInteger& other) {
+        mpz_set(value_, other.value_);
+        return *this;
+    }
+    GmpInteger& operator=(GmpInteger&& other) noexcept {
+        mpz_swap(value_, other.value_);
+        return *this;
+    }
+
+    mpz_ptr get() { return value_; }
+    mpz_srcptr get() const { return value_; }
+
+    friend bool operator==(const GmpInteger& a, const GmpInteger& b) { return mpz_cmp(a.value_, b.value_) == 0; }
+
+private:
+    mpz_t value_;
+};
+
+static_assert(sizeof(long) == sizeof(long long), "the GMP backend assumes LP64");
+
+struct GmpArithmetic {
+    using Value = GmpInteger;
+    static constexpr bool kExact = true;
+    static constexpr bool kField = false;
+    static constexpr const char* kName = "gmp";
+
+    static Value fromInt(long long value) { return Value(value); }
+    static Value fromBigInt(const BigInt& value);
+    static BigInt toBigInt(const Value& value);
+
+    /**
+     * Parse share digits with mpz_set_str
+     * @throws invalid_argument: Same conditions and messages as BigInt::fromString
+     */
+    static BigInt decode(std::string_view digits, int base);
+
+    /**
+     * Print with mpz_get_str, lowercase digits, '-' prefix when negative
+     * @throws invalid_argument: For a base outside 2-16
+     */
+    static std::string encode(const BigInt& value, int base);
+
+    static bool isZero(const Value& a) { return mpz_sgn(a.get()) == 0; }
+    static void add(Value& a, const Value& b) { mpz_add(a.get(), a.get(), b.get()); }
+    static void sub(Value& a, const Value& b) { mpz_sub(a.get(), a.get(), b.get()); }
+
+    static void mul(Value& a, const Value& b) {
+        if (mpz_fits_slong_p(b.get())) {
+            mpz_mul_si(a.get(), a.get(), mpz_get_si(b.get()));
+        } else {
+            mpz_mul(a.get(), a.get(), b.get());
+        }
+    }
+
+    static void mulDifference(Value& a, const Value& b, const Value& c);
+
+    static Value gcd(const Value& a, const Value& b) {
+        Value result;
+        mpz_gcd(result.get(), a.get(), b.get());
+        return result;
+    }
+
+    static Value divExact(const Value& a, const Value& b) {
+        Value result;
+        mpz_divexact(result.get(), a.get(), b.get());
+        return result;
+    }
+};
+
+#endif // POLYSOLVER_HAVE_GMP
+
+#endif // GMP_ARITHMETIC_H
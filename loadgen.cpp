@@ -0,0 +1,372 @@
+/**
+ * Polynomial Solver - load generator for --serve (make loadgen)
+ *
+ * Opens many connections to a running solver server and drives either
+ * open-loop traffic (Poisson arrivals at a fixed total rate, independent
+ * of how fast replies come back) or closed-loop traffic (each connection
+ * sends its next document once the previous one is answered, optionally
+ * paced to a rate). Documents are generated from a seed or taken from a
+ * --record log.
+ *
+ * Latency is reported twice. Service time runs from the moment a document
+ * was actually written. Response time runs from the moment it was due,
+ * per the schedule. A server that stalls delays the writes behind the
+ * stall as well, and a load generator that measures from the write alone
+ * omits exactly the waiting it caused (coordinated omission). Response
+ * time keeps it.
+ *
+ * The server must reply one line per document (--format ndjson, the
+ * default, or quiet).
+ *
+ * Usage: ./loadgen --socket path [--connections c] [--open --rate r |
+ *        --closed [--rate r]] [--duration s] [--replay log | --gen-n n
+ *        --gen-k k --gen-digits d --gen-bases list --gen-pool p --seed s] [--json]
+ */
+
+#include "metrics.h"
+#include "recording.h"
+#include "workload.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <poll.h>
+#include <random>
+#include <sstream>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+using Clock = chrono::steady_clock;
+
+struct Options {
+    string socketPath;
+    int connections = 16;
+    bool openLoop = false;
+    double rate = 0;                // documents per second over all connections; 0: unpaced closed loop
+    double durationSeconds = 10;
+    double drainSeconds = 5;        // wait this long for replies after the last send
+    string replayPath;              // documents from a --record log instead of generated ones
+    WorkloadSpec spec;
+    size_t pool = 256;              // distinct generated documents, sent round robin
+    uint64_t seed = 1;
+    bool json = false;
+};
+
+struct Request {
+    Clock::time_point due;          // per the schedule
+    Clock::time_point sent;         // last byte handed to the kernel
+    uint64_t endOffset;             // position of its newline in the connection's output
+};
+
+struct Connection {
+    int fd = -1;
+    string output;                  // bytes not yet written
+    uint64_t written = 0;           // bytes written so far
+    uint64_t queued = 0;            // bytes ever queued
+    string input;                   // partial reply line
+    deque<Request> outstanding;     // sent or queued, not answered, in order
+    size_t unsent = 0;              // tail of outstanding still (partly) in output
+    Clock::time_point nextDue;      // closed loop
+};
+
+uint64_t nanos(Clock::duration duration) {
+    return duration.count() > 0 ? (uint64_t)chrono::duration_cast<chrono::nanoseconds>(duration).count() : 0;
+}
+
+int connectUnix(const string& path) {
+    sockaddr_un address;
+    memset(&address, 0, sizeof address);
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof address.sun_path) return -1;
+    memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, (const sockaddr*)&address, sizeof address) != 0 && errno != EINPROGRESS) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * Single-line documents: the server reads one per line, and a newline
+ * inside a JSON document is just whitespace
+ */
+vector<string> loadDocuments(const Options& options) {
+    vector<string> documents;
+    if (!options.replayPath.empty()) {
+        WorkloadReplay log(options.replayPath, 0.0);
+        for (RecordedDocument recorded; log.next(recorded);) documents.push_back(std::move(recorded.document));
+    } else {
+        WorkloadGenerator generator(options.seed);
+        for (size_t i = 0; i < options.pool; i++) documents.push_back(generator.next(options.spec).toJson());
+    }
+    for (string& document : documents) replace_if(document.begin(), document.end(),
+                                                  [](char c) { return c == '\n' || c == '\r'; }, ' ');
+    documents.erase(remove_if(documents.begin(), documents.end(),
+                              [](const string& d) { return d.find_first_not_of(" \t") == string::npos; }),
+                    documents.end());
+    return documents;
+}
+
+void writePercentiles(ostream& out, const char* label, const LatencySnapshot& latency) {
+    out << "  " << left << setw(10) << label << right << fixed << setprecision(1);
+    for (double q : {0.5, 0.9, 0.99, 0.999, 1.0}) out << setw(11) << latency.quantile(q) / 1000.0;
+    out << endl;
+}
+
+void writePercentilesJson(ostream& out, const LatencySnapshot& latency) {
+    out << "{\"count\":" << latency.count << ",\"p50\":" << latency.quantile(0.5) << ",\"p90\":"
+        << latency.quantile(0.9) << ",\"p99\":" << latency.quantile(0.99) << ",\"p999\":"
+        << latency.quantile(0.999) << ",\"max\":" << latency.quantile(1.0) << "}";
+}
+
+bool parsePositive(const string& text, double& value) {
+    char* end = nullptr;
+    value = strtod(text.c_str(), &end);
+    return !text.empty() && *end == '\0' && value > 0 && value < 1e12;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    bool closedGiven = false;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        double number = 0;
+        if (arg == "--socket" && hasValue) {
+            options.socketPath = argv[++i];
+        } else if (arg == "--open") {
+            options.openLoop = true;
+        } else if (arg == "--closed") {
+            closedGiven = true;
+        } else if ((arg == "--connections" || arg == "--gen-n" || arg == "--gen-k" || arg == "--gen-digits" ||
+                    arg == "--gen-pool") && hasValue) {
+            if (!parsePositive(argv[++i], number) || number != (double)(long long)number || number > 1e6) {
+                cerr << "Error: " << arg << " must be a whole number from 1 to 1000000" << endl;
+                return 2;
+            }
+            if (arg == "--connections") options.connections = (int)number;
+            else if (arg == "--gen-n") options.spec.n = (int)number;
+            else if (arg == "--gen-k") options.spec.k = (int)number;
+            else if (arg == "--gen-digits") options.spec.digits = (size_t)number;
+            else options.pool = (size_t)number;
+        } else if ((arg == "--rate" || arg == "--duration" || arg == "--drain") && hasValue) {
+            if (!parsePositive(argv[++i], number)) {
+                cerr << "Error: " << arg << " must be a positive number" << endl;
+                return 2;
+            }
+            (arg == "--rate" ? options.rate : arg == "--duration" ? options.durationSeconds
+                                                                  : options.drainSeconds) = number;
+        } else if (arg == "--gen-bases" && hasValue) {
+            options.spec.bases.clear();
+            stringstream list(argv[++i]);
+            for (string base; getline(list, base, ',');) options.spec.bases.push_back(atoi(base.c_str()));
+        } else if (arg == "--seed" && hasValue) {
+            options.seed = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--replay" && hasValue) {
+            options.replayPath = argv[++i];
+        } else if (arg == "--json") {
+            options.json = true;
+        } else {
+            cerr << "Usage: " << argv[0] << " --socket path [--connections c] [--open --rate r | --closed [--rate r]]\n"
+                 << "       [--duration s] [--drain s] [--replay log | --gen-n n --gen-k k --gen-digits d\n"
+                 << "       --gen-bases list --gen-pool p --seed s] [--json]" << endl;
+            return arg == "--help" ? 0 : 2;
+        }
+    }
+    if (options.socketPath.empty()) {
+        cerr << "Error: --socket is required" << endl;
+        return 2;
+    }
+    if (options.openLoop && (closedGiven || options.rate <= 0)) {
+        cerr << "Error: --open needs a --rate and excludes --closed" << endl;
+        return 2;
+    }
+
+    vector<string> documents;
+    try {
+        documents = loadDocuments(options);
+    } catch (const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 2;
+    }
+    if (documents.empty()) {
+        cerr << "Error: no documents to send" << endl;
+        return 2;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    vector<Connection> connections((size_t)options.connections);
+    for (Connection& connection : connections) {
+        connection.fd = connectUnix(options.socketPath);
+        if (connection.fd < 0) {
+            cerr << "Error: cannot connect to " << options.socketPath << ": " << strerror(errno) << endl;
+            return 1;
+        }
+    }
+
+    LatencyHistogram response, service;
+    uint64_t sent = 0, answered = 0, failed = 0;
+    size_t nextDocument = 0, nextConnection = 0;
+    mt19937_64 rng(options.seed);
+    exponential_distribution<double> gap(options.rate > 0 ? options.rate : 1.0);
+    Clock::duration interval = options.rate > 0 && !options.openLoop
+                                   ? chrono::duration_cast<Clock::duration>(
+                                         chrono::duration<double>(options.connections / options.rate))
+                                   : Clock::duration::zero();
+
+    Clock::time_point start = Clock::now();
+    Clock::time_point end = start + chrono::duration_cast<Clock::duration>(
+                                        chrono::duration<double>(options.durationSeconds));
+    Clock::time_point drainEnd = end + chrono::duration_cast<Clock::duration>(
+                                           chrono::duration<double>(options.drainSeconds));
+    Clock::time_point nextArrival = start;
+    for (size_t c = 0; c < connections.size(); c++) connections[c].nextDue = start + interval * c / connections.size();
+    Clock::time_point lastReply = start;
+
+    auto enqueue = [&](Connection& connection, Clock::time_point due) {
+        const string& document = documents[nextDocument++ % documents.size()];
+        connection.output += document;
+        connection.output += '\n';
+        connection.queued += document.size() + 1;
+        connection.outstanding.push_back({due, Clock::time_point(), connection.queued});
+        connection.unsent++;
+        sent++;
+    };
+
+    vector<pollfd> fds(connections.size());
+    for (;;) {
+        Clock::time_point now = Clock::now();
+        bool sending = now < end;
+        size_t outstanding = 0;
+        for (const Connection& connection : connections) outstanding += connection.outstanding.size();
+        if (!sending && (outstanding == 0 || now >= drainEnd)) break;
+
+        // Everything the schedule says is due by now
+        Clock::time_point wake = sending ? end : drainEnd;
+        if (sending && options.openLoop) {
+            for (; nextArrival <= now; nextArrival += chrono::duration_cast<Clock::duration>(
+                                           chrono::duration<double>(gap(rng)))) {
+                enqueue(connections[nextConnection++ % connections.size()], nextArrival);
+            }
+            wake = min(wake, nextArrival);
+        } else if (sending) {
+            for (Connection& connection : connections) {
+                if (!connection.outstanding.empty()) continue;
+                if (connection.nextDue <= now) {
+                    enqueue(connection, connection.nextDue);
+                    // Unpaced: the next one is due as soon as this is answered
+                    connection.nextDue += interval;
+                } else {
+                    wake = min(wake, connection.nextDue);
+                }
+            }
+        }
+
+        // Hand over whatever the sockets take without blocking
+        for (size_t c = 0; c < connections.size(); c++) {
+            Connection& connection = connections[c];
+            while (!connection.output.empty()) {
+                ssize_t written = write(connection.fd, connection.output.data(), connection.output.size());
+                if (written <= 0) break;
+                connection.output.erase(0, (size_t)written);
+                connection.written += (uint64_t)written;
+            }
+            Clock::time_point writtenAt = Clock::now();
+            size_t first = connection.outstanding.size() - connection.unsent;
+            while (connection.unsent > 0 && connection.outstanding[first].endOffset <= connection.written) {
+                connection.outstanding[first++].sent = writtenAt;
+                connection.unsent--;
+            }
+            fds[c] = {connection.fd, (short)(POLLIN | (connection.output.empty() ? 0 : POLLOUT)), 0};
+        }
+
+        now = Clock::now();
+        uint64_t waitNs = wake > now ? nanos(wake - now) : 0;
+        timespec timeout = {(time_t)(waitNs / 1000000000), (long)(waitNs % 1000000000)};
+        if (ppoll(fds.data(), fds.size(), &timeout, nullptr) < 0 && errno != EINTR) {
+            cerr << "Error: poll failed: " << strerror(errno) << endl;
+            return 1;
+        }
+
+        for (size_t c = 0; c < connections.size(); c++) {
+            if (!(fds[c].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+            Connection& connection = connections[c];
+            char buffer[1 << 16];
+            ssize_t got = read(connection.fd, buffer, sizeof buffer);
+            if (got == 0 || (got < 0 && errno != EAGAIN && errno != EINTR)) {
+                cerr << "Error: the server closed connection " << c << endl;
+                return 1;
+            }
+            if (got < 0) continue;
+            Clock::time_point arrived = Clock::now();
+            connection.input.append(buffer, (size_t)got);
+            size_t begin = 0;
+            for (size_t newline; (newline = connection.input.find('\n', begin)) != string::npos; begin = newline + 1) {
+                if (connection.outstanding.empty()) continue;   // more replies than requests: not line based
+                Request request = connection.outstanding.front();
+                connection.outstanding.pop_front();
+                if (connection.unsent > connection.outstanding.size()) connection.unsent--;
+                response.record(nanos(arrived - request.due));
+                service.record(nanos(arrived - (request.sent == Clock::time_point() ? request.due : request.sent)));
+                answered++;
+                // NDJSON replies carry a status; quiet ones only a secret
+                if (connection.input[begin] == '{' && connection.input.find("\"status\":\"ok\"", begin) > newline) {
+                    failed++;
+                }
+                if (interval == Clock::duration::zero()) connection.nextDue = arrived;
+            }
+            connection.input.erase(0, begin);
+            lastReply = arrived;
+        }
+    }
+
+    for (Connection& connection : connections) close(connection.fd);
+    double elapsed = chrono::duration<double>(max(lastReply, min(Clock::now(), end)) - start).count();
+    double throughput = elapsed > 0 ? (double)answered / elapsed : 0.0;
+    LatencySnapshot responseLatency, serviceLatency;
+    response.addTo(responseLatency);
+    service.addTo(serviceLatency);
+    string mode = options.openLoop ? "open" : "closed";
+
+    if (options.json) {
+        cout << "{\"loadgen\":\"polynomial_solver\",\"mode\":\"" << mode << "\",\"connections\":"
+             << options.connections << ",\"rate\":" << options.rate << ",\"duration_s\":" << options.durationSeconds
+             << ",\"sent\":" << sent << ",\"answered\":" << answered << ",\"failed\":" << failed
+             << ",\"throughput\":" << fixed << setprecision(1) << throughput << ",\"response_ns\":";
+        writePercentilesJson(cout, responseLatency);
+        cout << ",\"service_ns\":";
+        writePercentilesJson(cout, serviceLatency);
+        cout << "}" << endl;
+    } else {
+        cout << options.connections << " connections, " << mode << " loop";
+        if (options.rate > 0) cout << " at " << options.rate << " documents/s" << (options.openLoop ? " (Poisson)" : "");
+        cout << ", " << options.durationSeconds << " s, " << documents.size() << " distinct documents" << endl;
+        cout << "Sent " << sent << ", answered " << answered << " (" << failed << " failed), throughput "
+             << fixed << setprecision(1) << throughput << " documents/s" << endl;
+        cout << "Latency (us)         p50        p90        p99      p99.9        max" << endl;
+        writePercentiles(cout, "response", responseLatency);
+        writePercentiles(cout, "service", serviceLatency);
+        cout << "response: from when each document was due (corrected for coordinated omission)" << endl;
+        cout << "service:  from when it was written" << endl;
+    }
+    return answered == sent ? 0 : 1;
+}
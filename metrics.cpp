@@ -0,0 +1,183 @@
+/**
+ * Polynomial Solver - server metrics implementation
+ */
+
+#include "metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <ostream>
+
+using namespace std;
+
+namespace {
+
+uint64_t load(const atomic<uint64_t>& value) {
+    return value.load(memory_order_relaxed);
+}
+
+/**
+ * Nanoseconds as Prometheus base units (seconds)
+ */
+void writeSeconds(ostream& out, uint64_t ns) {
+    out << ns / 1000000000 << "." << setw(9) << setfill('0') << ns % 1000000000 << setfill(' ');
+}
+
+void writeHeader(ostream& out, const char* name, const char* type, const char* help) {
+    out << "# HELP " << name << " " << help << "\n# TYPE " << name << " " << type << "\n";
+}
+
+} // namespace
+
+LatencySnapshot::LatencySnapshot() : buckets(LatencyHistogram::kBuckets, 0) {}
+
+LatencySnapshot& LatencySnapshot::operator+=(const LatencySnapshot& other) {
+    for (int bucket = 0; bucket < LatencyHistogram::kBuckets; bucket++) buckets[bucket] += other.buckets[bucket];
+    count += other.count;
+    sum += other.sum;
+    return *this;
+}
+
+LatencySnapshot& LatencySnapshot::operator-=(const LatencySnapshot& other) {
+    for (int bucket = 0; bucket < LatencyHistogram::kBuckets; bucket++) buckets[bucket] -= other.buckets[bucket];
+    count -= other.count;
+    sum -= other.sum;
+    return *this;
+}
+
+uint64_t LatencySnapshot::quantile(double q) const {
+    // count and the buckets are read separately while workers record, so
+    // walk the buckets themselves
+    uint64_t total = 0;
+    for (uint64_t n : buckets) total += n;
+    if (total == 0) return 0;
+    uint64_t rank = std::max<uint64_t>(1, (uint64_t)ceil(q * (double)total));
+    uint64_t seen = 0;
+    for (int bucket = 0; bucket < LatencyHistogram::kBuckets; bucket++) {
+        seen += buckets[bucket];
+        if (seen >= rank) return LatencyHistogram::bucketHighest(bucket);
+    }
+    return 0;
+}
+
+int LatencyHistogram::bucketOf(uint64_t value) {
+    if (value < (uint64_t)2 * kHalfBuckets) return (int)value;
+    int shift = 63 - __builtin_clzll(value) - kSubBucketBits + 1;
+    return (shift + 1) * kHalfBuckets + (int)(value >> shift) - kHalfBuckets;
+}
+
+uint64_t LatencyHistogram::bucketLowest(int bucket) {
+    if (bucket < 2 * kHalfBuckets) return (uint64_t)bucket;
+    int shift = bucket / kHalfBuckets - 1;
+    return (uint64_t)(bucket % kHalfBuckets + kHalfBuckets) << shift;
+}
+
+uint64_t LatencyHistogram::bucketHighest(int bucket) {
+    if (bucket < 2 * kHalfBuckets) return (uint64_t)bucket;
+    int shift = bucket / kHalfBuckets - 1;
+    return bucketLowest(bucket) + (((uint64_t)1 << shift) - 1);
+}
+
+void LatencyHistogram::record(uint64_t value) {
+    bumpCounter(buckets_[bucketOf(value)]);
+    bumpCounter(count_);
+    bumpCounter(sum_, value);
+}
+
+void LatencyHistogram::addTo(LatencySnapshot& snapshot) const {
+    for (int bucket = 0; bucket < kBuckets; bucket++) snapshot.buckets[bucket] += load(buckets_[bucket]);
+    snapshot.count += load(count_);
+    snapshot.sum += load(sum_);
+}
+
+const char* serverStageName(ServerStage stage) {
+    switch (stage) {
+        case ServerStage::QueueWait: return "queue_wait";
+        case ServerStage::Parse:     return "parse";
+        case ServerStage::Solve:     return "solve";
+        case ServerStage::Total:     return "total";
+    }
+    return "unknown";
+}
+
+ServerMetrics::ServerMetrics(int workers) : started_(chrono::steady_clock::now()) {
+    for (int i = 0; i < workers; i++) workers_.emplace_back(new WorkerMetrics());
+}
+
+LatencySnapshot ServerMetrics::snapshot(ServerStage stage) const {
+    LatencySnapshot snapshot;
+    for (const unique_ptr<WorkerMetrics>& worker : workers_) worker->latency[(int)stage].addTo(snapshot);
+    return snapshot;
+}
+
+void ServerMetrics::writePrometheus(ostream& out, LatencySnapshot (&window)[kServerStageCount]) const {
+    // Workers first: they advance after the connection thread, so in-flight
+    // gauges computed from these reads never go negative
+    uint64_t started = 0, completed = 0, failures = 0, hits = 0, misses = 0;
+    for (const unique_ptr<WorkerMetrics>& worker : workers_) {
+        started += load(worker->started);
+        completed += load(worker->completed);
+        failures += load(worker->failures);
+        hits += load(worker->cacheHits);
+        misses += load(worker->cacheMisses);
+    }
+    uint64_t received = load(documents_);
+    uint64_t opened = load(connections_);
+    uint64_t closed = load(connectionsClosed_);
+    uint64_t uptimeNs = (uint64_t)chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now() - started_).count();
+
+    writeHeader(out, "polysolver_uptime_seconds", "gauge", "Time since the server started.");
+    out << "polysolver_uptime_seconds ";
+    writeSeconds(out, uptimeNs);
+    out << "\n";
+    writeHeader(out, "polysolver_workers", "gauge", "Solver threads.");
+    out << "polysolver_workers " << workers_.size() << "\n";
+    writeHeader(out, "polysolver_connections_total", "counter", "Client connections accepted.");
+    out << "polysolver_connections_total " << opened << "\n";
+    writeHeader(out, "polysolver_connections_open", "gauge", "Client connections still open.");
+    out << "polysolver_connections_open " << (opened > closed ? opened - closed : 0) << "\n";
+    writeHeader(out, "polysolver_received_documents_total", "counter", "Documents read from clients.");
+    out << "polysolver_received_documents_total " << received << "\n";
+    writeHeader(out, "polysolver_received_bytes_total", "counter", "Document bytes read from clients.");
+    out << "polysolver_received_bytes_total " << load(bytes_) << "\n";
+    writeHeader(out, "polysolver_solved_documents_total", "counter", "Documents answered, failed ones included.");
+    out << "polysolver_solved_documents_total " << completed << "\n";
+    writeHeader(out, "polysolver_failed_documents_total", "counter", "Documents answered with an error status.");
+    out << "polysolver_failed_documents_total " << failures << "\n";
+    writeHeader(out, "polysolver_worker_documents_total", "counter", "Documents answered per worker.");
+    for (size_t i = 0; i < workers_.size(); i++) {
+        out << "polysolver_worker_documents_total{worker=\"" << i << "\"} " << load(workers_[i]->completed) << "\n";
+    }
+    writeHeader(out, "polysolver_queued_documents", "gauge", "Documents waiting for a worker.");
+    out << "polysolver_queued_documents " << (received > started ? received - started : 0) << "\n";
+    writeHeader(out, "polysolver_in_flight_documents", "gauge", "Documents received and not yet answered.");
+    out << "polysolver_in_flight_documents " << (received > completed ? received - completed : 0) << "\n";
+    writeHeader(out, "polysolver_power_cache_lookups_total", "counter",
+                "Lookups in the per-thread cache of base chunk powers.");
+    out << "polysolver_power_cache_lookups_total{result=\"hit\"} " << hits << "\n";
+    out << "polysolver_power_cache_lookups_total{result=\"miss\"} " << misses << "\n";
+    writeHeader(out, "polysolver_power_cache_hit_ratio", "gauge", "Share of chunk power lookups served from cache.");
+    out << "polysolver_power_cache_hit_ratio " << (hits + misses ? (double)hits / (double)(hits + misses) : 0.0)
+        << "\n";
+
+    static const double kQuantiles[] = {0.5, 0.9, 0.99, 0.999};
+    writeHeader(out, "polysolver_latency_seconds", "summary",
+                "Document latency by stage; quantiles cover the time since the previous export.");
+    for (int stage = 0; stage < kServerStageCount; stage++) {
+        const char* name = serverStageName((ServerStage)stage);
+        LatencySnapshot current = snapshot((ServerStage)stage);
+        LatencySnapshot recent = current;
+        recent -= window[stage];
+        for (double q : kQuantiles) {
+            out << "polysolver_latency_seconds{stage=\"" << name << "\",quantile=\"" << q << "\"} ";
+            writeSeconds(out, recent.quantile(q));
+            out << "\n";
+        }
+        out << "polysolver_latency_seconds_sum{stage=\"" << name << "\"} ";
+        writeSeconds(out, current.sum);
+        out << "\npolysolver_latency_seconds_count{stage=\"" << name << "\"} " << current.count << "\n";
+        window[stage] = std::move(current);
+    }
+}
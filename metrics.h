@@ -0,0 +1,145 @@
+/**
+ * Polynomial Solver - server metrics (--serve)
+ *
+ * Latency histograms and counters of a long-running server, kept per
+ * worker thread so recording never takes a lock: every slot has a single
+ * writer (relaxed atomic stores), and an export sums the workers. Exports
+ * use the Prometheus text format (version 0.0.4).
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <vector>
+
+/**
+ * Add to a counter that only the calling thread writes; readers on other
+ * threads see a value that was current at some point
+ */
+inline void bumpCounter(std::atomic<std::uint64_t>& counter, std::uint64_t delta = 1) {
+    counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+/**
+ * Counts per bucket of a LatencyHistogram, summed and subtracted freely
+ */
+struct LatencySnapshot {
+    std::vector<std::uint64_t> buckets;
+    std::uint64_t count = 0;
+    std::uint64_t sum = 0;
+
+    LatencySnapshot();
+    LatencySnapshot& operator+=(const LatencySnapshot& other);
+    LatencySnapshot& operator-=(const LatencySnapshot& other);
+
+    /**
+     * Highest value of the bucket holding the q-th quantile (0 when empty)
+     * @param q: Quantile in [0, 1]
+     */
+    std::uint64_t quantile(double q) const;
+};
+
+/**
+ * HDR-style log-linear histogram: values below 64 are exact, larger ones
+ * fall into 32 sub-buckets per power of two, so every bucket is within
+ * 1/32 (about 3%) of its values all the way to 2^64. Single writer.
+ */
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 6;
+    static constexpr int kHalfBuckets = 1 << (kSubBucketBits - 1);
+    static constexpr int kBuckets = (66 - kSubBucketBits) * kHalfBuckets;
+
+    static int bucketOf(std::uint64_t value);
+    static std::uint64_t bucketLowest(int bucket);
+    static std::uint64_t bucketHighest(int bucket);
+
+    void record(std::uint64_t value);
+
+    /**
+     * Add the current counts into a snapshot
+     */
+    void addTo(LatencySnapshot& snapshot) const;
+
+private:
+    std::atomic<std::uint64_t> buckets_[kBuckets] = {};
+    std::atomic<std::uint64_t> count_{0};
+    std::atomic<std::uint64_t> sum_{0};
+};
+
+enum class ServerStage {
+    QueueWait,      // received until a worker picked the document up
+    Parse,          // locating and converting the shares
+    Solve,          // interpolation and range checks
+    Total           // received until the reply was written
+};
+constexpr int kServerStageCount = 4;
+
+/**
+ * Label value used in the export, e.g. "queue_wait"
+ */
+const char* serverStageName(ServerStage stage);
+
+/**
+ * Everything one worker thread records; written only by that worker
+ */
+struct alignas(64) WorkerMetrics {
+    LatencyHistogram latency[kServerStageCount];
+    std::atomic<std::uint64_t> started{0};
+    std::atomic<std::uint64_t> completed{0};
+    std::atomic<std::uint64_t> failures{0};
+    std::atomic<std::uint64_t> cacheHits{0};      // chunk power cache of the worker's thread
+    std::atomic<std::uint64_t> cacheMisses{0};
+};
+
+class ServerMetrics {
+public:
+    explicit ServerMetrics(int workers);
+
+    int workerCount() const { return (int)workers_.size(); }
+    WorkerMetrics& worker(int index) { return *workers_[index]; }
+    const WorkerMetrics& worker(int index) const { return *workers_[index]; }
+
+    // Shared by the connection thread, a replay and the last worker of a
+    // client, so these are real atomic adds
+    void connectionOpened() { connections_.fetch_add(1, std::memory_order_relaxed); }
+    void connectionClosed() { connectionsClosed_.fetch_add(1, std::memory_order_relaxed); }
+    void received(std::size_t bytes) {
+        documents_.fetch_add(1, std::memory_order_relaxed);
+        bytes_.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    std::uint64_t documentsReceived() const { return documents_.load(std::memory_order_relaxed); }
+
+    /**
+     * Latency counts of one stage over all workers
+     */
+    LatencySnapshot snapshot(ServerStage stage) const;
+
+    /**
+     * Prometheus text exposition: counters for documents, bytes,
+     * connections and cache lookups, gauges for in-flight work, and one
+     * summary per stage
+     * @param window: Latencies at the previous export through this window,
+     *                updated here; the quantiles cover the time since then
+     *                (the whole run on the first export) while _sum and
+     *                _count are run totals as Prometheus expects
+     */
+    void writePrometheus(std::ostream& out, LatencySnapshot (&window)[kServerStageCount]) const;
+
+private:
+    std::vector<std::unique_ptr<WorkerMetrics>> workers_;
+    std::chrono::steady_clock::time_point started_;
+    std::atomic<std::uint64_t> connections_{0};
+    std::atomic<std::uint64_t> connectionsClosed_{0};
+    std::atomic<std::uint64_t> documents_{0};
+    std::atomic<std::uint64_t> bytes_{0};
+};
+
+#endif // METRICS_H
@@ -0,0 +1,319 @@
+/**
+ * Polynomial Solver - kernel microbenchmarks (make microbench)
+ *
+ * Times the individual kernels behind a solve in isolation: long double
+ * and exact base conversion, Lagrange under each arithmetic policy, BigInt
+ * multiply, divide and print, share document parsing, and whole solves
+ * from the JSON against solves on a tape parsed once. With libgmp the same
+ * decode, print and Lagrange inputs also run through the GMP backend. Each
+ * kernel reports ns/op and bytes/cycle over the bytes it consumes, so a
+ * regression in the end-to-end --bench numbers can be pinned to one kernel.
+ *
+ * Usage: ./microbench [--filter text] [--min-time ms] [--json]
+ */
+
+#include "bigint.h"
+#include "gmp_arithmetic.h"
+#include "polynomial_solver.h"
+#include "workload.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define MICROBENCH_HAVE_TSC 1
+#endif
+
+using namespace std;
+
+namespace {
+
+using Clock = chrono::steady_clock;
+
+/**
+ * Keep the compiler from discarding a result it can see is unused
+ */
+template <typename T>
+inline void keep(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+struct Kernel {
+    string name;
+    size_t bytes;               // input bytes consumed per call
+    function<void()> run;
+};
+
+struct KernelResult {
+    string name;
+    size_t bytes;
+    double nsPerOp;
+    double bytesPerCycle;       // 0 when no cycle counter is available
+};
+
+/**
+ * Cycle counter ticks per nanosecond, measured against the steady clock;
+ * 0 when the host has no usable counter. The TSC ticks at the nominal
+ * frequency, so under turbo or throttling this is an approximation.
+ */
+double cyclesPerNs() {
+#ifdef MICROBENCH_HAVE_TSC
+    Clock::time_point start = Clock::now();
+    uint64_t startTicks = __rdtsc();
+    while (Clock::now() - start < chrono::milliseconds(50)) {
+    }
+    uint64_t ticks = __rdtsc() - startTicks;
+    double ns = (double)chrono::duration_cast<chrono::nanoseconds>(Clock::now() - start).count();
+    return ns > 0 ? (double)ticks / ns : 0;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * Median ns/call over five rounds; each round grows its call count until
+ * it runs for minTimeNs / 5
+ */
+double medianNsPerCall(const function<void()>& fn, double minTimeNs) {
+    fn();   // warm caches and the per-thread power tables
+    double roundNs = minTimeNs / 5;
+    size_t calls = 1;
+    vector<double> rounds;
+    while (rounds.size() < 5) {
+        Clock::time_point start = Clock::now();
+        for (size_t i = 0; i < calls; i++) fn();
+        double elapsed = (double)chrono::duration_cast<chrono::nanoseconds>(Clock::now() - start).count();
+        if (elapsed < roundNs && rounds.empty()) {
+            calls = elapsed > 0 ? max(calls * 2, (size_t)(calls * roundNs / elapsed)) : calls * 2;
+            continue;
+        }
+        rounds.push_back(elapsed / (double)calls);
+    }
+    sort(rounds.begin(), rounds.end());
+    return rounds[2];
+}
+
+string randomDigits(mt19937_64& rng, size_t length, int base) {
+    static const char kDigits[] = "0123456789abcdef";
+    string digits(length, '0');
+    for (char& c : digits) c = kDigits[rng() % (unsigned)base];
+    digits[0] = kDigits[1 + rng() % (unsigned)(base - 1)];
+    return digits;
+}
+
+BigInt randomLimbs(mt19937_64& rng, size_t limbs) {
+    return BigInt::fromString(randomDigits(rng, limbs * 16, 16), 16);
+}
+
+/**
+ * Lagrange at x = 0 under one arithmetic policy (arithmetic.h)
+ */
+template <class Arithmetic>
+void addLagrangeKernel(vector<Kernel>& kernels, const vector<BasicPoint<Arithmetic>>& points, size_t bytes) {
+    kernels.push_back({string("lagrange/") + Arithmetic::kName + "/k" + to_string(points.size()), bytes, [points] {
+                           typename Arithmetic::Value secret = Arithmetic::fromInt(0);
+                           PolynomialSolver::interpolate<Arithmetic>(points, points.size(), Arithmetic::fromInt(0),
+                                                                     secret);
+                           keep(secret);
+                       }});
+}
+
+/**
+ * Points of the shares under a policy; empty when a value does not fit it
+ */
+template <class Arithmetic>
+vector<BasicPoint<Arithmetic>> policyPoints(const vector<Share>& shares) {
+    vector<BasicPoint<Arithmetic>> points;
+    try {
+        for (const Share& share : shares) points.emplace_back(share.id, Arithmetic::fromBigInt(share.exactY));
+        typename Arithmetic::Value secret = Arithmetic::fromInt(0);
+        PolynomialSolver::interpolate<Arithmetic>(points, points.size(), Arithmetic::fromInt(0), secret);
+    } catch (const exception&) {
+        points.clear();
+    }
+    return points;
+}
+
+vector<Kernel> buildKernels() {
+    vector<Kernel> kernels;
+    mt19937_64 rng(1);
+
+    // Base conversion: the long double path and the exact digit decoder
+    for (int base : {2, 10, 16}) {
+        for (size_t length : {16, 64, 256}) {
+            string digits = randomDigits(rng, length, base);
+            kernels.push_back({"convertToDecimal/base" + to_string(base) + "/len" + to_string(length), length,
+                               [digits, base] { keep(PolynomialSolver::convertToDecimal(digits, base)); }});
+        }
+        for (size_t length : {20, 200, 2000, 20000}) {
+            string digits = randomDigits(rng, length, base);
+            kernels.push_back({"decode/base" + to_string(base) + "/len" + to_string(length), length,
+                               [digits, base] { keep(BigInt::fromString(digits, base)); }});
+#ifdef POLYSOLVER_HAVE_GMP
+            kernels.push_back({"gmp/decode/base" + to_string(base) + "/len" + to_string(length), length,
+                               [digits, base] { keep(GmpArithmetic::decode(digits, base)); }});
+#endif
+        }
+    }
+
+    // Interpolation over shares of a generated document
+    WorkloadGenerator generator(1);
+    for (int k : {3, 8, 64, 256}) {
+        WorkloadSpec spec;
+        spec.n = k;
+        spec.k = k;
+        spec.digits = 20;
+        GeneratedDocument document = generator.next(spec);
+        vector<PolynomialSolver::Point> points;
+        vector<Share> shares;
+        size_t bytes = 0;
+        for (const GeneratedShare& share : document.shares) {
+            BigInt y = BigInt::fromString(share.value, share.base);
+            shares.emplace_back(share.id, share.base, share.value, y);
+            points.emplace_back(share.id, shares.back().y);
+            bytes += share.value.size();
+        }
+        kernels.push_back({"lagrange/float/k" + to_string(k), bytes,
+                           [points, k] { keep(PolynomialSolver::lagrangeInterpolation(points, k)); }});
+        kernels.push_back({"lagrange/exact/k" + to_string(k), bytes, [shares] {
+                               BigInt secret;
+                               PolynomialSolver::exactLagrangeInterpolation(shares, secret);
+                               keep(secret);
+                           }});
+
+        // Whole solves: from the JSON each time, and again on a tape parsed once
+        string json = document.toJson();
+        PolynomialSolver solver;
+        // The tape's digits point into its document, so the kernel keeps both
+        shared_ptr<const string> source = make_shared<const string>(json);
+        shared_ptr<DocumentTape> tape = make_shared<DocumentTape>();
+        solver.buildTape(*source, *tape);
+        // Tape and result reused across calls, as the C ABI and the server do
+        shared_ptr<DocumentTape> parsed = make_shared<DocumentTape>();
+        shared_ptr<SolveResult> solved = make_shared<SolveResult>();
+        kernels.push_back({"solve/json/k" + to_string(k), json.size(), [json, solver, parsed, solved] {
+                               solver.solveFromJSON(json, *parsed, *solved);
+                               keep(*solved);
+                           }});
+        kernels.push_back({"solve/tape/k" + to_string(k), json.size(), [source, tape, solver, solved] {
+                               solver.recoverSecret(*tape, *solved);
+                               keep(*solved);
+                           }});
+
+        // The other policies side by side; int128 only while the sums fit
+        vector<BasicPoint<Int128Arithmetic>> wide = policyPoints<Int128Arithmetic>(shares);
+        if (!wide.empty()) addLagrangeKernel(kernels, wide, bytes);
+        addLagrangeKernel(kernels, policyPoints<Mersenne61Arithmetic>(shares), bytes);
+        addLagrangeKernel(kernels, policyPoints<RnsArithmetic>(shares), bytes);
+#ifdef POLYSOLVER_HAVE_GMP
+        addLagrangeKernel(kernels, policyPoints<GmpArithmetic>(shares), bytes);
+#endif
+        vector<BasicPoint<GF256Arithmetic>> bytePoints;
+        for (int x = 1; x <= min(k, 255); x++) bytePoints.emplace_back(x, (uint8_t)rng());
+        addLagrangeKernel(kernels, bytePoints, (size_t)bytePoints.size());
+    }
+
+    // BigInt arithmetic; operands are full random limbs
+    for (size_t limbs : {4, 32, 256, 2048, 8192}) {
+        BigInt a = randomLimbs(rng, limbs);
+        BigInt b = randomLimbs(rng, limbs);
+        BigInt wide = a * b;
+        string suffix = "/limbs" + to_string(limbs);
+        size_t bytes = limbs * sizeof(BigInt::Limb);
+        kernels.push_back({"bigint/mul" + suffix, 2 * bytes, [a, b] { keep(a * b); }});
+        kernels.push_back({"bigint/div" + suffix, 3 * bytes, [wide, b] {
+                               BigInt quotient, remainder;
+                               BigInt::divMod(wide, b, quotient, remainder);
+                               keep(quotient);
+                           }});
+        kernels.push_back({"bigint/divexact" + suffix, 3 * bytes,
+                           [wide, b] { keep(BigInt::divExact(wide, b)); }});
+        kernels.push_back({"bigint/tostring10" + suffix, bytes, [a] { keep(a.toString(10)); }});
+        kernels.push_back({"bigint/tostring16" + suffix, bytes, [a] { keep(a.toString(16)); }});
+#ifdef POLYSOLVER_HAVE_GMP
+        kernels.push_back({"gmp/tostring10" + suffix, bytes, [a] { keep(GmpArithmetic::encode(a, 10)); }});
+#endif
+    }
+
+    // Share document parsing, both modes, over the whole document
+    for (int n : {10, 1000}) {
+        WorkloadSpec spec;
+        spec.n = n;
+        spec.k = 3;
+        string json = generator.next(spec).toJson(false);
+        string suffix = "/n" + to_string(n);
+        for (ParseMode mode : {ParseMode::Lenient, ParseMode::Strict}) {
+            kernels.push_back({string("json/parse/") + parseModeName(mode) + suffix, json.size(), [json, mode] {
+                                   ShareDocument document;
+                                   parseShareDocument(json, mode, document);
+                                   keep(document.shares.size());
+                               }});
+        }
+    }
+    return kernels;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    string filter;
+    double minTimeMs = 200;
+    bool json = false;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--filter" && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (arg == "--min-time" && i + 1 < argc) {
+            minTimeMs = atof(argv[++i]);
+            if (!(minTimeMs > 0)) {
+                cerr << "Error: --min-time must be a positive number of milliseconds" << endl;
+                return 2;
+            }
+        } else if (arg == "--json") {
+            json = true;
+        } else {
+            cerr << "Usage: " << argv[0] << " [--filter text] [--min-time ms] [--json]" << endl;
+            return arg == "--help" ? 0 : 2;
+        }
+    }
+
+    double ticksPerNs = cyclesPerNs();
+    vector<KernelResult> results;
+    for (const Kernel& kernel : buildKernels()) {
+        if (!filter.empty() && kernel.name.find(filter) == string::npos) continue;
+        double ns = medianNsPerCall(kernel.run, minTimeMs * 1e6);
+        double bytesPerCycle = ticksPerNs > 0 ? (double)kernel.bytes / (ns * ticksPerNs) : 0;
+        results.push_back({kernel.name, kernel.bytes, ns, bytesPerCycle});
+
+        if (!json) {
+            cout << left << setw(36) << kernel.name << right << setw(9) << kernel.bytes << " B"
+                 << fixed << setprecision(1) << setw(14) << ns << " ns/op";
+            if (ticksPerNs > 0) cout << setprecision(4) << setw(12) << bytesPerCycle << " B/cycle";
+            cout << endl;
+        }
+    }
+
+    if (json) {
+        cout << "{\"microbench\":\"polynomial_solver\",\"ticks_per_ns\":" << fixed << setprecision(3)
+             << ticksPerNs << ",\"kernels\":[";
+        for (size_t i = 0; i < results.size(); i++) {
+            const KernelResult& r = results[i];
+            cout << (i > 0 ? "," : "") << "\n  {\"name\":\"" << r.name << "\",\"bytes\":" << r.bytes
+                 << ",\"ns_per_op\":" << setprecision(1) << r.nsPerOp
+                 << ",\"bytes_per_cycle\":" << setprecision(4) << r.bytesPerCycle << "}";
+        }
+        cout << "\n]}" << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,316 @@
+/**
+ * Polynomial Solver - buffered output layer implementation
+ */
+
+#include "output_writer.h"
+
+#include <cerrno>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <unistd.h>
+
+using namespace std;
+
+bool parseOutputFormat(const string& name, OutputFormat& format) {
+    if (name == "text")   { format = OutputFormat::Text;   return true; }
+    if (name == "quiet")  { format = OutputFormat::Quiet;  return true; }
+    if (name == "ndjson") { format = OutputFormat::NDJSON; return true; }
+    if (name == "csv")    { format = OutputFormat::CSV;    return true; }
+    if (name == "binary") { format = OutputFormat::Binary; return true; }
+    return false;
+}
+
+OutputWriter::OutputWriter(int outFd, int errFd, OutputFormat format, size_t bufferSize)
+    : outFd_(outFd), errFd_(errFd), format_(format),
+      bufferSize_(bufferSize > 0 ? bufferSize : kDefaultBufferSize),
+      buffer_(bufferSize_) {}
+
+OutputWriter::OutputWriter(string& sink, OutputFormat format, size_t bufferSize)
+    : OutputWriter(-1, -1, format, bufferSize) {
+    sink_ = &sink;
+}
+
+OutputWriter::~OutputWriter() {
+    try {
+        flush();
+    } catch (...) {
+        // Nothing sensible left to report to; the process is exiting
+    }
+}
+
+void OutputWriter::writeAll(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t written = ::write(fd, data, len);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            throw runtime_error(string("write failed: ") + strerror(errno));
+        }
+        data += written;
+        len -= (size_t)written;
+    }
+}
+
+void OutputWriter::emit(int fd, const char* data, size_t len) {
+    if (sink_) {
+        sink_->append(data, len);
+    } else {
+        writeAll(fd, data, len);
+    }
+}
+
+void OutputWriter::flush() {
+    if (!errors_.empty()) {
+        emit(errFd_, errors_.data(), errors_.size());
+        errors_.clear();
+    }
+    if (used_ > 0) {
+        size_t len = used_;
+        used_ = 0;
+        emit(outFd_, buffer_.data(), len);
+    }
+}
+
+void OutputWriter::maybeFlush() {
+    // Called between documents so a record is never split across writes
+    if (used_ >= bufferSize_ / 2) flush();
+}
+
+void OutputWriter::append(const char* data, size_t len) {
+    if (used_ + len > buffer_.size()) {
+        flush();
+        if (len > buffer_.size()) {
+            emit(outFd_, data, len);
+            return;
+        }
+    }
+    memcpy(buffer_.data() + used_, data, len);
+    used_ += len;
+}
+
+void OutputWriter::appendChar(char c) {
+    if (used_ == buffer_.size()) flush();
+    buffer_[used_++] = c;
+}
+
+void OutputWriter::appendInt(long long value) {
+    char digits[24];
+    to_chars_result r = to_chars(digits, digits + sizeof digits, value);
+    append(digits, (size_t)(r.ptr - digits));
+}
+
+void OutputWriter::appendUnsigned(unsigned long long value) {
+    char digits[24];
+    to_chars_result r = to_chars(digits, digits + sizeof digits, value);
+    append(digits, (size_t)(r.ptr - digits));
+}
+
+void OutputWriter::appendJsonString(const string& text) {
+    appendChar('"');
+    for (char c : text) {
+        switch (c) {
+            case '"':  append("\\\"", 2); break;
+            case '\\': append("\\\\", 2); break;
+            case '\n': append("\\n", 2); break;
+            case '\r': append("\\r", 2); break;
+            case '\t': append("\\t", 2); break;
+            default:
+                if ((unsigned char)c < 0x20) {
+                    char escaped[8];
+                    int len = snprintf(escaped, sizeof escaped, "\\u%04x", (unsigned)c);
+                    append(escaped, (size_t)len);
+                } else {
+                    appendChar(c);
+                }
+        }
+    }
+    appendChar('"');
+}
+
+void OutputWriter::appendCsvField(const string& text) {
+    if (text.find_first_of(",\"\n\r") == string::npos) {
+        append(text);
+        return;
+    }
+    appendChar('"');
+    for (char c : text) {
+        if (c == '"') appendChar('"');
+        appendChar(c);
+    }
+    appendChar('"');
+}
+
+template <typename T>
+void OutputWriter::appendRaw(T value) {
+    // Host order; every supported target is little-endian
+    char bytes[sizeof(T)];
+    memcpy(bytes, &value, sizeof(T));
+    append(bytes, sizeof(T));
+}
+
+void OutputWriter::note(const string& text) {
+    if (format_ == OutputFormat::Text) append(text);
+}
+
+void OutputWriter::writeResult(const string& source, const SolveResult& result) {
+    switch (format_) {
+        case OutputFormat::Text:   writeText(result); break;
+        case OutputFormat::Quiet:  writeQuiet(result); break;
+        case OutputFormat::NDJSON: writeNdjson(source, result); break;
+        case OutputFormat::CSV:    writeCsv(source, result); break;
+        case OutputFormat::Binary: writeBinary(source, result); break;
+    }
+    maybeFlush();
+}
+
+void OutputWriter::writeText(const SolveResult& result) {
+    if (result.status != SolveStatus::EmptyInput && result.status != SolveStatus::InvalidKeys &&
+        result.status != SolveStatus::MalformedDocument) {
+        append("Input: n=");
+        appendInt(result.n);
+        append(" roots, k=");
+        appendInt(result.k);
+        append(" minimum required\n");
+    }
+
+    for (const Share& share : result.shares) {
+        append("  Point ");
+        appendInt(share.id);
+        append(": \"");
+        append(share.value);
+        append("\" (base ");
+        appendInt(share.base);
+        append(") = ");
+        append(share.exactY.toString());
+        appendChar('\n');
+    }
+
+    for (const Diagnostic& d : result.diagnostics) {
+        if (d.level == DiagnosticLevel::Warning && d.shareId != 0) {
+            errors_ += "  Warning: " + d.message + "\n";
+        } else if (d.level == DiagnosticLevel::Error) {
+            errors_ += "Error: " + d.message + "\n";
+        }
+    }
+
+    if (!result.ok()) return;
+
+    string secret = result.secretString(secretBase_);
+    append("Secret (constant term): ");
+    append(secret);
+    appendChar('\n');
+    for (const Diagnostic& d : result.diagnostics) {
+        if (d.level == DiagnosticLevel::Warning && d.shareId == 0) {
+            append("Note: ");
+            append(d.message);
+            appendChar('\n');
+        }
+    }
+    append("\nFinal Answer: ");
+    append(secret);
+    appendChar('\n');
+}
+
+void OutputWriter::writeQuiet(const SolveResult& result) {
+    if (!result.ok()) return;
+    append(result.secretString(secretBase_));
+    appendChar('\n');
+}
+
+void OutputWriter::writeNdjson(const string& source, const SolveResult& result) {
+    append("{\"source\":");
+    appendJsonString(source);
+    append(",\"status\":\"");
+    append(solveStatusName(result.status));
+    append("\",\"n\":");
+    appendInt(result.n);
+    append(",\"k\":");
+    appendInt(result.k);
+    if (result.ok()) {
+        append(",\"secret\":\"");
+        append(result.secretString(secretBase_));
+        append("\",\"fits_int64\":");
+        append(result.fitsInt64 ? "true" : "false");
+    }
+    append(",\"shares\":[");
+    for (size_t i = 0; i < result.sharesUsed; i++) {
+        if (i > 0) appendChar(',');
+        appendInt(result.shares[i].id);
+    }
+    append("],\"diagnostics\":[");
+    for (size_t i = 0; i < result.diagnostics.size(); i++) {
+        const Diagnostic& d = result.diagnostics[i];
+        if (i > 0) appendChar(',');
+        append(d.level == DiagnosticLevel::Error ? "{\"level\":\"error\",\"share\":"
+                                                 : "{\"level\":\"warning\",\"share\":");
+        appendInt(d.shareId);
+        append(",\"message\":");
+        appendJsonString(d.message);
+        appendChar('}');
+    }
+    append("],\"timings_ns\":{\"parse\":");
+    appendUnsigned(result.timings.parseNs);
+    append(",\"convert\":");
+    appendUnsigned(result.timings.convertNs);
+    append(",\"interpolate\":");
+    appendUnsigned(result.timings.interpolateNs);
+    append(",\"verify\":");
+    appendUnsigned(result.timings.verifyNs);
+    append(",\"total\":");
+    appendUnsigned(result.timings.totalNs);
+    append("}}\n");
+}
+
+void OutputWriter::writeCsv(const string& source, const SolveResult& result) {
+    if (!headerWritten_) {
+        append("source,status,n,k,secret,shares_used,warnings,total_ns\n");
+        headerWritten_ = true;
+    }
+
+    size_t warnings = 0;
+    for (const Diagnostic& d : result.diagnostics) {
+        if (d.level == DiagnosticLevel::Warning) warnings++;
+    }
+
+    appendCsvField(source);
+    appendChar(',');
+    append(solveStatusName(result.status));
+    appendChar(',');
+    appendInt(result.n);
+    appendChar(',');
+    appendInt(result.k);
+    appendChar(',');
+    if (result.ok()) append(result.secretString(secretBase_));
+    appendChar(',');
+    appendUnsigned(result.sharesUsed);
+    appendChar(',');
+    appendUnsigned(warnings);
+    appendChar(',');
+    appendUnsigned(result.timings.totalNs);
+    appendChar('\n');
+}
+
+void OutputWriter::writeBinary(const string& source, const SolveResult& result) {
+    if (!headerWritten_) {
+        append("PSOLVR1\0", 8);
+        headerWritten_ = true;
+    }
+
+    string secret = result.ok() ? result.secretString(secretBase_) : string();
+    uint32_t recordBytes = (uint32_t)(1 + 1 + 2 + 4 + 4 + 8 + 8 + 8 + 4 + secret.size() + 4 + source.size());
+
+    appendRaw<uint32_t>(recordBytes);
+    appendRaw<uint8_t>((uint8_t)result.status);
+    appendRaw<uint8_t>(result.fitsInt64 ? 1 : 0);
+    appendRaw<uint16_t>(0);
+    appendRaw<int32_t>(result.n);
+    appendRaw<int32_t>(result.k);
+    appendRaw<int64_t>(result.fitsInt64 ? result.secretInt64 : 0);
+    appendRaw<double>((double)result.secret);
+    appendRaw<uint64_t>(result.timings.totalNs);
+    appendRaw<uint32_t>((uint32_t)secret.size());
+    append(secret);
+    appendRaw<uint32_t>((uint32_t)source.size());
+    append(source);
+}
@@ -0,0 +1,139 @@
+/**
+ * Polynomial Solver - buffered output layer
+ *
+ * Formats SolveResults into one large in-memory buffer and hands it to the
+ * kernel with a single write(2) whenever the buffer fills (and once at the
+ * end), so batch runs are not bound by per-line flushes.
+ *
+ * Formats:
+ *   text    classic human-readable layout (the default)
+ *   quiet   secret only, one line per document
+ *   ndjson  one JSON object per document
+ *   csv     header line, then one row per document
+ *   binary  length-prefixed little-endian records (layout below)
+ *
+ * Secrets are exact whenever the shares determine an integer secret, and
+ * are written in decimal unless setSecretBase() picks another base.
+ *
+ * Binary layout: the stream starts with the 8-byte magic "PSOLVR1\0",
+ * then one record per document:
+ *   u32 recordBytes          bytes following this field
+ *   u8  status               SolveStatus value
+ *   u8  flags                bit 0: secretInt64 valid
+ *   u16 reserved
+ *   i32 n, i32 k
+ *   i64 secretInt64
+ *   f64 secret               approximate value
+ *   u64 totalNs
+ *   u32 secretLen, then that many digit bytes (in the secret base)
+ *   u32 sourceLen, then that many source label bytes
+ */
+
+#ifndef OUTPUT_WRITER_H
+#define OUTPUT_WRITER_H
+
+#include "polynomial_solver.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class OutputFormat {
+    Text,
+    Quiet,
+    NDJSON,
+    CSV,
+    Binary
+};
+
+/**
+ * Parse a --format argument
+ * @param name: "text", "quiet", "ndjson", "csv" or "binary"
+ * @param format: Set on success
+ * @return: false for an unknown name
+ */
+bool parseOutputFormat(const std::string& name, OutputFormat& format);
+
+class OutputWriter {
+public:
+    static constexpr size_t kDefaultBufferSize = 1 << 20;
+
+    /**
+     * @param outFd: Descriptor for results (normally STDOUT_FILENO)
+     * @param errFd: Descriptor for text-mode warnings and errors
+     * @param format: Output format for every writeResult call
+     * @param bufferSize: Flush threshold in bytes
+     */
+    OutputWriter(int outFd, int errFd, OutputFormat format, size_t bufferSize = kDefaultBufferSize);
+
+    /**
+     * Collect output instead of writing it: every flush appends to sink
+     * (warnings first, as with descriptors), for callers that send the
+     * bytes themselves
+     * @param sink: Outlives the writer; never cleared by it
+     */
+    OutputWriter(std::string& sink, OutputFormat format, size_t bufferSize = kDefaultBufferSize);
+    ~OutputWriter();
+
+    OutputWriter(const OutputWriter&) = delete;
+    OutputWriter& operator=(const OutputWriter&) = delete;
+
+    OutputFormat format() const { return format_; }
+
+    /**
+     * Base (2-16) secrets are written in; decimal by default
+     */
+    void setSecretBase(int base) { secretBase_ = base; }
+
+    /**
+     * Format one result
+     * @param source: Label for the document (file name, "stdin", "file:line")
+     * @param result: Result to format
+     */
+    void writeResult(const std::string& source, const SolveResult& result);
+
+    /**
+     * Free-form text, written only in text format (banners, headings)
+     */
+    void note(const std::string& text);
+
+    /**
+     * Hand everything buffered so far to the kernel (or to the sink)
+     * @throws runtime_error: If write(2) fails
+     */
+    void flush();
+
+private:
+    void append(const char* data, size_t len);
+    void append(const std::string& text) { append(text.data(), text.size()); }
+    void appendChar(char c);
+    void appendInt(long long value);
+    void appendUnsigned(unsigned long long value);
+    void appendJsonString(const std::string& text);
+    void appendCsvField(const std::string& text);
+    template <typename T> void appendRaw(T value);
+    void maybeFlush();
+
+    void writeText(const SolveResult& result);
+    void writeQuiet(const SolveResult& result);
+    void writeNdjson(const std::string& source, const SolveResult& result);
+    void writeCsv(const std::string& source, const SolveResult& result);
+    void writeBinary(const std::string& source, const SolveResult& result);
+
+    void emit(int fd, const char* data, size_t len);
+    static void writeAll(int fd, const char* data, size_t len);
+
+    int outFd_;
+    int errFd_;
+    std::string* sink_ = nullptr;
+    OutputFormat format_;
+    size_t bufferSize_;
+    std::vector<char> buffer_;
+    size_t used_ = 0;
+    std::string errors_;
+    int secretBase_ = 10;
+    bool headerWritten_ = false;
+};
+
+#endif // OUTPUT_WRITER_H
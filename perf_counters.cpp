@@ -0,0 +1,140 @@
+/**
+ * Polynomial Solver - hardware performance counters implementation
+ */
+
+#include "perf_counters.h"
+
+#include <cerrno>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+const char* hardwareEventName(HardwareEvent event) {
+    switch (event) {
+        case HardwareEvent::Cycles:       return "cycles";
+        case HardwareEvent::Instructions: return "instructions";
+        case HardwareEvent::CacheMisses:  return "cache_misses";
+        case HardwareEvent::BranchMisses: return "branch_misses";
+    }
+    return "unknown";
+}
+
+HardwareCounts& HardwareCounts::operator+=(const HardwareCounts& other) {
+    for (int i = 0; i < kHardwareEventCount; i++) values[i] += other.values[i];
+    return *this;
+}
+
+HardwareCounts& HardwareCounts::operator-=(const HardwareCounts& other) {
+    for (int i = 0; i < kHardwareEventCount; i++) values[i] -= other.values[i];
+    return *this;
+}
+
+double HardwareCounts::ipc() const {
+    uint64_t cycles = (*this)[HardwareEvent::Cycles];
+    return cycles ? (double)(*this)[HardwareEvent::Instructions] / (double)cycles : 0.0;
+}
+
+#ifdef __linux__
+
+namespace {
+
+int openEvent(uint64_t config, int groupFd) {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof attr);
+    attr.size = sizeof attr;
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.read_format = PERF_FORMAT_GROUP;
+    attr.disabled = groupFd < 0 ? 1 : 0;    // the leader enables the whole group
+    attr.exclude_kernel = 1;                // allowed at perf_event_paranoid <= 2
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, PERF_FLAG_FD_CLOEXEC);
+}
+
+} // namespace
+
+PerfCounterGroup::PerfCounterGroup() {
+    static const uint64_t kConfigs[kHardwareEventCount] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+
+    leader_ = openEvent(kConfigs[0], -1);
+    if (leader_ < 0) {
+        int error = errno;
+        reason_ = string("perf_event_open: ") + strerror(error);
+        if (error == EACCES || error == EPERM) {
+            reason_ += " (see /proc/sys/kernel/perf_event_paranoid)";
+        } else if (error == ENOENT || error == EOPNOTSUPP) {
+            reason_ += " (no hardware PMU, e.g. inside a VM)";
+        }
+        return;
+    }
+    fds_[0] = leader_;
+    slot_[0] = opened_++;
+    for (int event = 1; event < kHardwareEventCount; event++) {
+        fds_[event] = openEvent(kConfigs[event], leader_);
+        if (fds_[event] >= 0) slot_[event] = opened_++;
+    }
+    ioctl(leader_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+PerfCounterGroup::~PerfCounterGroup() {
+    for (int fd : fds_) {
+        if (fd >= 0) close(fd);
+    }
+}
+
+HardwareCounts PerfCounterGroup::read() const {
+    HardwareCounts counts;
+    if (leader_ < 0) return counts;
+
+    // PERF_FORMAT_GROUP: u64 nr, then one u64 value per member in open order
+    uint64_t buffer[1 + kHardwareEventCount];
+    ssize_t bytes = ::read(leader_, buffer, sizeof buffer);
+    if (bytes < (ssize_t)sizeof(uint64_t) || buffer[0] != (uint64_t)opened_) return counts;
+    for (int event = 0; event < kHardwareEventCount; event++) {
+        if (slot_[event] >= 0) counts.values[event] = buffer[1 + slot_[event]];
+    }
+    return counts;
+}
+
+#else
+
+PerfCounterGroup::PerfCounterGroup() : reason_("hardware counters need Linux perf_event_open") {}
+
+PerfCounterGroup::~PerfCounterGroup() = default;
+
+HardwareCounts PerfCounterGroup::read() const {
+    return HardwareCounts();
+}
+
+#endif
+
+void PerfPhaseObserver::reset() {
+    for (HardwareCounts& counts : phases_) counts = HardwareCounts();
+    nested_ = HardwareCounts();
+}
+
+void PerfPhaseObserver::phaseBegin(SolvePhase phase) {
+    if (phase == SolvePhase::Parse) nested_ = HardwareCounts();
+    started_[(int)phase] = group_.read();
+}
+
+void PerfPhaseObserver::phaseEnd(SolvePhase phase) {
+    HardwareCounts delta = group_.read();
+    delta -= started_[(int)phase];
+    if (phase == SolvePhase::Convert) {
+        nested_ += delta;
+    } else if (phase == SolvePhase::Parse) {
+        delta -= nested_;
+    }
+    phases_[(int)phase] += delta;
+}
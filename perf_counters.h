@@ -0,0 +1,96 @@
+/**
+ * Polynomial Solver - hardware performance counters
+ *
+ * Reads cycles, instructions, cache misses and branch misses of the
+ * calling thread through perf_event_open(2), user space only, and splits
+ * them by solver phase through a SolveObserver. Where the counters cannot
+ * be opened (not Linux, perf_event_paranoid, containers, VMs without a
+ * PMU) everything reads as zero and unavailableReason() says why; callers
+ * report that instead of failing.
+ */
+
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include "polynomial_solver.h"
+
+#include <cstdint>
+#include <string>
+
+enum class HardwareEvent { Cycles, Instructions, CacheMisses, BranchMisses };
+constexpr int kHardwareEventCount = 4;
+
+/**
+ * Name used in JSON output, e.g. "cache_misses"
+ */
+const char* hardwareEventName(HardwareEvent event);
+
+struct HardwareCounts {
+    std::uint64_t values[kHardwareEventCount] = {};
+
+    std::uint64_t operator[](HardwareEvent event) const { return values[(int)event]; }
+    HardwareCounts& operator+=(const HardwareCounts& other);
+    HardwareCounts& operator-=(const HardwareCounts& other);
+
+    /**
+     * Instructions per cycle, 0 when no cycles were counted
+     */
+    double ipc() const;
+};
+
+/**
+ * One counter group for the calling thread, opened on construction
+ */
+class PerfCounterGroup {
+public:
+    PerfCounterGroup();
+    ~PerfCounterGroup();
+
+    PerfCounterGroup(const PerfCounterGroup&) = delete;
+    PerfCounterGroup& operator=(const PerfCounterGroup&) = delete;
+
+    bool available() const { return leader_ >= 0; }
+
+    /**
+     * Whether an event opened; cache and branch misses may be missing on
+     * virtual PMUs even when cycles work
+     */
+    bool has(HardwareEvent event) const { return slot_[(int)event] >= 0; }
+
+    const std::string& unavailableReason() const { return reason_; }
+
+    /**
+     * Totals since the group was opened (zeros for missing events)
+     */
+    HardwareCounts read() const;
+
+private:
+    int leader_ = -1;
+    int fds_[kHardwareEventCount] = {-1, -1, -1, -1};
+    int slot_[kHardwareEventCount] = {-1, -1, -1, -1};     // position in a group read
+    int opened_ = 0;
+    std::string reason_;
+};
+
+/**
+ * Counts per phase of the solves since the last reset(); Convert is
+ * subtracted from the Parse span it is nested in
+ */
+class PerfPhaseObserver : public SolveObserver {
+public:
+    explicit PerfPhaseObserver(const PerfCounterGroup& group) : group_(group) {}
+
+    void reset();
+    const HardwareCounts& phase(SolvePhase phase) const { return phases_[(int)phase]; }
+
+    void phaseBegin(SolvePhase phase) override;
+    void phaseEnd(SolvePhase phase) override;
+
+private:
+    const PerfCounterGroup& group_;
+    HardwareCounts started_[kSolvePhaseCount];
+    HardwareCounts phases_[kSolvePhaseCount];
+    HardwareCounts nested_;         // convert counts inside the open parse span
+};
+
+#endif // PERF_COUNTERS_H
@@ -1,593 +1,2161 @@
-/**
- * Polynomial Solver - Shamir's Secret Sharing Implementation
- * 
- * This program solves polynomial coefficients using Shamir's Secret Sharing scheme.
- * It reads test cases in JSON format and uses Lagrange interpolation to find the 
- * constant term (secret) of the polynomial.
- * 
- * Author: GitHub Repository
- * Date: September 2025
- * Version: 2.0
- * 
- * Usage:
- *   ./polynomial_solver                          # Interactive mode with built-in test cases
- *   ./polynomial_solver < input.json            # Read JSON from stdin
- *   ./polynomial_solver input.json              # Read JSON from file
- *   ./polynomial_solver --test                  # Run comprehensive tests
- * 
- * Algorithm: Lagrange Interpolation
- * For a polynomial P(x) of degree m, given k = m + 1 points (x₁, y₁), ..., (xₖ, yₖ):
- * P(0) = Σᵢ₌₁ᵏ yᵢ * Πⱼ₌₁,ⱼ≠ᵢᵏ [(0 - xⱼ) / (xᵢ - xⱼ)]
- */
-
-#include <iostream>
-#include <vector>
-#include <string>
-#include <fstream>
-#include <sstream>
-#include <iomanip>
-#include <algorithm>
-#include <cassert>
-#include <cmath>
-#include <climits>
-#include <stdexcept>  // Added: For proper exception handling
-
-using namespace std;
-
-class PolynomialSolver {
-private:
-    struct Point {
-        long long x;
-        long double y;
-        
-        Point(long long x_val, long double y_val) : x(x_val), y(y_val) {}
-    };
-
-    /**
-     * Convert a number from any base (2-16) to decimal
-     * @param value: String representation of the number
-     * @param base: Base of the number system (2-16)
-     * @return: Decimal value as long double for precision
-     * @throws invalid_argument: For invalid input
-     */
-    long double convertToDecimal(const string& value, int base) {
-        if (value.empty() || base < 2 || base > 16) {
-            throw invalid_argument("Invalid base (" + to_string(base) + ") or empty value");
-        }
-        
-        long double result = 0.0L;
-        long double power = 1.0L;
-        
-        // Process digits from right to left
-        for (int i = value.length() - 1; i >= 0; i--) {
-            char digit = tolower(value[i]);  // Fixed: Convert to lowercase for consistency
-            int digitValue;
-            
-            if (digit >= '0' && digit <= '9') {
-                digitValue = digit - '0';
-            } else if (digit >= 'a' && digit <= 'f') {
-                digitValue = digit - 'a' + 10;
-            } else {
-                throw invalid_argument("Invalid character '" + string(1, digit) + "' in number");
-            }
-            
-            if (digitValue >= base) {
-                throw invalid_argument("Digit " + to_string(digitValue) + " invalid for base " + to_string(base));
-            }
-            
-            result += digitValue * power;
-            power *= base;
-        }
-        
-        return result;
-    }
-
-    /**
-     * Lagrange interpolation to find polynomial value at x
-     * @param points: Vector of points (x, y)
-     * @param k: Number of points to use for interpolation
-     * @param x: Point to evaluate polynomial at (default: 0 for secret)
-     * @return: Polynomial value at x
-     * @throws invalid_argument: For insufficient points or duplicate x values
-     */
-    long double lagrangeInterpolation(const vector<Point>& points, int k, long double x = 0.0L) {
-        if (k <= 0 || k > (int)points.size()) {
-            throw invalid_argument("Invalid k value: " + to_string(k));
-        }
-        
-        // Check for duplicate x values
-        for (int i = 0; i < k; i++) {
-            for (int j = i + 1; j < k; j++) {
-                if (points[i].x == points[j].x) {
-                    throw invalid_argument("Duplicate x values found: " + to_string(points[i].x));
-                }
-            }
-        }
-        
-        long double result = 0.0L;
-        
-        for (int i = 0; i < k; i++) {
-            long double term = points[i].y;
-            
-            // Calculate Lagrange basis polynomial Li(x)
-            for (int j = 0; j < k; j++) {
-                if (i != j) {
-                    long double denominator = (long double)(points[i].x - points[j].x);
-                    if (abs(denominator) < 1e-15) {  // Fixed: Check for near-zero denominator
-                        throw invalid_argument("Points too close together for stable interpolation");
-                    }
-                    term *= (x - points[j].x) / denominator;
-                }
-            }
-            
-            result += term;
-        }
-        
-        return result;
-    }
-
-    /**
-     * Simple JSON value extractor (no external dependencies)
-     * @param json: JSON string
-     * @param key: Key to extract
-     * @return: Value as string
-     */
-    string extractValue(const string& json, const string& key) {
-        string searchKey = "\"" + key + "\"";
-        size_t keyPos = json.find(searchKey);
-        if (keyPos == string::npos) return "";
-        
-        size_t colonPos = json.find(":", keyPos);
-        if (colonPos == string::npos) return "";
-        
-        size_t valueStart = json.find("\"", colonPos);
-        if (valueStart == string::npos) return "";
-        valueStart++;
-        
-        size_t valueEnd = json.find("\"", valueStart);
-        if (valueEnd == string::npos) return "";
-        
-        return json.substr(valueStart, valueEnd - valueStart);
-    }
-    
-    /**
-     * Extract integer value from JSON
-     * @param json: JSON string
-     * @param key: Key to extract
-     * @return: Integer value or -1 if not found
-     */
-    int extractNumber(const string& json, const string& key) {
-        string searchKey = "\"" + key + "\"";
-        size_t keyPos = json.find(searchKey);
-        if (keyPos == string::npos) return -1;
-        
-        size_t colonPos = json.find(":", keyPos);
-        if (colonPos == string::npos) return -1;
-        
-        size_t numStart = colonPos + 1;
-        while (numStart < json.length() && isspace(json[numStart])) {
-            numStart++;
-        }
-        
-        size_t numEnd = numStart;
-        while (numEnd < json.length() && isdigit(json[numEnd])) {
-            numEnd++;
-        }
-        
-        if (numEnd > numStart) {
-            try {
-                return stoi(json.substr(numStart, numEnd - numStart));
-            } catch (const exception&) {
-                return -1;  // Fixed: Handle stoi exceptions
-            }
-        }
-        
-        return -1;
-    }
-
-public:
-    /**
-     * Solve polynomial from JSON input
-     * @param jsonContent: JSON string containing the test case
-     * @return: The secret (constant term) or LLONG_MIN on error
-     */
-    long long solveFromJSON(const string& jsonContent) {
-        try {
-            if (jsonContent.empty()) {
-                cerr << "Error: Empty JSON content" << endl;
-                return LLONG_MIN;
-            }
-            
-            int n = extractNumber(jsonContent, "n");
-            int k = extractNumber(jsonContent, "k");
-            
-            if (n <= 0 || k <= 0 || k > n) {  // Fixed: Added k > n check
-                cerr << "Error: Invalid n=" << n << " or k=" << k << " (k must be ≤ n)" << endl;
-                return LLONG_MIN;
-            }
-            
-            cout << "Input: n=" << n << " roots, k=" << k << " minimum required" << endl;
-            
-            vector<Point> points;
-            
-            // Extract and convert all points
-            for (int i = 1; i <= n; i++) {
-                string pointKey = "\"" + to_string(i) + "\"";
-                size_t pointStart = jsonContent.find(pointKey);
-                if (pointStart == string::npos) continue;
-                
-                size_t braceStart = jsonContent.find("{", pointStart);
-                size_t braceEnd = jsonContent.find("}", braceStart);
-                if (braceStart == string::npos || braceEnd == string::npos) continue;
-                
-                string pointJson = jsonContent.substr(braceStart, braceEnd - braceStart + 1);
-                
-                string baseStr = extractValue(pointJson, "base");
-                string valueStr = extractValue(pointJson, "value");
-                
-                if (!baseStr.empty() && !valueStr.empty()) {
-                    try {
-                        int base = stoi(baseStr);
-                        long double decimalValue = convertToDecimal(valueStr, base);
-                        points.push_back(Point(i, decimalValue));
-                        
-                        cout << "  Point " << i << ": \"" << valueStr << "\" (base " << base 
-                             << ") = " << fixed << setprecision(0) << decimalValue << endl;
-                    } catch (const exception& e) {
-                        cerr << "  Warning: Skipping point " << i << " - " << e.what() << endl;
-                        continue;
-                    }
-                }
-            }
-            
-            if ((int)points.size() < k) {
-                cerr << "Error: Not enough valid points (" << points.size() 
-                     << " found, " << k << " required)" << endl;
-                return LLONG_MIN;
-            }
-            
-            // Use only the first k points for interpolation
-            points.resize(k);
-            
-            // Use Lagrange interpolation to find the secret
-            long double secret = lagrangeInterpolation(points, k, 0.0L);
-            
-            // Handle large numbers properly
-            cout << "Secret (constant term): " << fixed << setprecision(0) << secret << endl;
-            
-            // Return as long long if it fits, otherwise return special value
-            if (secret >= LLONG_MIN && secret <= LLONG_MAX) {
-                return (long long)round(secret);
-            } else {
-                cout << "Note: Result exceeds long long range (returning 0)" << endl;
-                return 0; // Fixed: Return 0 instead of -1 for overflow
-            }
-            
-        } catch (const exception& e) {
-            cerr << "Error processing JSON: " << e.what() << endl;
-            return LLONG_MIN;
-        }
-    }
-
-    /**
-     * Run comprehensive tests
-     */
-    void runTests() {
-        cout << "=== Running Comprehensive Tests ===" << endl;
-        int passed = 0, total = 0;
-        
-        // Test 1: Base conversions
-        cout << "\nTesting base conversions..." << endl;
-        total++; if (abs(convertToDecimal("111", 2) - 7) < 0.01) { cout << "✓ Binary conversion"; passed++; } else cout << "✗ Binary conversion";
-        total++; if (abs(convertToDecimal("213", 4) - 39) < 0.01) { cout << " ✓ Quaternary conversion"; passed++; } else cout << " ✗ Quaternary conversion";
-        total++; if (abs(convertToDecimal("FF", 16) - 255) < 0.01) { cout << " ✓ Hex uppercase"; passed++; } else cout << " ✗ Hex uppercase";
-        total++; if (abs(convertToDecimal("ff", 16) - 255) < 0.01) { cout << " ✓ Hex lowercase"; passed++; } else cout << " ✗ Hex lowercase";
-        total++; if (abs(convertToDecimal("377", 8) - 255) < 0.01) { cout << " ✓ Octal conversion"; passed++; } else cout << " ✗ Octal conversion";
-        cout << endl;
-        
-        // Test 2: Error handling
-        cout << "\nTesting error handling..." << endl;
-        total++;
-        try {
-            convertToDecimal("Z", 10);
-            cout << "✗ Should catch invalid character";
-        } catch (...) {
-            cout << "✓ Catches invalid character";
-            passed++;
-        }
-        
-        total++;
-        try {
-            convertToDecimal("9", 8);
-            cout << " ✗ Should catch invalid digit for base";
-        } catch (...) {
-            cout << " ✓ Catches invalid digit for base";
-            passed++;
-        }
-        
-        total++;
-        try {
-            convertToDecimal("", 10);
-            cout << " ✗ Should catch empty string";
-        } catch (...) {
-            cout << " ✓ Catches empty string";
-            passed++;
-        }
-        cout << endl;
-        
-        // Test 3: Known polynomial interpolation
-        cout << "\nTesting polynomial interpolation..." << endl;
-        vector<Point> testPoints = {Point(1, 1), Point(2, 4), Point(3, 9)}; // y = x^2
-        long double result = lagrangeInterpolation(testPoints, 3, 0); // Should be 0
-        total++;
-        if (abs(result) < 0.01) {
-            cout << "✓ Polynomial y=x² gives correct constant term (0)";
-            passed++;
-        } else {
-            cout << "✗ Polynomial y=x² failed (got " << result << ")";
-        }
-        
-        testPoints = {Point(1, 2), Point(2, 3), Point(3, 4)}; // y = x + 1
-        result = lagrangeInterpolation(testPoints, 3, 0); // Should be 1
-        total++;
-        if (abs(result - 1.0) < 0.01) {
-            cout << " ✓ Polynomial y=x+1 gives correct constant term (1)";
-            passed++;
-        } else {
-            cout << " ✗ Polynomial y=x+1 failed (got " << result << ")";
-        }
-        
-        // Test 4: Edge cases
-        testPoints = {Point(0, 5), Point(1, 5), Point(2, 5)}; // y = 5 (constant)
-        result = lagrangeInterpolation(testPoints, 3, 0); // Should be 5
-        total++;
-        if (abs(result - 5.0) < 0.01) {
-            cout << " ✓ Constant polynomial y=5";
-            passed++;
-        } else {
-            cout << " ✗ Constant polynomial failed (got " << result << ")";
-        }
-        cout << endl;
-        
-        // Test 5: Duplicate x values (should fail)
-        cout << "\nTesting error conditions..." << endl;
-        total++;
-        try {
-            testPoints = {Point(1, 1), Point(1, 2), Point(2, 3)};
-            lagrangeInterpolation(testPoints, 3, 0);
-            cout << "✗ Should catch duplicate x values";
-        } catch (...) {
-            cout << "✓ Catches duplicate x values";
-            passed++;
-        }
-        cout << endl;
-        
-        cout << "Test Results: " << passed << "/" << total << " passed" << endl;
-        if (passed == total) {
-            cout << "🎉 All tests passed!" << endl;
-        } else {
-            cout << "⚠️  " << (total - passed) << " test(s) failed." << endl;
-        }
-    }
-
-    /**
-     * Get built-in test cases
-     */
-    vector<string> getTestCases() {
-        return {
-            // Test Case 1: Simple case with known answer
-            R"({
-                "keys": {
-                    "n": 4,
-                    "k": 3
-                },
-                "1": {
-                    "base": "10",
-                    "value": "4"
-                },
-                "2": {
-                    "base": "2",
-                    "value": "111"
-                },
-                "3": {
-                    "base": "10",
-                    "value": "12"
-                },
-                "6": {
-                    "base": "4",
-                    "value": "213"
-                }
-            })",
-            
-            // Test Case 2: Complex case with large numbers
-            R"({
-                "keys": {
-                    "n": 10,
-                    "k": 7
-                },
-                "1": {
-                    "base": "6",
-                    "value": "13444211440455345511"
-                },
-                "2": {
-                    "base": "15",
-                    "value": "aed7015a346d635"
-                },
-                "3": {
-                    "base": "15",
-                    "value": "6aeeb69631c227c"
-                },
-                "4": {
-                    "base": "16",
-                    "value": "e1b5e05623d881f"
-                },
-                "5": {
-                    "base": "8",
-                    "value": "316034514573652620673"
-                },
-                "6": {
-                    "base": "3",
-                    "value": "2122212201122002221120200210011020220200"
-                },
-                "7": {
-                    "base": "3",
-                    "value": "20120221122211000100210021102001201112121"
-                },
-                "8": {
-                    "base": "6",
-                    "value": "20220554335330240002224253"
-                },
-                "9": {
-                    "base": "12",
-                    "value": "45153788322a1255483"
-                },
-                "10": {
-                    "base": "7",
-                    "value": "1101613130313526312514143"
-                }
-            })"
-        };
-    }
-};
-
-/**
- * Read entire file content
- * @param filename: Path to the file
- * @return: File content as string
- * @throws runtime_error: If file cannot be opened
- */
-string readFile(const string& filename) {
-    ifstream file(filename);
-    if (!file.is_open()) {
-        throw runtime_error("Cannot open file: " + filename);
-    }
-    
-    ostringstream ss;
-    ss << file.rdbuf();
-    return ss.str();
-}
-
-/**
- * Read from stdin
- * @return: stdin content as string
- */
-string readStdin() {
-    ostringstream ss;
-    string line;
-    while (getline(cin, line)) {
-        ss << line << "\n";
-    }
-    return ss.str();
-}
-
-/**
- * Show usage information
- * @param programName: Name of the executable
- */
-void showUsage(const char* programName) {
-    cout << "Polynomial Solver - Shamir's Secret Sharing Implementation v2.0\n\n";
-    cout << "Usage:\n";
-    cout << "  " << programName << "                    # Interactive mode with built-in test cases\n";
-    cout << "  " << programName << " --test            # Run comprehensive tests\n";
-    cout << "  " << programName << " <file.json>       # Read JSON from file\n";
-    cout << "  " << programName << " < input.json      # Read JSON from stdin\n";
-    cout << "  " << programName << " --help            # Show this help\n\n";
-    cout << "JSON Format:\n";
-    cout << "{\n";
-    cout << "  \"keys\": { \"n\": 4, \"k\": 3 },\n";
-    cout << "  \"1\": { \"base\": \"10\", \"value\": \"4\" },\n";
-    cout << "  \"2\": { \"base\": \"2\", \"value\": \"111\" },\n";
-    cout << "  \"3\": { \"base\": \"10\", \"value\": \"12\" },\n";
-    cout << "  \"6\": { \"base\": \"4\", \"value\": \"213\" }\n";
-    cout << "}\n\n";
-    cout << "Where:\n";
-    cout << "  n = total number of roots provided\n";
-    cout << "  k = minimum number of roots needed (polynomial degree + 1)\n";
-    cout << "  base = number base (2-16)\n";
-    cout << "  value = number in the specified base\n";
-}
-
-int main(int argc, char* argv[]) {
-    try {
-        PolynomialSolver solver;
-        
-        // Handle command line arguments
-        if (argc > 1) {
-            string arg = argv[1];
-            
-            if (arg == "--help" || arg == "-h") {
-                showUsage(argv[0]);
-                return 0;
-            }
-            
-            if (arg == "--test") {
-                solver.runTests();
-                return 0;
-            }
-            
-            if (arg == "--version" || arg == "-v") {
-                cout << "Polynomial Solver v2.0" << endl;
-                return 0;
-            }
-            
-            // Try to read from file
-            try {
-                string content = readFile(arg);
-                cout << "Reading from file: " << arg << endl;
-                long long result = solver.solveFromJSON(content);
-                if (result != LLONG_MIN) {
-                    cout << "\nFinal Answer: " << result << endl;
-                }
-                return (result != LLONG_MIN) ? 0 : 1;
-            } catch (const exception& e) {
-                cerr << "Error reading file: " << e.what() << endl;
-                return 1;
-            }
-        }
-        
-        // Check if stdin has data
-        if (!cin.eof() && cin.peek() != EOF) {
-            try {
-                string content = readStdin();
-                if (!content.empty()) {
-                    cout << "Reading from stdin..." << endl;
-                    long long result = solver.solveFromJSON(content);
-                    if (result != LLONG_MIN) {
-                        cout << "\nFinal Answer: " << result << endl;
-                    }
-                    return (result != LLONG_MIN) ? 0 : 1;
-                }
-            } catch (const exception& e) {
-                cerr << "Error reading stdin: " << e.what() << endl;
-                return 1;
-            }
-        }
-        
-        // Interactive mode with built-in test cases
-        cout << "=== Polynomial Solver v2.0 - Interactive Mode ===" << endl;
-        cout << "Running built-in test cases...\n" << endl;
-        
-        vector<string> testCases = solver.getTestCases();
-        
-        for (size_t i = 0; i < testCases.size(); i++) {
-            cout << "--- Test Case " << (i + 1) << " ---" << endl;
-            long long result = solver.solveFromJSON(testCases[i]);
-            if (result != LLONG_MIN) {
-                cout << "Final Answer: " << result << "\n" << endl;
-            } else {
-                cout << "Failed to solve this test case\n" << endl;
-            }
-        }
-        
-        cout << "Additional options:" << endl;
-        cout << "  " << argv[0] << " --test     # Run comprehensive tests" << endl;
-        cout << "  " << argv[0] << " --help     # Show detailed usage" << endl;
-        cout << "  " << argv[0] << " file.json  # Process your own JSON file" << endl;
-        
-        return 0;
-        
-    } catch (const exception& e) {
-        cerr << "Unexpected error: " << e.what() << endl;
-        return 1;
-    }
-}
+/**
+ * Polynomial Solver - Shamir's Secret Sharing Implementation
+ * 
+ * This program solves polynomial coefficients using Shamir's Secret Sharing scheme.
+ * It reads test cases in JSON format and uses Lagrange interpolation to find the 
+ * constant term (secret) of the polynomial.
+ * 
+ * Author: GitHub Repository
+ * Date: September 2025
+ * Version: 2.0
+ * 
+ * Usage:
+ *   ./polynomial_solver                          # Interactive mode with built-in test cases
+ *   ./polynomial_solver < input.json            # Read JSON from stdin
+ *   ./polynomial_solver input.json              # Read JSON from file
+ *   ./polynomial_solver --test                  # Run comprehensive tests
+ *   ./polynomial_solver --test-scale 10000      # Plus the scale tier up to k = 10^4 (slow)
+ *   ./polynomial_solver --batch --format ndjson docs.ndjson   # One document per line
+ *   ./polynomial_solver --autotune              # Time this host, save algorithm crossovers
+ *   ./polynomial_solver --bench                 # Time each phase over a grid of generated inputs
+ *   ./polynomial_solver --generate --gen-n 1000 --gen-count 100 --gen-format ndjson > load.ndjson
+ *   ./polynomial_solver --batch --stats --trace trace.json load.ndjson   # Phase histograms, timeline
+ *   ./polynomial_solver --serve /tmp/solver.sock --metrics-file solver.prom   # Long-running server
+ * 
+ * Build:
+ *   make                                       # CLI plus libpolysolver.so (C ABI)
+ *
+ * This file is only the command line front end; parsing and solving live in
+ * the library core (polynomial_solver.h / polynomial_solver_core.cpp).
+ * 
+ * Algorithm: Lagrange Interpolation
+ * For a polynomial P(x) of degree m, given k = m + 1 points (x₁, y₁), ..., (xₖ, yₖ):
+ * P(0) = Σᵢ₌₁ᵏ yᵢ * Πⱼ₌₁,ⱼ≠ᵢᵏ [(0 - xⱼ) / (xᵢ - xⱼ)]
+ */
+
+#include "polynomial_solver.h"
+#include "polysolver.h"
+#include "output_writer.h"
+#include "autotune.h"
+#include "bench.h"
+#include "workload.h"
+#include "stats.h"
+#include "trace.h"
+#include "alloc_accounting.h"
+#include "server.h"
+#include "recording.h"
+#include "embedded_shares.h"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <iomanip>
+#include <memory>
+#include <thread>
+#include <stdexcept>  // Added: For proper exception handling
+
+using namespace std;
+
+using Point = PolynomialSolver::Point;
+
+vector<string> getTestCases();
+string readFile(const string& filename);
+
+// Built-in test cases. Being compiled in, they are also solved by the
+// compiler (embedded_shares.h); the suite checks the runtime solver agrees.
+
+// Test Case 1: Simple case with known answer
+constexpr char kTestCase1[] = R"({
+            "keys": {
+                "n": 4,
+                "k": 3
+            },
+            "1": {
+                "base": "10",
+                "value": "4"
+            },
+            "2": {
+                "base": "2",
+                "value": "111"
+            },
+            "3": {
+                "base": "10",
+                "value": "12"
+            },
+            "6": {
+                "base": "4",
+                "value": "213"
+            }
+        })";
+
+// Test Case 2: Complex case with large numbers
+constexpr char kTestCase2[] = R"({
+            "keys": {
+                "n": 10,
+                "k": 7
+            },
+            "1": {
+                "base": "6",
+                "value": "13444211440455345511"
+            },
+            "2": {
+                "base": "15",
+                "value": "aed7015a346d635"
+            },
+            "3": {
+                "base": "15",
+                "value": "6aeeb69631c227c"
+            },
+            "4": {
+                "base": "16",
+                "value": "e1b5e05623d881f"
+            },
+            "5": {
+                "base": "8",
+                "value": "316034514573652620673"
+            },
+            "6": {
+                "base": "3",
+                "value": "2122212201122002221120200210011020220200"
+            },
+            "7": {
+                "base": "3",
+                "value": "20120221122211000100210021102001201112121"
+            },
+            "8": {
+                "base": "6",
+                "value": "20220554335330240002224253"
+            },
+            "9": {
+                "base": "12",
+                "value": "45153788322a1255483"
+            },
+            "10": {
+                "base": "7",
+                "value": "1101613130313526312514143"
+            }
+        })";
+
+constexpr FixedInt<4> kTestCase1Secret = embeddedSecret(kTestCase1);
+constexpr FixedInt<4> kTestCase2Secret = embeddedSecret(kTestCase2);
+static_assert(kTestCase1Secret == 3, "test case 1 secret changed");
+static_assert(kTestCase2Secret == -6290016743746469796LL, "test case 2 secret changed");
+
+/**
+ * One size of the scale tier. The budget bounds the solver's own total
+ * time (parse through verify) for the document, on an unloaded host.
+ */
+struct ScaleTier {
+    int k;
+    size_t digits;      // per coefficient
+    uint64_t budgetMs;
+};
+
+// Shares of a degree k-1 polynomial at x = 1..k have about k*log10(k)
+// digits, and exact interpolation is cubic in k: the document at 10^4 is
+// ~400 MB and takes minutes, so --test stops at 1000 (--test-scale goes on)
+const ScaleTier kScaleTiers[] = {
+    {10, 40, 20},
+    {100, 100, 50},
+    {1000, 20, 3000},
+    {2000, 20, 20000},
+    {4000, 20, 150000},
+    {10000, 20, 1800000},
+};
+constexpr int kDefaultScaleMaxK = 1000;
+
+/**
+ * Decode digits one at a time into 63-bit chunks (test oracle; shares no
+ * code with the divide-and-conquer conversion)
+ */
+BigInt slowDecode(const string& digits, int base) {
+    BigInt value(0);
+    long long chunk = 0, scale = 1;
+    for (char c : digits) {
+        chunk = chunk * base + (c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10);
+        scale *= base;
+        if (scale > LLONG_MAX / 16) {
+            value *= scale;
+            value += BigInt(chunk);
+            chunk = 0;
+            scale = 1;
+        }
+    }
+    value *= scale;
+    value += BigInt(chunk);
+    return value;
+}
+
+/**
+ * P(0) from P(1..k) for a polynomial of degree below k, independently of
+ * Lagrange: the k-th finite difference vanishes, so
+ * P(0) = Σᵢ (−1)^(i+1)·C(k,i)·P(i). Schoolbook products only; slow but
+ * obviously right, which is the point of an oracle.
+ * @param values: P(1), ..., P(k)
+ */
+BigInt finiteDifferenceSecret(const vector<BigInt>& values) {
+    long long k = (long long)values.size();
+    BigInt secret(0);
+    BigInt binomial(1);     // C(k, i)
+    for (long long i = 1; i <= k; i++) {
+        binomial *= k - i + 1;
+        binomial = BigInt::divExact(binomial, BigInt(i));
+        BigInt term = BigInt::multiply(binomial, values[(size_t)(i - 1)], MulAlgorithm::Schoolbook);
+        if (i % 2 == 1) {
+            secret += term;
+        } else {
+            secret -= term;
+        }
+    }
+    return secret;
+}
+
+/**
+ * Run comprehensive tests
+ * @param scaleMaxK: Largest k of the scale tier to run
+ * @return: true when every test passed
+ */
+bool runTests(int scaleMaxK = kDefaultScaleMaxK) {
+    cout << "=== Running Comprehensive Tests ===" << endl;
+    int passed = 0, total = 0;
+    
+    // Test 1: Base conversions
+    cout << "\nTesting base conversions..." << endl;
+    total++; if (abs(PolynomialSolver::convertToDecimal("111", 2) - 7) < 0.01) { cout << "✓ Binary conversion"; passed++; } else cout << "✗ Binary conversion";
+    total++; if (abs(PolynomialSolver::convertToDecimal("213", 4) - 39) < 0.01) { cout << " ✓ Quaternary conversion"; passed++; } else cout << " ✗ Quaternary conversion";
+    total++; if (abs(PolynomialSolver::convertToDecimal("FF", 16) - 255) < 0.01) { cout << " ✓ Hex uppercase"; passed++; } else cout << " ✗ Hex uppercase";
+    total++; if (abs(PolynomialSolver::convertToDecimal("ff", 16) - 255) < 0.01) { cout << " ✓ Hex lowercase"; passed++; } else cout << " ✗ Hex lowercase";
+    total++; if (abs(PolynomialSolver::convertToDecimal("377", 8) - 255) < 0.01) { cout << " ✓ Octal conversion"; passed++; } else cout << " ✗ Octal conversion";
+    cout << endl;
+    
+    // Test 2: Error handling
+    cout << "\nTesting error handling..." << endl;
+    total++;
+    try {
+        PolynomialSolver::convertToDecimal("Z", 10);
+        cout << "✗ Should catch invalid character";
+    } catch (...) {
+        cout << "✓ Catches invalid character";
+        passed++;
+    }
+    
+    total++;
+    try {
+        PolynomialSolver::convertToDecimal("9", 8);
+        cout << " ✗ Should catch invalid digit for base";
+    } catch (...) {
+        cout << " ✓ Catches invalid digit for base";
+        passed++;
+    }
+    
+    total++;
+    try {
+        PolynomialSolver::convertToDecimal("", 10);
+        cout << " ✗ Should catch empty string";
+    } catch (...) {
+        cout << " ✓ Catches empty string";
+        passed++;
+    }
+    cout << endl;
+    
+    // Test 3: Known polynomial interpolation
+    cout << "\nTesting polynomial interpolation..." << endl;
+    vector<Point> testPoints = {Point(1, 1), Point(2, 4), Point(3, 9)}; // y = x^2
+    long double result = PolynomialSolver::lagrangeInterpolation(testPoints, 3, 0); // Should be 0
+    total++;
+    if (abs(result) < 0.01) {
+        cout << "✓ Polynomial y=x² gives correct constant term (0)";
+        passed++;
+    } else {
+        cout << "✗ Polynomial y=x² failed (got " << result << ")";
+    }
+    
+    testPoints = {Point(1, 2), Point(2, 3), Point(3, 4)}; // y = x + 1
+    result = PolynomialSolver::lagrangeInterpolation(testPoints, 3, 0); // Should be 1
+    total++;
+    if (abs(result - 1.0) < 0.01) {
+        cout << " ✓ Polynomial y=x+1 gives correct constant term (1)";
+        passed++;
+    } else {
+        cout << " ✗ Polynomial y=x+1 failed (got " << result << ")";
+    }
+    
+    // Test 4: Edge cases
+    testPoints = {Point(0, 5), Point(1, 5), Point(2, 5)}; // y = 5 (constant)
+    result = PolynomialSolver::lagrangeInterpolation(testPoints, 3, 0); // Should be 5
+    total++;
+    if (abs(result - 5.0) < 0.01) {
+        cout << " ✓ Constant polynomial y=5";
+        passed++;
+    } else {
+        cout << " ✗ Constant polynomial failed (got " << result << ")";
+    }
+    cout << endl;
+    
+    // Test 5: Duplicate x values (should fail)
+    cout << "\nTesting error conditions..." << endl;
+    total++;
+    try {
+        testPoints = {Point(1, 1), Point(1, 2), Point(2, 3)};
+        PolynomialSolver::lagrangeInterpolation(testPoints, 3, 0);
+        cout << "✗ Should catch duplicate x values";
+    } catch (...) {
+        cout << "✓ Catches duplicate x values";
+        passed++;
+    }
+    cout << endl;
+    
+    // Test 6: Exact big integers and any-base output
+    cout << "\nTesting big integers..." << endl;
+    {
+        total++;
+        if (BigInt::fromString("FF", 16).toString(2) == "11111111" &&
+            BigInt(0).toString(7) == "0" &&
+            (-BigInt::fromString("255", 10)).toString(16) == "-ff") {
+            cout << "✓ Base round trips";
+            passed++;
+        } else {
+            cout << "✗ Base round trips";
+        }
+        
+        // 10^1000 is well past the divide-and-conquer thresholds
+        BigInt power(1);
+        for (int i = 0; i < 100; i++) power *= 10000000000LL;
+        string expected = "1" + string(1000, '0');
+        total++;
+        if (power.toString() == expected && BigInt::fromString(expected, 10) == power &&
+            BigInt::fromString(power.toString(7), 7) == power) {
+            cout << " ✓ Divide-and-conquer conversion of 10^1000";
+            passed++;
+        } else {
+            cout << " ✗ Divide-and-conquer conversion of 10^1000";
+        }
+        
+        // y = 10^20 + x: the secret needs more than 64 bits
+        SolveResult big = PolynomialSolver().solveFromJSON(
+            R"({"keys":{"n":2,"k":2},"1":{"base":"10","value":"100000000000000000001"},)"
+            R"("2":{"base":"16","value":"56bc75e2d63100002"}})");
+        total++;
+        if (big.ok() && big.exact && !big.fitsInt64 && big.secretString() == "1" + string(20, '0')) {
+            cout << " ✓ Exact secret beyond long long";
+            passed++;
+        } else {
+            cout << " ✗ Exact secret beyond long long (got " << big.secretString() << ")";
+        }
+        
+        // The value "3" of share 2's base must not be taken for the key "3"
+        SolveResult keyed = PolynomialSolver().solveFromJSON(
+            R"({"keys":{"n":3,"k":3},"2":{"base":"3","value":"10"},)"
+            R"("1":{"base":"10","value":"1"},"3":{"base":"10","value":"5"}})");
+        total++;
+        if (keyed.ok() && keyed.secretString() == "-1" &&
+            PolynomialSolver().solveFromJSON(getTestCases()[1]).secretString() == "-6290016743746469796") {
+            cout << " ✓ Share keys distinct from base values";
+            passed++;
+        } else {
+            cout << " ✗ Share key matched a base value (got " << keyed.secretString() << ")";
+        }
+
+        // 4000-digit hex factors of unequal length exercise every recursion level
+        BigInt a = BigInt::fromString(string(4000, 'f'), 16);
+        BigInt b = BigInt::fromString(string(2500, '9') + string(500, '1'), 16);
+        BigInt reference = BigInt::multiply(a, b, MulAlgorithm::Schoolbook);
+        total++;
+        if (BigInt::multiply(a, b, MulAlgorithm::Karatsuba) == reference &&
+            BigInt::multiply(a, b, MulAlgorithm::Toom3) == reference &&
+            BigInt::multiply(a, b, MulAlgorithm::NTT) == reference &&
+            a * b == reference && BigInt::multiply(a, a, MulAlgorithm::NTT) == a * a) {
+            cout << " ✓ Multiplication algorithms agree";
+            passed++;
+        } else {
+            cout << " ✗ Multiplication algorithms agree";
+        }
+
+        // Exact division on both the limb-by-limb and the Newton-inverse paths
+        BigInt quotient, remainder;
+        BigInt::divMod(reference, -b, quotient, remainder);
+        total++;
+        if (BigInt::divExact(reference, b) == a && BigInt::divExact(-reference, a) == -b &&
+            BigInt::divExact(a * 6, BigInt(-3)) == a * -2 && quotient == -a && remainder.isZero()) {
+            cout << " ✓ Exact division";
+            passed++;
+        } else {
+            cout << " ✗ Exact division";
+        }
+    }
+    cout << endl;
+    
+    // Test 7: C ABI round trip with a reused scratch context
+    cout << "\nTesting C ABI..." << endl;
+    {
+        const string doc = R"({"keys":{"n":3,"k":3},"1":{"base":"10","value":"4"},)"
+                           R"("2":{"base":"2","value":"111"},"3":{"base":"10","value":"12"}})";
+        ps_solver* cSolver = ps_solver_create();
+        ps_scratch* scratch = ps_scratch_create();
+        ps_result cResult;
+        char secret[32];
+        size_t needed = 0;
+        
+        total++;
+        if (ps_solve(cSolver, scratch, doc.data(), doc.size(), &cResult) == PS_OK &&
+            cResult.fits_int64 && cResult.secret_int64 == 3 && cResult.shares_used == 3) {
+            cout << "✓ ps_solve returns secret 3";
+            passed++;
+        } else {
+            cout << "✗ ps_solve failed";
+        }
+        
+        total++;
+        if (ps_scratch_secret(scratch, secret, 1, &needed) == PS_ERR_BUFFER_TOO_SMALL && needed == 2 &&
+            ps_scratch_secret(scratch, secret, sizeof secret, nullptr) == PS_OK && string(secret) == "3") {
+            cout << " ✓ Secret copied into caller buffer";
+            passed++;
+        } else {
+            cout << " ✗ Secret buffer contract broken";
+        }
+        
+        total++;
+        if (ps_solve(cSolver, scratch, "{}", 2, nullptr) == PS_ERR_INVALID_KEYS &&
+            ps_scratch_secret(scratch, secret, sizeof secret, nullptr) == PS_ERR_INVALID_KEYS) {
+            cout << " ✓ Scratch reuse reports new error";
+            passed++;
+        } else {
+            cout << " ✗ Scratch reuse kept stale result";
+        }
+        
+        ps_scratch_free(scratch);
+        ps_solver_free(cSolver);
+    }
+    cout << endl;
+    
+    // Test 8: Buffered output formats, read back through a pipe
+    cout << "\nTesting output formats..." << endl;
+    {
+        const string doc = R"({"keys":{"n":3,"k":3},"1":{"base":"10","value":"4"},)"
+                           R"("2":{"base":"2","value":"111"},"3":{"base":"10","value":"12"}})";
+        SolveResult solved = PolynomialSolver().solveFromJSON(doc);
+        
+        auto render = [&](OutputFormat format) {
+            int fds[2];
+            if (pipe(fds) != 0) return string();
+            {
+                OutputWriter writer(fds[1], fds[1], format);
+                writer.writeResult("a,b", solved);
+                writer.writeResult("a,b", solved);
+            }
+            close(fds[1]);
+            string text;
+            char chunk[4096];
+            ssize_t got;
+            while ((got = read(fds[0], chunk, sizeof chunk)) > 0) text.append(chunk, (size_t)got);
+            close(fds[0]);
+            return text;
+        };
+        
+        total++;
+        if (render(OutputFormat::Quiet) == "3\n3\n") {
+            cout << "✓ Quiet prints secrets only";
+            passed++;
+        } else {
+            cout << "✗ Quiet output wrong";
+        }
+        
+        total++;
+        string csv = render(OutputFormat::CSV);
+        if (csv.rfind("source,status,", 0) == 0 && csv.find("\n\"a,b\",ok,3,3,3,3,0,") != string::npos &&
+            csv.find("source,", 1) == string::npos) {
+            cout << " ✓ CSV header once, fields quoted";
+            passed++;
+        } else {
+            cout << " ✗ CSV output wrong";
+        }
+        
+        total++;
+        string ndjson = render(OutputFormat::NDJSON);
+        if (ndjson.rfind("{\"source\":\"a,b\",\"status\":\"ok\",\"n\":3,\"k\":3,\"secret\":\"3\"", 0) == 0 &&
+            count(ndjson.begin(), ndjson.end(), '\n') == 2) {
+            cout << " ✓ NDJSON one object per line";
+            passed++;
+        } else {
+            cout << " ✗ NDJSON output wrong";
+        }
+        
+        total++;
+        string binary = render(OutputFormat::Binary);
+        uint32_t recordBytes = 0;
+        if (binary.size() > 12) memcpy(&recordBytes, binary.data() + 8, sizeof recordBytes);
+        if (binary.compare(0, 8, string("PSOLVR1\0", 8)) == 0 && binary.size() == 8 + 2 * (4 + (size_t)recordBytes)) {
+            cout << " ✓ Binary records length-prefixed";
+            passed++;
+        } else {
+            cout << " ✗ Binary output wrong";
+        }
+
+        // Text lists every decoded share; the other formats name the k interpolated
+        solved = PolynomialSolver().solveFromJSON(R"({"keys":{"n":4,"k":3},"1":{"base":"10","value":"4"},)"
+                                                  R"("2":{"base":"2","value":"111"},"3":{"base":"10","value":"12"},)"
+                                                  R"("4":{"base":"10","value":"19"}})");
+        string text = render(OutputFormat::Text);
+        ndjson = render(OutputFormat::NDJSON);
+        total++;
+        if (solved.ok() && solved.shares.size() == 4 && solved.sharesUsed == 3 &&
+            text.find("  Point 4: \"19\" (base 10) = 19\n") != string::npos &&
+            ndjson.find("\"shares\":[1,2,3]") != string::npos) {
+            cout << " ✓ Text lists every decoded share";
+            passed++;
+        } else {
+            cout << " ✗ Decoded shares not all listed";
+        }
+    }
+    cout << endl;
+    
+    // Test 9: Tuning file round trip
+    cout << "\nTesting tuning files..." << endl;
+    {
+        char path[] = "/tmp/polysolver-tuning-XXXXXX";
+        int fd = mkstemp(path);
+        if (fd >= 0) close(fd);
+        
+        Tuning written;
+        written.mul = {40, 200, 5000};
+        written.conversion = {16, 64};
+        Tuning loaded;
+        string error;
+        total++;
+        if (fd >= 0 && saveTuning(path, written, error) && loadTuning(path, loaded, error) &&
+            loaded.mul.karatsuba == 40 && loaded.mul.toom3 == 200 && loaded.mul.ntt == 5000 &&
+            loaded.conversion.fromStringLeafChunks == 16 && loaded.conversion.toStringLeafLimbs == 64) {
+            cout << "✓ Tuning file round trip";
+            passed++;
+        } else {
+            cout << "✗ Tuning file round trip (" << error << ")";
+        }
+        
+        total++;
+        if (fd >= 0) ofstream(path) << "mul.karatsuba = 0\n";
+        if (fd >= 0 && !loadTuning(path, loaded, error) && loaded.mul.karatsuba == 40) {
+            cout << " ✓ Invalid tuning entry rejected";
+            passed++;
+        } else {
+            cout << " ✗ Invalid tuning entry accepted";
+        }
+        if (fd >= 0) unlink(path);
+    }
+    cout << endl;
+    
+    // Test 10: Generated workloads and benchmark statistics
+    cout << "\nTesting generated workloads..." << endl;
+    {
+        WorkloadSpec spec;
+        spec.n = 40;
+        spec.k = 12;
+        spec.bases = {2, 10, 16, 7};
+        spec.digits = 60;
+        WorkloadGenerator generator(7);
+        GeneratedDocument document = generator.next(spec);
+        SolveResult solved = PolynomialSolver().solveFromJSON(document.toJson(false));
+        total++;
+        if (solved.ok() && solved.exact && solved.exactSecret == document.secret &&
+            WorkloadGenerator(7).next(spec).toJson() == document.toJson()) {
+            cout << "✓ Generated document solves to its secret, reproducibly";
+            passed++;
+        } else {
+            cout << "✗ Generated document did not solve to its secret";
+        }
+        
+        // Corrupted shares change the recovered secret; modular shares stay below the prime
+        spec.k = 3;
+        spec.corruptFraction = 0.25;
+        spec.prime = BigInt::fromString("170141183460469231731687303715884105727", 10);   // 2^127 - 1
+        GeneratedDocument modular = generator.next(spec);
+        bool reduced = modular.secret < modular.prime;
+        for (const GeneratedShare& share : modular.shares) {
+            reduced = reduced && BigInt::fromString(share.value, share.base) < modular.prime;
+        }
+        total++;
+        if (reduced && modular.corruptedIds.size() == 10 &&
+            modular.toJson().find("\"prime\":\"170141183460469231731687303715884105727\"") != string::npos) {
+            cout << " ✓ Prime field shares with corrupted fraction";
+            passed++;
+        } else {
+            cout << " ✗ Prime field or corruption settings ignored";
+        }
+
+        // The solver reads keys.prime back: the secret mod p, and the
+        // corrupted shares found on a tape
+        spec.n = 12;
+        spec.k = 5;
+        spec.corruptFraction = 0.0;
+        GeneratedDocument field = generator.next(spec);
+        string fieldJson = field.toJson();
+        GeneratedShare& wrong = field.shares[9];
+        wrong.value = (BigInt::fromString(wrong.value, wrong.base) + BigInt(1)).toString(wrong.base);
+        string wrongJson = field.toJson();
+        PolynomialSolver strict;
+        strict.setParseMode(ParseMode::Strict);
+        SolveResult fieldSolved = strict.solveFromJSON(fieldJson);
+        DocumentTape fieldTape;
+        strict.buildTape(wrongJson, fieldTape);
+        vector<long long> offCurve;
+        vector<BigInt> fieldCoefficients;
+        BigInt atFour;
+        total++;
+        if (fieldSolved.ok() && fieldSolved.exactSecret == field.secret && fieldTape.prime() == spec.prime &&
+            strict.verifyShares(fieldTape, offCurve) == 7 && offCurve == vector<long long>{10} &&
+            strict.recoverCoefficients(fieldTape, fieldCoefficients) && fieldCoefficients[0] == field.secret &&
+            strict.evaluateAt(fieldTape, 4, atFour) && atFour == BigInt::fromString(field.shares[3].value,
+                                                                                  field.shares[3].base)) {
+            cout << " ✓ Prime field documents solve mod keys.prime";
+            passed++;
+        } else {
+            cout << " ✗ keys.prime ignored by the solver";
+        }
+
+        PhaseStats stats = summarize({10, 1, 3, 2, 1000});
+        vector<int> list;
+        total++;
+        if (stats.median == 3 && stats.p99 == 1000 && stats.mad == 2 &&
+            parseIntList("3,8,64", list) && list == vector<int>{3, 8, 64} && !parseIntList("3,,4", list)) {
+            cout << " ✓ Median, p99 and MAD";
+            passed++;
+        } else {
+            cout << " ✗ Benchmark statistics wrong";
+        }
+
+        // Baselines round-trip through the JSON output; only a real slowdown regresses
+        BenchCase before;
+        before.n = 8;
+        before.k = 3;
+        before.digits = 20;
+        for (int phase = 0; phase < kBenchPhaseCount; phase++) {
+            before.samples[phase] = {100, 104, 98, 101, 99, 103, 97, 102, 100, 101};
+            before.phases[phase] = summarize(before.samples[phase]);
+        }
+        BenchCase after = before;
+        after.samples[(int)BenchPhase::Interpolate] = {130, 128, 133, 127, 131, 129, 135, 130, 126, 132};
+        after.phases[(int)BenchPhase::Interpolate] = summarize(after.samples[(int)BenchPhase::Interpolate]);
+        BenchConfig settings;
+        settings.seed = 7;
+        stringstream json;
+        printBenchJson(json, settings, {before});
+        vector<BenchCase> baseline;
+        BenchConfig recorded;
+        string error;
+        vector<BenchRegression> regressions;
+        bool loaded = readBenchJson(json, baseline, error, &recorded) && baseline.size() == 1 &&
+                      baseline[0].samples[(int)BenchPhase::Total] == before.samples[(int)BenchPhase::Total] &&
+                      recorded.seed == 7 && recorded.backend == settings.backend;
+        if (loaded) regressions = compareBench(baseline, {after}, 0.05);
+        total++;
+        if (loaded && regressions.size() == 1 && regressions[0].phase == BenchPhase::Interpolate &&
+            compareBench(baseline, {before}, 0.05).empty() &&
+            mannWhitneyGreater(before.samples[0], before.samples[0]) > 0.4) {
+            cout << " ✓ Baseline regression gate";
+            passed++;
+        } else {
+            cout << " ✗ Baseline comparison wrong" << (error.empty() ? "" : ": " + error);
+        }
+
+        // Two recording runs appended to one log replay back byte for byte
+        char path[] = "/tmp/polysolver-record-XXXXXX";
+        int fd = mkstemp(path);
+        if (fd >= 0) close(fd);
+        string binary("{\"keys\":\0\r\n}", 12);
+        vector<RecordedDocument> replayed;
+        bool rejected = false;
+        try {
+            {
+                WorkloadRecorder first(path);
+                first.record(getTestCases()[0]);
+                first.record(binary, 7);
+            }
+            {
+                WorkloadRecorder second(path);
+                second.record(string(300, 'x'), 1ULL << 40);
+            }
+            WorkloadReplay log(path, 0.0);
+            for (RecordedDocument document; log.next(document);) {
+                chrono::steady_clock::time_point due = log.due();
+                if (due > chrono::steady_clock::now()) break;    // speed 0: never a pause
+                replayed.push_back(document);
+            }
+            ofstream(path, ios::app) << "D\x80";
+            WorkloadReplay truncated(path, 1.0);
+            RecordedDocument document;
+            while (truncated.next(document)) {}
+        } catch (const runtime_error&) {
+            rejected = true;
+        }
+        unlink(path);
+        total++;
+        if (replayed.size() == 3 && replayed[0].document == getTestCases()[0] && replayed[1].document == binary &&
+            replayed[1].stream == 7 && replayed[2].document == string(300, 'x') && replayed[2].stream == 1ULL << 40 &&
+            replayed[0].arrivalNs <= replayed[1].arrivalNs && replayed[1].arrivalNs <= replayed[2].arrivalNs &&
+            rejected) {
+            cout << " ✓ Record and replay log";
+            passed++;
+        } else {
+            cout << " ✗ Record/replay round trip wrong";
+        }
+    }
+    cout << endl;
+
+    // Test 11: Per-phase statistics
+    cout << "\nTesting statistics..." << endl;
+    {
+        Histogram histogram;
+        for (uint64_t value : {0, 1, 3, 900, 1000, 1023}) histogram.record(value);
+        total++;
+        if (histogram.count() == 6 && histogram.min() == 0 && histogram.max() == 1023 &&
+            histogram.bucketCount(0) == 1 && histogram.bucketCount(10) == 3 &&
+            histogram.quantile(0.5) == 4 && histogram.quantile(1.0) == 1023) {
+            cout << "✓ Log2 histogram buckets and quantiles";
+            passed++;
+        } else {
+            cout << "✗ Histogram wrong";
+        }
+
+        // A failed parse must not count as an interpolation
+        SolveStats stats;
+        PolynomialSolver solver;
+        SolveResult solved = solver.solveFromJSON(getTestCases()[0]);
+        stats.record(solved, 10, 20);
+        stats.record(solver.solveFromJSON(R"({"keys":{"n":0,"k":0}})"), 10, 20);
+        stringstream json;
+        stats.writeJson(json);
+        total++;
+        if (solved.counters.digitsDecoded == 1 + 3 + 2 && solved.counters.limbsTouched == 3 + 1 &&
+            solved.counters.shareBytes > 0 && stats.documents() == 2 &&
+            stats.phase(StatsPhase::Read).count() == 2 && stats.phase(StatsPhase::Interpolate).count() == 1 &&
+            json.str().find("\"failures\":1,") != string::npos) {
+            cout << " ✓ Phase counts and work counters";
+            passed++;
+        } else {
+            cout << " ✗ Statistics wrong";
+        }
+
+        // Every phase of an observed solve lands in the trace, nested in time
+        char path[] = "/tmp/polysolver-trace-XXXXXX";
+        int fd = mkstemp(path);
+        if (fd >= 0) close(fd);
+        string events;
+        {
+            TraceWriter trace(path);
+            TracePhaseObserver observer(trace);
+            PolynomialSolver traced;
+            traced.setObserver(&observer);
+            uint64_t start = trace.now();
+            traced.solveFromJSON(getTestCases()[0]);
+            trace.complete("doc \"1\"", "document", start, trace.now());
+            trace.finish();
+            events = readFile(path);
+        }
+        unlink(path);
+        size_t converts = 0;
+        for (size_t pos = events.find("\"name\":\"convert\""); pos != string::npos;
+             pos = events.find("\"name\":\"convert\"", pos + 1)) {
+            converts++;
+        }
+        total++;
+        if (events.rfind("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", 0) == 0 &&
+            events.find("\n]}\n") == events.size() - 4 && converts == 3 &&
+            events.find("\"name\":\"interpolate\",\"cat\":\"phase\"") != string::npos &&
+            events.find("\"name\":\"doc \\\"1\\\"\"") != string::npos) {
+            cout << " ✓ Chrome trace of solver phases";
+            passed++;
+        } else {
+            cout << " ✗ Trace events missing";
+        }
+
+        // Allocations land in the phase that made them
+        {
+            SolveStats counted;
+            PolynomialSolver accounted;
+            accounted.setObserver(counted.attachAllocations());
+            alloc_accounting::Counts convertBefore = alloc_accounting::read((int)StatsPhase::Convert);
+            alloc_accounting::Counts outputBefore = alloc_accounting::read((int)StatsPhase::Output);
+            SolveResult counts = accounted.solveFromJSON(getTestCases()[0]);
+            counted.enterPhase(StatsPhase::Output);
+            vector<char>* buffer = new vector<char>(100);
+            delete buffer;
+            counted.enterPhase(StatsPhase::Read);
+            counted.record(counts, 0, 0);
+            alloc_accounting::enable(false);
+            alloc_accounting::Counts convert = alloc_accounting::read((int)StatsPhase::Convert);
+            alloc_accounting::Counts output = alloc_accounting::read((int)StatsPhase::Output);
+            stringstream json;
+            counted.writeJson(json);
+            total++;
+            if (convert.allocations > convertBefore.allocations &&
+                output.allocations == outputBefore.allocations + 2 && output.bytes >= outputBefore.bytes + 100 &&
+                json.str().find("\"allocations\":{\"read\":") != string::npos) {
+                cout << " ✓ Allocations attributed per phase";
+                passed++;
+            } else {
+                cout << " ✗ Allocation accounting wrong";
+            }
+        }
+    }
+    cout << endl;
+
+    // Test 12: Server mode and its metrics
+    cout << "\nTesting server mode..." << endl;
+    {
+        // Every value lands in a bucket that holds it, within 1/32
+        bool bounded = true;
+        for (uint64_t value : {0ULL, 1ULL, 63ULL, 64ULL, 65ULL, 1000ULL, 123456789ULL, 1ULL << 40, ~0ULL}) {
+            int bucket = LatencyHistogram::bucketOf(value);
+            uint64_t low = LatencyHistogram::bucketLowest(bucket), high = LatencyHistogram::bucketHighest(bucket);
+            bounded = bounded && bucket < LatencyHistogram::kBuckets && low <= value && value <= high &&
+                      (high - low) <= low / 32;
+        }
+        LatencyHistogram latency;
+        for (uint64_t value = 1; value <= 100000; value++) latency.record(value);
+        LatencySnapshot snapshot;
+        latency.addTo(snapshot);
+        uint64_t p99 = snapshot.quantile(0.99), p999 = snapshot.quantile(0.999);
+        total++;
+        if (bounded && snapshot.count == 100000 && p99 >= 99000 && p99 <= 99000 + 99000 / 32 &&
+            p999 >= 99900 && p999 <= 99900 + 99900 / 32) {
+            cout << "✓ HDR histogram buckets and p99/p999";
+            passed++;
+        } else {
+            cout << "✗ HDR histogram wrong (p99 " << p99 << ", p999 " << p999 << ")";
+        }
+
+        // Replies come back in order on the socket, and show up in the metrics
+        char directory[] = "/tmp/polysolver-serve-XXXXXX";
+        string reply, exposition, unstalled, events;
+        size_t stuckSent = 0;
+        if (mkdtemp(directory)) {
+            string tracePath = string(directory) + "/trace.json";
+            TraceWriter trace(tracePath);
+            ServerConfig config;
+            config.socketPath = string(directory) + "/solver.sock";
+            config.workers = 2;
+            config.trace = &trace;
+            SolveServer server(config);
+            thread serving([&] { server.run(); });
+            string compact = getTestCases()[0];
+            replace(compact.begin(), compact.end(), '\n', ' ');
+            string request = compact + "\n\n{\"keys\":{\"n\":0,\"k\":0}}\n" + compact;
+
+            int client = socket(AF_UNIX, SOCK_STREAM, 0);
+            sockaddr_un address = {};
+            address.sun_family = AF_UNIX;
+            strncpy(address.sun_path, config.socketPath.c_str(), sizeof address.sun_path - 1);
+            if (client >= 0 && connect(client, (const sockaddr*)&address, sizeof address) == 0 &&
+                write(client, request.data(), request.size()) == (ssize_t)request.size()) {
+                shutdown(client, SHUT_WR);
+                char buffer[4096];
+                for (ssize_t got; (got = read(client, buffer, sizeof buffer)) > 0;) reply.append(buffer, (size_t)got);
+            }
+            if (client >= 0) close(client);
+            server.stop();
+            serving.join();     // workers record the total latency after the reply is sent
+            exposition = server.renderMetrics();
+            trace.finish();
+            ifstream traced(tracePath);
+            events.assign(istreambuf_iterator<char>(traced), istreambuf_iterator<char>());
+            unlink(tracePath.c_str());
+            config.trace = nullptr;
+
+            // A client that sends but never reads must not hold up the workers
+            SolveServer stalled(config);
+            thread stalledServing([&] { stalled.run(); });
+            int stuck = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+            if (stuck >= 0 && connect(stuck, (const sockaddr*)&address, sizeof address) == 0) {
+                string line = compact + "\n";
+                // Far more replies than the socket buffers hold
+                auto deadline = chrono::steady_clock::now() + chrono::seconds(2);
+                for (size_t offset = 0; stuckSent < 5000 && chrono::steady_clock::now() < deadline;) {
+                    ssize_t written = write(stuck, line.data() + offset, line.size() - offset);
+                    if (written < 0) {
+                        this_thread::sleep_for(chrono::milliseconds(1));
+                    } else if ((offset += (size_t)written) == line.size()) {
+                        offset = 0;
+                        stuckSent++;
+                    }
+                }
+                this_thread::sleep_for(chrono::milliseconds(100));
+                int other = socket(AF_UNIX, SOCK_STREAM, 0);
+                timeval timeout = {10, 0};
+                if (other >= 0 && setsockopt(other, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof timeout) == 0 &&
+                    connect(other, (const sockaddr*)&address, sizeof address) == 0 &&
+                    write(other, line.data(), line.size()) == (ssize_t)line.size()) {
+                    shutdown(other, SHUT_WR);
+                    char buffer[4096];
+                    for (ssize_t got; (got = read(other, buffer, sizeof buffer)) > 0;) {
+                        unstalled.append(buffer, (size_t)got);
+                    }
+                }
+                if (other >= 0) close(other);
+            }
+            if (stuck >= 0) close(stuck);
+            stalled.stop();
+            stalledServing.join();
+            rmdir(directory);
+        }
+        size_t first = reply.find("{\"source\":\"client1:1\",\"status\":\"ok\"");
+        size_t second = reply.find("{\"source\":\"client1:3\",\"status\":\"invalid_keys\"");
+        size_t third = reply.find("{\"source\":\"client1:4\",\"status\":\"ok\"");
+        total++;
+        if (first == 0 && second != string::npos && third != string::npos && first < second && second < third &&
+            count(reply.begin(), reply.end(), '\n') == 3) {
+            cout << " ✓ Ordered replies over the socket";
+            passed++;
+        } else {
+            cout << " ✗ Server replies wrong";
+        }
+        total++;
+        if (stuckSent == 5000 && unstalled.find("\"status\":\"ok\"") != string::npos) {
+            cout << " ✓ Unread replies stall no one else";
+            passed++;
+        } else {
+            cout << " ✗ A client that does not read stalled the server";
+        }
+        total++;
+        if (exposition.find("\npolysolver_solved_documents_total 3\n") != string::npos &&
+            exposition.find("\npolysolver_failed_documents_total 1\n") != string::npos &&
+            exposition.find("\npolysolver_in_flight_documents 0\n") != string::npos &&
+            exposition.find("\npolysolver_latency_seconds_count{stage=\"total\"} 3\n") != string::npos &&
+            exposition.find("polysolver_latency_seconds{stage=\"parse\",quantile=\"0.999\"} 0.") != string::npos) {
+            cout << " ✓ Prometheus metrics";
+            passed++;
+        } else {
+            cout << " ✗ Prometheus metrics wrong";
+        }
+        size_t documents = 0;
+        for (size_t at = 0; (at = events.find("\"cat\":\"document\"", at)) != string::npos; at++) documents++;
+        total++;
+        if (events.find("\"name\":\"thread_name\",\"args\":{\"name\":\"worker 0\"}") != string::npos &&
+            events.find("\"name\":\"thread_name\",\"args\":{\"name\":\"worker 1\"}") != string::npos &&
+            documents == 3 && events.find("\"name\":\"client1:3\",\"cat\":\"document\"") != string::npos &&
+            events.find("\"queue_ns\":") != string::npos && events.find("\"name\":\"interpolate\"") != string::npos &&
+            events.rfind("\n]}\n") == events.size() - 4) {
+            cout << " ✓ Worker tracks in the trace";
+            passed++;
+        } else {
+            cout << " ✗ Server trace wrong";
+        }
+    }
+    cout << endl;
+
+    // Test 13: Interpolation under each arithmetic policy
+    cout << "\nTesting arithmetic policies..." << endl;
+    {
+        WorkloadSpec spec;
+        spec.n = 8;
+        spec.k = 8;
+        spec.bases = {2, 10, 16};
+        spec.digits = 12;
+        GeneratedDocument document = WorkloadGenerator(11).next(spec);
+        vector<Share> shares;
+        for (const GeneratedShare& share : document.shares) {
+            shares.emplace_back(share.id, share.base, share.value, BigInt::fromString(share.value, share.base));
+        }
+        __int128 wide = 0;
+        BigInt exact;
+        RnsArithmetic::Value residues = RnsArithmetic::fromInt(0);
+        Mersenne61Arithmetic::Value modular = 0;
+        bool agree = false;
+        try {
+            agree = PolynomialSolver::interpolateShares<Int128Arithmetic>(shares, 0, wide) &&
+                    PolynomialSolver::interpolateShares<BigIntArithmetic>(shares, BigInt(0), exact) &&
+                    PolynomialSolver::interpolateShares<RnsArithmetic>(shares, RnsArithmetic::fromInt(0), residues) &&
+                    PolynomialSolver::interpolateShares<Mersenne61Arithmetic>(shares, 0, modular);
+        } catch (const exception&) {
+        }
+        total++;
+        if (agree && Int128Arithmetic::toBigInt(wide) == document.secret && exact == document.secret &&
+            RnsArithmetic::toBigInt(residues) == document.secret &&
+            modular == Mersenne61Arithmetic::fromBigInt(document.secret)) {
+            cout << "✓ int128, bigint, RNS and GF(p) agree";
+            passed++;
+        } else {
+            cout << "✗ Policies disagree";
+        }
+
+        // Shares reduced mod 2^61 - 1 only solve in that field
+        spec.prime = BigInt::fromString("2305843009213693951", 10);
+        GeneratedDocument reduced = WorkloadGenerator(12).next(spec);
+        vector<BasicPoint<Mersenne61Arithmetic>> fieldPoints;
+        for (const GeneratedShare& share : reduced.shares) {
+            BigInt y = BigInt::fromString(share.value, share.base);
+            fieldPoints.emplace_back(share.id, Mersenne61Arithmetic::fromBigInt(y));
+        }
+        PolynomialSolver::interpolate<Mersenne61Arithmetic>(fieldPoints, fieldPoints.size(), 0, modular);
+        bool congruentIds = false;
+        try {
+            fieldPoints[1].x = fieldPoints[0].x + (long long)Mersenne61Arithmetic::kModulus;
+            PolynomialSolver::interpolate<Mersenne61Arithmetic>(fieldPoints, fieldPoints.size(), 0, modular);
+        } catch (const invalid_argument&) {
+            congruentIds = true;
+        }
+        total++;
+        if (Mersenne61Arithmetic::toBigInt(modular) == reduced.secret && congruentIds) {
+            cout << " ✓ Prime field secret";
+            passed++;
+        } else {
+            cout << " ✗ Prime field secret wrong";
+        }
+
+        // Byte-wise Shamir: s(x) = 0x53 + 0xca·x + 0x1f·x² over GF(2^8)
+        vector<BasicPoint<GF256Arithmetic>> bytes;
+        for (int x = 1; x <= 5; x++) {
+            uint8_t y = 0x1f;
+            for (uint8_t coefficient : {0xca, 0x53}) {
+                GF256Arithmetic::mul(y, (uint8_t)x);
+                GF256Arithmetic::add(y, coefficient);
+            }
+            if (x != 1 && x != 3) bytes.emplace_back(x, y);
+        }
+        uint8_t secretByte = 0, inverse = 0x53;
+        GF256Arithmetic::mul(inverse, 0xca);
+        PolynomialSolver::interpolate<GF256Arithmetic>(bytes, 3, 0, secretByte);
+        total++;
+        if (secretByte == 0x53 && inverse == 1) {
+            cout << " ✓ GF(2^8) byte secret";
+            passed++;
+        } else {
+            cout << " ✗ GF(2^8) secret " << (int)secretByte;
+        }
+
+        // Integer policies: a non-integer P(0) is reported, an overflow throws
+        vector<BasicPoint<Int128Arithmetic>> half = {{1, 7}, {3, 12}};
+        bool integral = PolynomialSolver::interpolate<Int128Arithmetic>(half, 2, 0, wide);
+        vector<BasicPoint<Int128Arithmetic>> huge = {{1, (__int128)1 << 120}, {1000, 0}, {2000, 1}};
+        bool overflowed = false;
+        try {
+            PolynomialSolver::interpolate<Int128Arithmetic>(huge, 3, 0, wide);
+        } catch (const overflow_error&) {
+            overflowed = true;
+        }
+        total++;
+        if (!integral && overflowed) {
+            cout << " ✓ int128 rejects fractions and overflow";
+            passed++;
+        } else {
+            cout << " ✗ int128 limits not enforced";
+        }
+
+#ifdef POLYSOLVER_HAVE_GMP
+        // The GMP backend: same secret, same messages for bad digits
+        string json = document.toJson(false);
+        size_t digit = json.find("\"value\": \"") + 10;
+        string broken = json.substr(0, digit) + "z" + json.substr(digit + 1);
+        PolynomialSolver bigintSolver, gmpSolver;
+        gmpSolver.setBackend(ExactBackend::Gmp);
+        SolveResult viaBigint = bigintSolver.solveFromJSON(json), viaGmp = gmpSolver.solveFromJSON(json);
+        SolveResult badBigint = bigintSolver.solveFromJSON(broken), badGmp = gmpSolver.solveFromJSON(broken);
+        bool sameMessages = badBigint.diagnostics.size() == badGmp.diagnostics.size() && !badGmp.diagnostics.empty();
+        for (size_t d = 0; sameMessages && d < badGmp.diagnostics.size(); d++) {
+            sameMessages = badBigint.diagnostics[d].message == badGmp.diagnostics[d].message;
+        }
+        total++;
+        if (viaGmp.ok() && viaGmp.exact && viaGmp.exactSecret == document.secret &&
+            viaBigint.exactSecret == viaGmp.exactSecret && sameMessages) {
+            cout << " ✓ GMP backend agrees";
+            passed++;
+        } else {
+            cout << " ✗ GMP backend disagrees";
+        }
+#endif
+    }
+    cout << endl;
+
+    // Test 14: Share sets solved at compile time
+    cout << "\nTesting compile-time share sets..." << endl;
+    {
+        PolynomialSolver solver;
+        total++;
+        if (kTestCase1Secret.toBigInt() == solver.solveFromJSON(kTestCase1).exactSecret &&
+            kTestCase2Secret.toBigInt() == solver.solveFromJSON(kTestCase2).exactSecret) {
+            cout << "✓ Constant secrets match the solver";
+            passed++;
+        } else {
+            cout << "✗ Constant secrets differ from the solver";
+        }
+
+        // The same code at runtime, on a fresh document and a broken one
+        WorkloadSpec spec;
+        spec.n = 12;
+        spec.k = 10;
+        spec.bases = {2, 10, 16};
+        spec.digits = 20;
+        GeneratedDocument document = WorkloadGenerator(14).next(spec);
+        string json = document.toJson(false);
+        string offset, modular;
+        try {
+            embeddedSecret(json.substr(0, json.size() - 3));
+        } catch (const invalid_argument& e) {
+            offset = e.what();
+        }
+        spec.prime = BigInt(1000003);
+        try {
+            embeddedSecret(WorkloadGenerator(14).next(spec).toJson());
+        } catch (const invalid_argument& e) {
+            modular = e.what();
+        }
+        total++;
+        if (embeddedSecret(json).toBigInt() == document.secret && offset.find("at byte") != string::npos &&
+            modular.find("keys.prime") != string::npos) {
+            cout << " ✓ Runtime evaluation and errors";
+            passed++;
+        } else {
+            cout << " ✗ Runtime evaluation wrong" << (offset.empty() ? "" : ": " + offset);
+        }
+    }
+    cout << endl;
+
+    // Test 15: Schema parser, strict and lenient
+    cout << "\nTesting share document parser..." << endl;
+    {
+        PolynomialSolver lenient, strict;
+        strict.setParseMode(ParseMode::Strict);
+        const string extra = R"({"keys":{"n":2,"k":2},"note":[1,{"a":null}],"2":{"base":10,"value":"7"},)"
+                             R"("1":{"base":"10","value":"5","by":"x"},})";
+        SolveResult loose = lenient.solveFromJSON(extra), exact = strict.solveFromJSON(extra);
+        total++;
+        if (strict.solveFromJSON(kTestCase2).secretString() == "-6290016743746469796" &&
+            loose.ok() && loose.secretString() == "3" && exact.status == SolveStatus::MalformedDocument &&
+            exact.diagnostics[0].message == "Malformed document: expected \"keys\" or a share id at byte 22") {
+            cout << "✓ Strict rejects what lenient skips";
+            passed++;
+        } else {
+            cout << "✗ Parse modes wrong";
+        }
+
+        // Syntax errors stop both modes at the offending byte
+        string cut = string(kTestCase1).substr(0, 60);
+        SolveResult truncated = lenient.solveFromJSON(cut);
+        SolveResult unquoted = strict.solveFromJSON(R"({"keys":{"n":1,"k":1},"1":{"base":"10","value":5}})");
+        ps_solver* cSolver = ps_solver_create();
+        ps_scratch* scratch = ps_scratch_create();
+        bool viaAbi = ps_solve(cSolver, scratch, "{\"keys\" {", 10, nullptr) == PS_ERR_MALFORMED;
+        ps_scratch_free(scratch);
+        ps_solver_free(cSolver);
+        total++;
+        if (truncated.status == SolveStatus::MalformedDocument &&
+            truncated.diagnostics[0].message.find("at byte 60") != string::npos &&
+            unquoted.diagnostics[0].message == "Malformed document: expected a string at byte 47" && viaAbi) {
+            cout << " ✓ Byte offsets of syntax errors";
+            passed++;
+        } else {
+            cout << " ✗ Syntax errors not reported";
+        }
+
+        // Ids in any order; shares are still used from id 1 up
+        WorkloadSpec spec;
+        spec.n = 40;
+        spec.k = 25;
+        GeneratedDocument document = WorkloadGenerator(15).next(spec);
+        string reversed = "{\"keys\":{\"n\":40,\"k\":25}";
+        for (size_t i = document.shares.size(); i-- > 0;) {
+            const GeneratedShare& share = document.shares[i];
+            reversed += ",\"" + to_string(share.id) + "\":{\"base\":\"" + to_string(share.base) +
+                        "\",\"value\":\"" + share.value + "\"}";
+        }
+        reversed += "}";
+        SolveResult ordered = strict.solveFromJSON(document.toJson()), shuffled = strict.solveFromJSON(reversed);
+        total++;
+        if (ordered.ok() && shuffled.ok() && ordered.exactSecret == document.secret &&
+            shuffled.exactSecret == document.secret && shuffled.shares.front().id == 1) {
+            cout << " ✓ Ids in any order";
+            passed++;
+        } else {
+            cout << " ✗ Share order changed the secret";
+        }
+    }
+    cout << endl;
+
+    // Test 16: One parsed tape, several operations
+    cout << "\nTesting document tape..." << endl;
+    {
+        PolynomialSolver solver;
+        WorkloadSpec spec;
+        spec.n = 30;
+        spec.k = 12;
+        spec.bases = {2, 10, 16};
+        GeneratedDocument document = WorkloadGenerator(16).next(spec);
+        string json = document.toJson();
+        DocumentTape tape;
+        solver.buildTape(json, tape);
+        SolveResult fromTape, fromJson = solver.solveFromJSON(json);
+        solver.recoverSecret(tape, fromTape);
+        vector<BigInt> coefficients;
+        vector<long long> mismatched = {0};
+        bool onCurve = tape.ok() && tape.size() == 30;
+        for (size_t i = 0; onCurve && i < tape.size(); i++) {
+            BigInt value;
+            onCurve = solver.evaluateAt(tape, tape.id(i), value) && value == tape.value(i) &&
+                      tape.digits(i) == document.shares[i].value;
+        }
+        total++;
+        if (onCurve && fromTape.ok() && fromTape.exactSecret == document.secret &&
+            fromTape.secretString() == fromJson.secretString() && fromTape.sharesUsed == 12 &&
+            solver.recoverCoefficients(tape, coefficients) && coefficients.size() == 12 &&
+            coefficients[0] == document.secret && solver.verifyShares(tape, mismatched) == 18 && mismatched.empty()) {
+            cout << "✓ Secret, coefficients, evaluation and verification from one parse";
+            passed++;
+        } else {
+            cout << "✗ Tape operations disagree";
+        }
+
+        // P(x) = 5 + 2x + 3x^2 with share 5 corrupted, then x(x - 1)/2,
+        // which is integral at every integer but has fractional coefficients
+        const string corrupted = R"({"keys":{"n":6,"k":3},"1":{"base":"10","value":"10"},)"
+                                 R"("2":{"base":"10","value":"21"},"3":{"base":"10","value":"38"},)"
+                                 R"("4":{"base":"10","value":"61"},"5":{"base":"10","value":"91"},)"
+                                 R"("6":{"base":"10","value":"125"}})";
+        const string halves = R"({"keys":{"n":4,"k":3},"1":{"base":"10","value":"0"},)"
+                              R"("2":{"base":"10","value":"1"},"3":{"base":"10","value":"3"},)"
+                              R"("4":{"base":"10","value":"6"}})";
+        DocumentTape other;
+        solver.buildTape(corrupted, other);
+        bool found = solver.verifyShares(other, mismatched) == 3 && mismatched == vector<long long>{5} &&
+                     solver.recoverCoefficients(other, coefficients) &&
+                     coefficients == vector<BigInt>{BigInt(5), BigInt(2), BigInt(3)};
+        solver.buildTape(halves, other);
+        BigInt ten;
+        bool fractional = !solver.recoverCoefficients(other, coefficients) && solver.evaluateAt(other, 5, ten) &&
+                          ten == BigInt(10) && solver.verifyShares(other, mismatched) == 1 && mismatched.empty();
+        bool refused = false;
+        const string unsolvable = "{}";
+        solver.buildTape(unsolvable, other);
+        try {
+            solver.evaluateAt(other, 0, ten);
+        } catch (const invalid_argument&) {
+            refused = true;
+        }
+        total++;
+        if (found && fractional && refused) {
+            cout << " ✓ Bad shares found, fractional coefficients refused";
+            passed++;
+        } else {
+            cout << " ✗ Tape verification wrong";
+        }
+    }
+    cout << endl;
+
+    // Test 17: Scale tier, exact against an independent oracle and within budget
+    cout << "\nTesting scale tier (k up to " << scaleMaxK << ")..." << endl;
+    for (const ScaleTier& tier : kScaleTiers) {
+        if (tier.k > scaleMaxK) break;
+        WorkloadSpec spec;
+        spec.n = tier.k + tier.k / 10;      // the solver takes shares 1..k
+        spec.k = tier.k;
+        spec.bases = {2, 3, 7, 10, 16};
+        spec.digits = tier.digits;
+        GeneratedDocument document = WorkloadGenerator((uint64_t)tier.k).next(spec);
+
+        vector<BigInt> values;
+        values.reserve((size_t)tier.k);
+        for (int i = 0; i < tier.k; i++) {
+            values.push_back(slowDecode(document.shares[(size_t)i].value, document.shares[(size_t)i].base));
+        }
+        BigInt oracle = finiteDifferenceSecret(values);
+        values = vector<BigInt>();
+
+        SolveResult solved = PolynomialSolver().solveFromJSON(document.toJson());
+        uint64_t elapsedMs = solved.timings.totalNs / 1000000;
+        total++;
+        if (solved.ok() && solved.exact && solved.exactSecret == oracle && oracle == document.secret) {
+            cout << "✓ k=" << tier.k << " exact";
+            passed++;
+        } else {
+            cout << "✗ k=" << tier.k << " secret wrong ("
+                 << (solved.ok() ? solved.secretString() : solved.errorMessage()) << ")";
+        }
+        total++;
+        if (elapsedMs <= tier.budgetMs) {
+            cout << " ✓ in " << elapsedMs << " ms";
+            passed++;
+        } else {
+            cout << " ✗ took " << elapsedMs << " ms, budget " << tier.budgetMs << " ms";
+        }
+        cout << endl;
+    }
+
+    cout << "Test Results: " << passed << "/" << total << " passed" << endl;
+    if (passed == total) {
+        cout << "🎉 All tests passed!" << endl;
+    } else {
+        cout << "⚠️  " << (total - passed) << " test(s) failed." << endl;
+    }
+    return passed == total;
+}
+
+
+/**
+ * Get built-in test cases
+ */
+vector<string> getTestCases() {
+    return {kTestCase1, kTestCase2};
+}
+
+/**
+ * Read entire file content
+ * @param filename: Path to the file
+ * @return: File content as string
+ * @throws runtime_error: If file cannot be opened
+ */
+string readFile(const string& filename) {
+    ifstream file(filename);
+    if (!file.is_open()) {
+        throw runtime_error("Cannot open file: " + filename);
+    }
+    
+    ostringstream ss;
+    ss << file.rdbuf();
+    return ss.str();
+}
+
+/**
+ * Read from stdin
+ * @return: stdin content as string
+ */
+string readStdin() {
+    ostringstream ss;
+    string line;
+    while (getline(cin, line)) {
+        ss << line << "\n";
+    }
+    return ss.str();
+}
+
+/**
+ * Nanoseconds elapsed since a steady clock reading
+ */
+uint64_t elapsedNs(chrono::steady_clock::time_point since) {
+    return (uint64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - since).count();
+}
+
+/**
+ * Optional per-document instrumentation of the solving modes
+ */
+struct Instrumentation {
+    SolveStats* stats = nullptr;    // --stats
+    TraceWriter* trace = nullptr;   // --trace
+    WorkloadRecorder* recorder = nullptr;   // --record
+};
+
+/**
+ * Solve one document and write its result
+ * @param tape, result: Reused across documents
+ * @param hooks: Statistics, trace and recording to add the solve to, if any
+ * @param readNs: Time it took to read the document
+ * @return: true when the document solved
+ */
+bool solveDocument(const PolynomialSolver& solver, OutputWriter& writer, const string& json,
+                   const string& source, DocumentTape& tape, SolveResult& result, const Instrumentation& hooks,
+                   uint64_t readNs) {
+    if (hooks.recorder) hooks.recorder->record(json);
+    uint64_t solveStart = hooks.trace ? hooks.trace->now() : 0;
+    solver.solveFromJSON(json, tape, result);
+    if (hooks.stats) hooks.stats->enterPhase(StatsPhase::Output);
+    chrono::steady_clock::time_point outputStart = chrono::steady_clock::now();
+    writer.writeResult(source, result);
+    uint64_t outputNs = elapsedNs(outputStart);
+    if (hooks.stats) {
+        hooks.stats->enterPhase(StatsPhase::Read);    // until the next document is solved
+        hooks.stats->record(result, readNs, outputNs);
+    }
+    
+    if (hooks.trace) {
+        uint64_t end = hooks.trace->now();
+        uint64_t readStart = solveStart > readNs ? solveStart - readNs : 0;
+        hooks.trace->complete("read", "phase", readStart, solveStart);
+        hooks.trace->complete("output", "phase", end - min(outputNs, end), end);
+        hooks.trace->complete(source, "document", readStart, end,
+                              string("\"status\":\"") + solveStatusName(result.status) + "\",\"n\":" +
+                                  to_string(result.n) + ",\"k\":" + to_string(result.k) + ",\"bytes\":" +
+                                  to_string(json.size()));
+    }
+    return result.ok();
+}
+
+/**
+ * Solve every document of a stream: one JSON document per line (NDJSON), or
+ * the length-prefixed stream written by --generate --gen-format binary
+ * @param solver: Solver to use
+ * @param writer: Destination for the results
+ * @param in: Stream of documents
+ * @param name: Source label prefix; records are labelled "name:line"
+ *              (or "name:#index" for binary input)
+ * @param hooks: Statistics and trace to record each document in, if any
+ * @return: Number of documents that failed to solve
+ */
+size_t solveBatch(const PolynomialSolver& solver, OutputWriter& writer, istream& in, const string& name,
+                  const Instrumentation& hooks = Instrumentation()) {
+    size_t failures = 0;
+    size_t lineNumber = 0;
+    string line;
+    DocumentTape tape;
+    SolveResult result;
+    chrono::steady_clock::time_point readStart = chrono::steady_clock::now();
+    
+    auto solveLine = [&](const string& text) {
+        uint64_t readNs = elapsedNs(readStart);
+        lineNumber++;
+        if (text.find_first_not_of(" \t\r") != string::npos &&
+            !solveDocument(solver, writer, text, name + ":" + to_string(lineNumber), tape, result, hooks, readNs)) {
+            failures++;
+        }
+        readStart = chrono::steady_clock::now();
+    };
+    
+    // Binary document stream: "PSDOCS1\0", then u32 length + JSON per document
+    if (in.peek() == 'P') {
+        char magic[8];
+        in.read(magic, sizeof magic);
+        if (in.gcount() == (streamsize)sizeof magic && memcmp(magic, "PSDOCS1\0", sizeof magic) == 0) {
+            size_t index = 0;
+            uint32_t length;
+            readStart = chrono::steady_clock::now();
+            while (in.read(reinterpret_cast<char*>(&length), sizeof length)) {
+                line.resize(length);
+                if (length > 0 && !in.read(&line[0], (streamsize)length)) {
+                    throw runtime_error("Truncated binary document stream");
+                }
+                uint64_t readNs = elapsedNs(readStart);
+                if (!solveDocument(solver, writer, line, name + ":#" + to_string(++index), tape, result, hooks,
+                                   readNs)) {
+                    failures++;
+                }
+                readStart = chrono::steady_clock::now();
+            }
+            return failures;
+        }
+        
+        // Not the magic: the bytes already read begin ordinary lines
+        string pending(magic, (size_t)in.gcount());
+        if (!in) in.clear(ios::eofbit);
+        for (size_t newline; (newline = pending.find('\n')) != string::npos; pending.erase(0, newline + 1)) {
+            solveLine(pending.substr(0, newline));
+        }
+        if (getline(in, line)) pending += line;
+        if (!pending.empty()) solveLine(pending);
+    }
+    
+    while (getline(in, line)) solveLine(line);
+    return failures;
+}
+
+/**
+ * Command line options shared by all solving modes
+ */
+struct CliOptions {
+    OutputFormat format = OutputFormat::Text;
+    int secretBase = 10;            // base secrets are printed in
+    bool batch = false;             // inputs hold one JSON document per line
+    bool stats = false;             // dump per-phase statistics at exit
+    string statsPath;               // empty: stderr
+    string tracePath;               // Chrome trace output, empty: none
+    bool autotune = false;          // time this host and write the tuning file
+    string tuningPath;              // empty: defaultTuningPath(), optional
+    bool bench = false;             // run the benchmark grid instead of solving
+    BenchConfig benchConfig;
+    string benchJson;               // also write JSON results here ("-": stdout only)
+    string benchBaseline;           // --bench-json file to compare against
+    double maxRegression = 0.05;    // allowed median slowdown per phase
+    uint64_t seed = 1;              // for generated inputs (--bench, --generate)
+    bool generate = false;          // write generated documents instead of solving
+    WorkloadSpec generateSpec;
+    unsigned long long generateCount = 1;
+    DocumentFormat generateFormat = DocumentFormat::JSON;
+    string generateManifest;        // secrets and corrupted ids, one JSON line per document
+    ServerConfig server;            // --serve when socketPath is set
+    string recordPath;              // append received documents to this log
+    string replayPath;              // solve the documents of this log instead of inputs
+    double replaySpeed = 1.0;       // 0: no pauses
+    ExactBackend backend = ExactBackend::InTree;
+    ParseMode parseMode = ParseMode::Lenient;
+    vector<string> inputs;          // files; empty means stdin or built-in cases
+};
+
+/**
+ * Parse a decimal integer within [minimum, maximum]
+ */
+bool parseNumber(const string& text, unsigned long long minimum, unsigned long long maximum,
+                 unsigned long long& value) {
+    if (text.empty() || text.size() > 19 || text.find_first_not_of("0123456789") != string::npos) {
+        return false;
+    }
+    value = strtoull(text.c_str(), nullptr, 10);
+    return value >= minimum && value <= maximum;
+}
+
+/**
+ * Match "--name value" or "--name=value"
+ * @return: true when arg is this option; value is then set (empty if missing)
+ */
+bool optionValue(const string& arg, const string& name, int argc, char* argv[], int& i, string& value) {
+    if (arg == name) {
+        value = i + 1 < argc ? argv[++i] : "";
+        return true;
+    }
+    if (arg.size() > name.size() && arg.compare(0, name.size(), name) == 0 && arg[name.size()] == '=') {
+        value = arg.substr(name.size() + 1);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Show usage information
+ * @param programName: Name of the executable
+ */
+void showUsage(const char* programName) {
+    cout << "Polynomial Solver - Shamir's Secret Sharing Implementation v2.0\n\n";
+    cout << "Usage:\n";
+    cout << "  " << programName << "                    # Interactive mode with built-in test cases\n";
+    cout << "  " << programName << " --test            # Run comprehensive tests\n";
+    cout << "  " << programName << " --test-scale <k>  # Same, with the scale tier up to k (10000 takes minutes)\n";
+    cout << "  " << programName << " <file.json>       # Read JSON from file\n";
+    cout << "  " << programName << " < input.json      # Read JSON from stdin\n";
+    cout << "  " << programName << " --help            # Show this help\n\n";
+    cout << "Options:\n";
+    cout << "  --format <fmt>    Output format: text (default), quiet, ndjson, csv, binary\n";
+    cout << "  --secret-base <b> Print secrets in base b (2-16), default 10\n";
+    cout << "  --backend <name>  Big integer engine: bigint (default) or gmp (when built with libgmp)\n";
+    cout << "  --batch           Inputs contain one JSON document per line (NDJSON)\n";
+    cout << "  --strict          Reject documents that are not exactly the share schema\n";
+    cout << "  --stats[=<file>]  At exit, write per-phase time and work histograms as JSON\n";
+    cout << "                    (to stderr unless a file is given)\n";
+    cout << "  --trace <file>    Write a Chrome trace (chrome://tracing, Perfetto) of every\n";
+    cout << "                    document and solver phase\n";
+    cout << "  --autotune        Time the algorithms on this host and save the crossovers\n";
+    cout << "  --tuning <file>   Tuning file to load (or write with --autotune); default\n";
+    cout << "                    $POLYSOLVER_TUNING or ~/.config/polysolver/tuning.conf\n";
+    cout << "  --bench           Time parse/convert/interpolate/output on generated inputs\n";
+    cout << "    --bench-n <list>, --bench-k <list>, --bench-bases <list>, --bench-digits <list>\n";
+    cout << "                    Grid axes, comma separated (defaults 8,64 / 3,8,64 / 10,16 / 20,200,2000)\n";
+    cout << "    --bench-reps <r>, --bench-warmup <w>   Repetitions per cell (15) and warm-up runs (3)\n";
+    cout << "    --bench-json <file>                    Also write results as JSON (\"-\": stdout)\n";
+    cout << "    --baseline <file>                      Fail on regressions against an earlier --bench-json\n";
+    cout << "    --max-regression <pct>                 Allowed median slowdown per phase (5%)\n";
+    cout << "  --generate        Write share documents from random polynomials to stdout\n";
+    cout << "    --gen-n <n>, --gen-k <k>               Shares per document (10) and threshold (3)\n";
+    cout << "    --gen-bases <list>, --gen-digits <d>   Base mix (10) and coefficient digits (20)\n";
+    cout << "    --gen-prime <p>                        Work modulo the prime p (keys.prime; solved mod p)\n";
+    cout << "    --gen-corrupt <f>                      Fraction of shares given wrong values (0)\n";
+    cout << "    --gen-count <c>, --gen-format <fmt>    Documents (1); json, ndjson or binary\n";
+    cout << "    --gen-manifest <file>                  Secret and corrupted ids per document\n";
+    cout << "  --seed <s>        Seed for --bench and --generate inputs (1)\n";
+    cout << "  --record <file>   Append every document received, with its arrival time, to a log\n";
+    cout << "  --replay <file>   Solve the documents of a --record log at their recorded pace\n";
+    cout << "    --speed <x>                            Replay x times faster (1); 0 for no pauses\n";
+    cout << "  --serve <socket>  Answer NDJSON documents on a Unix socket until SIGINT/SIGTERM\n";
+    cout << "                    (with --replay: answer the log to stdout, then exit)\n";
+    cout << "    --workers <w>, --queue-limit <q>       Solver threads (one per CPU), waiting documents\n";
+    cout << "    --metrics-socket <socket>              Serve Prometheus metrics to every connection\n";
+    cout << "    --metrics-file <file>                  Rewrite Prometheus metrics to a file\n";
+    cout << "    --metrics-interval <ms>                How often the file is rewritten (1000)\n";
+    cout << "  Several input files may be given; each is solved in turn.\n\n";
+    cout << "JSON Format:\n";
+    cout << "{\n";
+    cout << "  \"keys\": { \"n\": 4, \"k\": 3 },\n";
+    cout << "  \"1\": { \"base\": \"10\", \"value\": \"4\" },\n";
+    cout << "  \"2\": { \"base\": \"2\", \"value\": \"111\" },\n";
+    cout << "  \"3\": { \"base\": \"10\", \"value\": \"12\" },\n";
+    cout << "  \"6\": { \"base\": \"4\", \"value\": \"213\" }\n";
+    cout << "}\n\n";
+    cout << "Where:\n";
+    cout << "  n = total number of roots provided\n";
+    cout << "  k = minimum number of roots needed (polynomial degree + 1)\n";
+    cout << "  base = number base (2-16)\n";
+    cout << "  value = number in the specified base\n";
+}
+
+SolveServer* gServer = nullptr;     // for the signal handler while --serve runs
+
+extern "C" void stopServer(int) {
+    if (gServer) gServer->stop();
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        PolynomialSolver solver;
+        CliOptions options;
+        
+        // Handle command line arguments
+        for (int i = 1; i < argc; i++) {
+            string arg = argv[i];
+            string value;
+            
+            if (arg == "--help" || arg == "-h") {
+                showUsage(argv[0]);
+                return 0;
+            }
+            
+            if (arg == "--test") {
+                return runTests() ? 0 : 1;
+            }
+
+            if (optionValue(arg, "--test-scale", argc, argv, i, value)) {
+                unsigned long long maxK;
+                if (!parseNumber(value, 1, 10000, maxK)) {
+                    cerr << "Invalid --test-scale: '" << value << "' (1-10000)" << endl;
+                    return 1;
+                }
+                return runTests((int)maxK) ? 0 : 1;
+            }
+            
+            if (arg == "--version" || arg == "-v") {
+                cout << "Polynomial Solver v2.0" << endl;
+                return 0;
+            }
+            
+            if (arg == "--format" || arg.rfind("--format=", 0) == 0) {
+                string name = arg == "--format" ? (i + 1 < argc ? argv[++i] : "") : arg.substr(9);
+                if (!parseOutputFormat(name, options.format)) {
+                    cerr << "Unknown output format: '" << name << "'" << endl;
+                    return 1;
+                }
+            } else if (optionValue(arg, "--secret-base", argc, argv, i, value)) {
+                unsigned long long base;
+                if (!parseNumber(value, 2, 16, base)) {
+                    cerr << "Invalid secret base: '" << value << "' (must be 2-16)" << endl;
+                    return 1;
+                }
+                options.secretBase = (int)base;
+            } else if (optionValue(arg, "--backend", argc, argv, i, value)) {
+                if (!parseExactBackend(value, options.backend)) {
+                    cerr << "Unknown backend: '" << value << "'" << endl;
+                    return 1;
+                }
+                if (!PolynomialSolver::backendAvailable(options.backend)) {
+                    cerr << "Backend not built in: " << value << " (install libgmp and rebuild)" << endl;
+                    return 1;
+                }
+            } else if (arg == "--batch") {
+                options.batch = true;
+            } else if (arg == "--strict") {
+                options.parseMode = ParseMode::Strict;
+            } else if (arg == "--stats" || arg.rfind("--stats=", 0) == 0) {
+                // No separate-argument form: "--stats file.json" would swallow an input
+                options.stats = true;
+                options.statsPath = arg == "--stats" ? "" : arg.substr(8);
+                if (arg != "--stats" && options.statsPath.empty()) {
+                    cerr << "Missing file name for --stats=" << endl;
+                    return 1;
+                }
+            } else if (optionValue(arg, "--trace", argc, argv, i, value)) {
+                if (value.empty()) {
+                    cerr << "Missing file name for --trace" << endl;
+                    return 1;
+                }
+                options.tracePath = value;
+            } else if (arg == "--bench") {
+                options.bench = true;
+            } else if (optionValue(arg, "--bench-n", argc, argv, i, value) ||
+                       optionValue(arg, "--bench-k", argc, argv, i, value) ||
+                       optionValue(arg, "--bench-bases", argc, argv, i, value) ||
+                       optionValue(arg, "--bench-digits", argc, argv, i, value)) {
+                BenchConfig& bench = options.benchConfig;
+                vector<int>& axis = arg.rfind("--bench-n", 0) == 0     ? bench.ns
+                                  : arg.rfind("--bench-k", 0) == 0     ? bench.ks
+                                  : arg.rfind("--bench-bases", 0) == 0 ? bench.bases
+                                                                       : bench.digits;
+                if (!parseIntList(value, axis)) {
+                    cerr << "Invalid list for " << arg << ": '" << value << "'" << endl;
+                    return 1;
+                }
+                if (&axis == &bench.bases && any_of(axis.begin(), axis.end(), [](int b) { return b > 16 || b < 2; })) {
+                    cerr << "Invalid base in '" << value << "' (must be 2-16)" << endl;
+                    return 1;
+                }
+            } else if (optionValue(arg, "--bench-reps", argc, argv, i, value) ||
+                       optionValue(arg, "--bench-warmup", argc, argv, i, value)) {
+                bool reps = arg.rfind("--bench-reps", 0) == 0;
+                unsigned long long count;
+                if (!parseNumber(value, reps ? 1 : 0, 1000000, count)) {
+                    cerr << "Invalid count for " << arg << ": '" << value << "'" << endl;
+                    return 1;
+                }
+                (reps ? options.benchConfig.repetitions : options.benchConfig.warmup) = (int)count;
+            } else if (optionValue(arg, "--bench-json", argc, argv, i, value)) {
+                if (value.empty()) {
+                    cerr << "Missing file name for --bench-json" << endl;
+                    return 1;
+                }
+                options.benchJson = value;
+            } else if (optionValue(arg, "--baseline", argc, argv, i, value)) {
+                if (value.empty()) {
+                    cerr << "Missing file name for --baseline" << endl;
+                    return 1;
+                }
+                options.benchBaseline = value;
+            } else if (optionValue(arg, "--max-regression", argc, argv, i, value)) {
+                string number = !value.empty() && value.back() == '%' ? value.substr(0, value.size() - 1) : value;
+                char* end = nullptr;
+                double percent = strtod(number.c_str(), &end);
+                if (number.empty() || *end != '\0' || !(percent >= 0.0 && percent <= 1000.0)) {
+                    cerr << "Invalid regression threshold: '" << value << "' (a percentage, e.g. 5%)" << endl;
+                    return 1;
+                }
+                options.maxRegression = percent / 100.0;
+            } else if (optionValue(arg, "--seed", argc, argv, i, value)) {
+                unsigned long long seed;
+                if (!parseNumber(value, 0, ULLONG_MAX, seed)) {
+                    cerr << "Invalid seed: '" << value << "'" << endl;
+                    return 1;
+                }
+                options.seed = seed;
+            } else if (arg == "--generate") {
+                options.generate = true;
+            } else if (optionValue(arg, "--gen-n", argc, argv, i, value) ||
+                       optionValue(arg, "--gen-k", argc, argv, i, value) ||
+                       optionValue(arg, "--gen-digits", argc, argv, i, value) ||
+                       optionValue(arg, "--gen-count", argc, argv, i, value)) {
+                unsigned long long number;
+                if (!parseNumber(value, 1, 1000000, number)) {
+                    cerr << "Invalid value for " << arg << ": '" << value << "' (must be 1-1000000)" << endl;
+                    return 1;
+                }
+                WorkloadSpec& spec = options.generateSpec;
+                if (arg.rfind("--gen-n", 0) == 0) spec.n = (int)number;
+                else if (arg.rfind("--gen-k", 0) == 0) spec.k = (int)number;
+                else if (arg.rfind("--gen-digits", 0) == 0) spec.digits = (size_t)number;
+                else options.generateCount = number;
+            } else if (optionValue(arg, "--gen-bases", argc, argv, i, value)) {
+                vector<int>& bases = options.generateSpec.bases;
+                if (!parseIntList(value, bases) ||
+                    any_of(bases.begin(), bases.end(), [](int b) { return b > 16 || b < 2; })) {
+                    cerr << "Invalid base list: '" << value << "' (bases must be 2-16)" << endl;
+                    return 1;
+                }
+            } else if (optionValue(arg, "--gen-prime", argc, argv, i, value)) {
+                try {
+                    options.generateSpec.prime = BigInt::fromString(value, 10);
+                } catch (const exception&) {
+                    cerr << "Invalid prime: '" << value << "'" << endl;
+                    return 1;
+                }
+            } else if (optionValue(arg, "--gen-corrupt", argc, argv, i, value)) {
+                char* end = nullptr;
+                double fraction = strtod(value.c_str(), &end);
+                if (value.empty() || *end != '\0' || !(fraction >= 0.0 && fraction <= 1.0)) {
+                    cerr << "Invalid corrupt fraction: '" << value << "' (must be 0-1)" << endl;
+                    return 1;
+                }
+                options.generateSpec.corruptFraction = fraction;
+            } else if (optionValue(arg, "--gen-format", argc, argv, i, value)) {
+                if (!parseDocumentFormat(value, options.generateFormat)) {
+                    cerr << "Unknown document format: '" << value << "'" << endl;
+                    return 1;
+                }
+            } else if (optionValue(arg, "--gen-manifest", argc, argv, i, value)) {
+                if (value.empty()) {
+                    cerr << "Missing file name for --gen-manifest" << endl;
+                    return 1;
+                }
+                options.generateManifest = value;
+            } else if (optionValue(arg, "--serve", argc, argv, i, value) ||
+                       optionValue(arg, "--metrics-socket", argc, argv, i, value) ||
+                       optionValue(arg, "--metrics-file", argc, argv, i, value)) {
+                if (value.empty()) {
+                    cerr << "Missing path for " << arg << endl;
+                    return 1;
+                }
+                ServerConfig& server = options.server;
+                (arg.rfind("--serve", 0) == 0             ? server.socketPath
+                 : arg.rfind("--metrics-socket", 0) == 0 ? server.metricsSocket
+                                                          : server.metricsFile) = value;
+            } else if (optionValue(arg, "--workers", argc, argv, i, value) ||
+                       optionValue(arg, "--queue-limit", argc, argv, i, value) ||
+                       optionValue(arg, "--metrics-interval", argc, argv, i, value)) {
+                unsigned long long number;
+                if (!parseNumber(value, 1, 1000000, number)) {
+                    cerr << "Invalid value for " << arg << ": '" << value << "' (must be 1-1000000)" << endl;
+                    return 1;
+                }
+                if (arg.rfind("--workers", 0) == 0) options.server.workers = (int)number;
+                else if (arg.rfind("--queue-limit", 0) == 0) options.server.queueLimit = (size_t)number;
+                else options.server.metricsIntervalMs = (int)number;
+            } else if (optionValue(arg, "--record", argc, argv, i, value) ||
+                       optionValue(arg, "--replay", argc, argv, i, value)) {
+                if (value.empty()) {
+                    cerr << "Missing file name for " << arg << endl;
+                    return 1;
+                }
+                (arg.rfind("--record", 0) == 0 ? options.recordPath : options.replayPath) = value;
+            } else if (optionValue(arg, "--speed", argc, argv, i, value)) {
+                char* end = nullptr;
+                double speed = strtod(value.c_str(), &end);
+                if (value.empty() || *end != '\0' || !(speed >= 0.0 && speed <= 1e9)) {
+                    cerr << "Invalid replay speed: '" << value << "' (a factor, 0 for no pauses)" << endl;
+                    return 1;
+                }
+                options.replaySpeed = speed;
+            } else if (arg == "--autotune") {
+                options.autotune = true;
+            } else if (arg == "--tuning" || arg.rfind("--tuning=", 0) == 0) {
+                options.tuningPath = arg == "--tuning" ? (i + 1 < argc ? argv[++i] : "") : arg.substr(9);
+                if (options.tuningPath.empty()) {
+                    cerr << "Missing tuning file name" << endl;
+                    return 1;
+                }
+            } else if (arg.size() > 1 && arg[0] == '-') {
+                cerr << "Unknown option: " << arg << " (see --help)" << endl;
+                return 1;
+            } else {
+                options.inputs.push_back(arg);
+            }
+        }
+        
+        string tuningPath = options.tuningPath.empty() ? defaultTuningPath() : options.tuningPath;
+        if (options.autotune) {
+            cout << "Autotuning on this host (this takes a little while)..." << endl;
+            Tuning tuning = autotune(cout);
+            string error;
+            if (!saveTuning(tuningPath, tuning, error)) {
+                cerr << error << endl;
+                return 1;
+            }
+            cout << "Crossovers: karatsuba=" << tuning.mul.karatsuba << " toom3=" << tuning.mul.toom3
+                 << " ntt=" << tuning.mul.ntt << " parse_leaf=" << tuning.conversion.fromStringLeafChunks
+                 << " print_leaf=" << tuning.conversion.toStringLeafLimbs << endl;
+            cout << "Saved to " << tuningPath << endl;
+            return 0;
+        }
+        
+        // A tuning file named explicitly must load; the default one is optional
+        Tuning tuning = currentTuning();
+        string tuningError;
+        if (loadTuning(tuningPath, tuning, tuningError)) {
+            applyTuning(tuning);
+        } else if (!options.tuningPath.empty() || ifstream(tuningPath).is_open()) {
+            cerr << "Error: " << tuningError << endl;
+            return 1;
+        }
+        
+        if (options.generate) {
+            ofstream manifest;
+            if (!options.generateManifest.empty()) {
+                manifest.open(options.generateManifest);
+                if (!manifest.is_open()) {
+                    cerr << "Cannot write manifest: " << options.generateManifest << endl;
+                    return 1;
+                }
+            }
+            WorkloadGenerator generator(options.seed);
+            for (unsigned long long d = 1; d <= options.generateCount; d++) {
+                GeneratedDocument document = generator.next(options.generateSpec);
+                writeDocument(cout, document, options.generateFormat, d == 1);
+                if (manifest.is_open()) {
+                    manifest << "{\"document\":" << d << ",\"secret\":\"" << document.secret.toString()
+                             << "\",\"corrupted\":[";
+                    for (size_t c = 0; c < document.corruptedIds.size(); c++) {
+                        manifest << (c ? "," : "") << document.corruptedIds[c];
+                    }
+                    manifest << "]}\n";
+                }
+            }
+            cout.flush();
+            return cout && (!manifest.is_open() || manifest) ? 0 : 1;
+        }
+        
+        if (options.bench) {
+            // Read the baseline first so a bad path fails before the long run
+            vector<BenchCase> baseline;
+            if (!options.benchBaseline.empty()) {
+                ifstream file(options.benchBaseline);
+                string error;
+                BenchConfig recorded;
+                if (!file.is_open()) {
+                    cerr << "Cannot read baseline: " << options.benchBaseline << endl;
+                    return 1;
+                }
+                if (!readBenchJson(file, baseline, error, &recorded)) {
+                    cerr << "Invalid baseline " << options.benchBaseline << ": " << error << endl;
+                    return 1;
+                }
+                // Other documents or another backend make the timings incomparable
+                if (recorded.backend != options.backend || recorded.seed != options.seed) {
+                    cerr << "Baseline " << options.benchBaseline << " was run with --backend "
+                         << exactBackendName(recorded.backend) << " --seed " << recorded.seed
+                         << ", this run with --backend " << exactBackendName(options.backend) << " --seed "
+                         << options.seed << endl;
+                    return 1;
+                }
+            }
+            
+            options.benchConfig.seed = options.seed;
+            options.benchConfig.backend = options.backend;
+            string hardwareNote;
+            vector<BenchCase> cases = runBench(options.benchConfig, &hardwareNote);
+            bool jsonOnly = options.benchJson == "-";
+            ostream& report = jsonOnly ? cerr : cout;
+            if (jsonOnly) {
+                printBenchJson(cout, options.benchConfig, cases);
+            } else {
+                printBenchTable(cout, options.benchConfig, cases);
+            }
+            if (!hardwareNote.empty()) report << "\nHardware counters unavailable: " << hardwareNote << endl;
+            if (!jsonOnly && !options.benchJson.empty()) {
+                ofstream json(options.benchJson);
+                printBenchJson(json, options.benchConfig, cases);
+                if (!json) {
+                    cerr << "Cannot write benchmark results: " << options.benchJson << endl;
+                    return 1;
+                }
+                cout << "\nJSON results written to " << options.benchJson << endl;
+            }
+            if (options.benchBaseline.empty()) return 0;
+            
+            size_t compared = count_if(cases.begin(), cases.end(), [&](const BenchCase& c) {
+                return any_of(baseline.begin(), baseline.end(),
+                              [&](const BenchCase& b) { return sameBenchCell(b, c); });
+            });
+            vector<BenchRegression> regressions = compareBench(baseline, cases, options.maxRegression);
+            report << "\nBaseline " << options.benchBaseline << ": " << compared << " of " << cases.size()
+                   << " cells compared, allowed slowdown " << options.maxRegression * 100 << "%\n";
+            if (compared == 0) {
+                report << "No cells in common with the baseline (use the grid options it was run with)\n";
+                return 1;
+            }
+            for (const BenchRegression& r : regressions) {
+                report << "  REGRESSION n=" << r.current->n << " k=" << r.current->k << " base="
+                       << r.current->base << " digits=" << r.current->digits << " "
+                       << benchPhaseName(r.phase) << ": " << fixed << setprecision(1)
+                       << r.baselineMedian / 1000.0 << " -> " << r.currentMedian / 1000.0 << " us (+"
+                       << (r.currentMedian / r.baselineMedian - 1.0) * 100.0 << "%, p="
+                       << setprecision(4) << r.pValue << ")\n";
+                report.unsetf(ios::floatfield);
+            }
+            report << (regressions.empty() ? "No regressions\n" : "Performance regressed\n");
+            return regressions.empty() ? 0 : 1;
+        }
+        
+        if (!options.replayPath.empty() && !options.inputs.empty()) {
+            cerr << "--replay takes its documents from the log, not from input files" << endl;
+            return 1;
+        }
+        unique_ptr<WorkloadRecorder> recorder;
+        unique_ptr<WorkloadReplay> replay;
+        try {
+            if (!options.recordPath.empty()) recorder.reset(new WorkloadRecorder(options.recordPath));
+            if (!options.replayPath.empty()) replay.reset(new WorkloadReplay(options.replayPath, options.replaySpeed));
+        } catch (const exception& e) {
+            cerr << e.what() << endl;
+            return 1;
+        }
+        
+        if (!options.server.socketPath.empty()) {
+            if (!options.inputs.empty() || options.batch || options.stats) {
+                cerr << "--serve reads documents from its socket; it takes no input files, --batch or --stats"
+                     << endl;
+                return 1;
+            }
+            // Text is the terminal default; a socket gets one JSON line per document
+            options.server.format = options.format == OutputFormat::Text ? OutputFormat::NDJSON : options.format;
+            options.server.secretBase = options.secretBase;
+            options.server.backend = options.backend;
+            options.server.parseMode = options.parseMode;
+            unique_ptr<TraceWriter> trace;
+            if (!options.tracePath.empty()) {
+                trace.reset(new TraceWriter(options.tracePath));
+                options.server.trace = trace.get();
+            }
+            SolveServer server(options.server);
+            gServer = &server;
+            signal(SIGINT, stopServer);
+            signal(SIGTERM, stopServer);
+            cerr << "Serving on " << options.server.socketPath << " with " << server.metrics().workerCount()
+                 << " workers" << endl;
+            server.setRecorder(recorder.get());
+            
+            // A replay stops the server once the whole log is answered
+            thread replaying;
+            string replayError;
+            if (replay) {
+                replaying = thread([&] {
+                    try {
+                        server.replay(*replay);
+                    } catch (const exception& e) {
+                        replayError = e.what();
+                    }
+                    server.stop();
+                });
+            }
+            server.run();
+            gServer = nullptr;
+            if (replaying.joinable()) replaying.join();
+            if (!replayError.empty()) cerr << "Replay stopped: " << replayError << endl;
+            if (trace && !trace->finish()) {
+                cerr << "Cannot write trace: " << options.tracePath << endl;
+                return 1;
+            }
+            if (recorder && !recorder->finish()) {
+                cerr << "Cannot write recording: " << options.recordPath << endl;
+                return 1;
+            }
+            return replayError.empty() ? 0 : 1;
+        }
+        
+        OutputWriter writer(STDOUT_FILENO, STDERR_FILENO, options.format);
+        writer.setSecretBase(options.secretBase);
+        size_t failures = 0;
+        DocumentTape tape;
+        SolveResult result;
+        SolveStats stats;
+        Instrumentation hooks;
+        SolveObserverList observers;
+        unique_ptr<TraceWriter> trace;
+        unique_ptr<TracePhaseObserver> tracePhases;
+        if (options.stats) {
+            hooks.stats = &stats;
+            if (SolveObserver* counters = stats.attachCounters()) observers.add(counters);
+            observers.add(stats.attachAllocations());
+            stats.enterPhase(StatsPhase::Read);
+        }
+        if (!options.tracePath.empty()) {
+            trace.reset(new TraceWriter(options.tracePath));
+            trace->nameThread("main");
+            tracePhases.reset(new TracePhaseObserver(*trace));
+            observers.add(tracePhases.get());
+            hooks.trace = trace.get();
+        }
+        if (!observers.empty()) solver.setObserver(&observers);
+        solver.setBackend(options.backend);
+        solver.setParseMode(options.parseMode);
+        hooks.recorder = recorder.get();
+        
+        // Results first, then the statistics of everything solved
+        auto finish = [&](int status) {
+            writer.flush();
+            if (trace && !trace->finish()) {
+                cerr << "Cannot write trace: " << options.tracePath << endl;
+                status = 1;
+            }
+            if (recorder && !recorder->finish()) {
+                cerr << "Cannot write recording: " << options.recordPath << endl;
+                status = 1;
+            }
+            if (!hooks.stats) return status;
+            if (options.statsPath.empty()) {
+                stats.writeJson(cerr);
+                return status;
+            }
+            ofstream file(options.statsPath);
+            stats.writeJson(file);
+            if (!file) {
+                cerr << "Cannot write statistics: " << options.statsPath << endl;
+                return 1;
+            }
+            return status;
+        };
+        
+        // Documents of a recording, paced like the original arrivals
+        if (replay) {
+            RecordedDocument document;
+            size_t index = 0;
+            try {
+                while (replay->next(document)) {
+                    this_thread::sleep_until(replay->due());
+                    if (!solveDocument(solver, writer, document.document, "replay:" + to_string(++index), tape, result,
+                                       hooks, 0)) {
+                        failures++;
+                    }
+                }
+            } catch (const exception& e) {
+                writer.flush();
+                cerr << "Error reading recording: " << e.what() << endl;
+                return 1;
+            }
+            return finish(failures == 0 ? 0 : 1);
+        }
+        
+        // Read from files
+        if (!options.inputs.empty()) {
+            for (const string& path : options.inputs) {
+                if (options.batch) {
+                    ifstream file(path);
+                    if (!file.is_open()) {
+                        writer.flush();
+                        cerr << "Error reading file: Cannot open file: " << path << endl;
+                        return 1;
+                    }
+                    failures += solveBatch(solver, writer, file, path, hooks);
+                    continue;
+                }
+                
+                string content;
+                chrono::steady_clock::time_point readStart = chrono::steady_clock::now();
+                try {
+                    content = readFile(path);
+                } catch (const exception& e) {
+                    writer.flush();
+                    cerr << "Error reading file: " << e.what() << endl;
+                    return 1;
+                }
+                uint64_t readNs = elapsedNs(readStart);
+                writer.note("Reading from file: " + path + "\n");
+                if (!solveDocument(solver, writer, content, path, tape, result, hooks, readNs)) failures++;
+            }
+            return finish(failures == 0 ? 0 : 1);
+        }
+        
+        // Check if stdin has data
+        if (!cin.eof() && cin.peek() != EOF) {
+            try {
+                if (options.batch) {
+                    failures = solveBatch(solver, writer, cin, "stdin", hooks);
+                    return finish(failures == 0 ? 0 : 1);
+                }
+                
+                chrono::steady_clock::time_point readStart = chrono::steady_clock::now();
+                string content = readStdin();
+                uint64_t readNs = elapsedNs(readStart);
+                if (!content.empty()) {
+                    writer.note("Reading from stdin...\n");
+                    bool solved = solveDocument(solver, writer, content, "stdin", tape, result, hooks, readNs);
+                    return finish(solved ? 0 : 1);
+                }
+            } catch (const exception& e) {
+                writer.flush();
+                cerr << "Error reading stdin: " << e.what() << endl;
+                return 1;
+            }
+        }
+        
+        // Interactive mode with built-in test cases
+        writer.note("=== Polynomial Solver v2.0 - Interactive Mode ===\n");
+        writer.note("Running built-in test cases...\n\n");
+        
+        vector<string> testCases = getTestCases();
+        
+        for (size_t i = 0; i < testCases.size(); i++) {
+            writer.note("--- Test Case " + to_string(i + 1) + " ---\n");
+            bool solved = solveDocument(solver, writer, testCases[i], "builtin:" + to_string(i + 1), tape, result,
+                                        hooks, 0);
+            writer.note(solved ? "\n" : "Failed to solve this test case\n\n");
+        }
+        
+        string program = argv[0];
+        writer.note("Additional options:\n");
+        writer.note("  " + program + " --test     # Run comprehensive tests\n");
+        writer.note("  " + program + " --help     # Show detailed usage\n");
+        writer.note("  " + program + " file.json  # Process your own JSON file\n");
+        
+        return finish(0);
+        
+    } catch (const exception& e) {
+        cerr << "Unexpected error: " << e.what() << endl;
+        return 1;
+    }
+}
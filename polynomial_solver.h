@@ -0,0 +1,513 @@
+/**
+ * Polynomial Solver - core library interface
+ *
+ * Pure-compute half of the solver: parsing, base conversion and Lagrange
+ * interpolation. Nothing in here writes to stdout/stderr; every outcome,
+ * including per-share warnings and phase timings, is returned in a
+ * SolveResult so the caller decides what (if anything) to print.
+ *
+ * The command line front end lives in polynomial_solver.cpp.
+ */
+
+#ifndef POLYNOMIAL_SOLVER_H
+#define POLYNOMIAL_SOLVER_H
+
+#include "arithmetic.h"
+#include "share_parser.h"
+#include "bigint.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * A share as it appeared in the input document, plus its decoded value
+ */
+struct Share {
+    long long id;       // x coordinate (the JSON key)
+    int base;           // base the value was written in (2-16)
+    std::string value;  // digits exactly as given
+    BigInt exactY;      // decoded value
+    long double y;      // decoded value, rounded to long double
+
+    Share(long long id_val, int base_val, std::string value_val, BigInt exact_y)
+        : id(id_val), base(base_val), value(std::move(value_val)), exactY(std::move(exact_y)),
+          y(exactY.toLongDouble()) {}
+};
+
+enum class DiagnosticLevel {
+    Warning,    // solving continued (e.g. a share was skipped)
+    Error       // solving stopped
+};
+
+struct Diagnostic {
+    DiagnosticLevel level;
+    long long shareId;  // offending share, or 0 when not tied to one
+    std::string message;
+};
+
+/**
+ * Wall time spent in each phase of one solveFromJSON call, in nanoseconds
+ */
+struct SolveTimings {
+    std::uint64_t parseNs = 0;
+    std::uint64_t convertNs = 0;
+    std::uint64_t interpolateNs = 0;
+    std::uint64_t verifyNs = 0;         // range checks on the secret
+    std::uint64_t totalNs = 0;
+};
+
+/**
+ * Work done by one solveFromJSON call
+ */
+struct SolveCounters {
+    std::uint64_t sharesDecoded = 0;    // shares whose value decoded successfully
+    std::uint64_t shareBytes = 0;       // bytes of the share objects located
+    std::uint64_t digitsDecoded = 0;    // digits of successfully decoded values
+    std::uint64_t limbsTouched = 0;     // limbs of the decoded values used and of the exact secret
+};
+
+enum class SolveStatus {
+    Ok,
+    EmptyInput,             // no JSON content at all
+    InvalidKeys,            // n/k missing, non-positive or k > n
+    NotEnoughShares,        // fewer than k shares decoded successfully
+    InterpolationFailed,    // duplicate or degenerate x values
+    MalformedDocument       // syntax error, or not the share schema in strict mode
+};
+
+/**
+ * Everything a caller may want to know about one solve
+ */
+struct SolveResult {
+    SolveStatus status = SolveStatus::Ok;
+    int n = 0;
+    int k = 0;
+
+    long double secret = 0.0L;      // constant term P(0)
+    bool fitsInt64 = false;         // secret representable as long long
+    long long secretInt64 = 0;      // rounded secret, valid when fitsInt64
+    bool exact = false;             // exactSecret holds P(0) exactly
+    BigInt exactSecret;
+
+    std::vector<Share> shares;      // every decoded share, ascending id
+    std::size_t sharesUsed = 0;     // interpolation took the first sharesUsed (k, or all when it never ran)
+    std::vector<Diagnostic> diagnostics;
+    SolveTimings timings;
+    SolveCounters counters;
+
+    bool ok() const { return status == SolveStatus::Ok; }
+
+    /**
+     * Secret as digits in the given base (with leading '-' when negative);
+     * exact when `exact`, otherwise the rounded long double value
+     * @param base: Output base (2-16)
+     */
+    std::string secretString(int base = 10) const;
+
+    /**
+     * Message of the first error diagnostic, or "" when the solve succeeded
+     */
+    std::string errorMessage() const;
+};
+
+/**
+ * Human-readable name of a status, e.g. "not_enough_shares"
+ */
+const char* solveStatusName(SolveStatus status);
+
+/**
+ * A share document parsed and decoded once (PolynomialSolver::buildTape),
+ * so secret and coefficient recovery, verification and evaluation at
+ * other x can all run without reading the JSON again.
+ *
+ * The tape is flat. Per share, in ascending id order, it holds the id, the
+ * base, the digits as a span of the document, and the decoded magnitude as
+ * a span of one limb buffer. Only shares that decoded are on it; the others
+ * are warnings in diagnostics(). The document must outlive the tape's use
+ * of digits(). Building into the same tape again reuses its buffers,
+ * parser state included, and destroying the tape frees them.
+ *
+ * When the document names a prime ("keys": {..., "prime": "<p>"}), the
+ * operations below work modulo it: secrets, coefficients and values are
+ * residues in [0, p), and coefficients always exist.
+ */
+class DocumentTape {
+public:
+    SolveStatus status() const { return status_; }  // Ok, or why the document cannot be solved
+    bool ok() const { return status_ == SolveStatus::Ok; }
+    int n() const { return n_; }
+    int k() const { return k_; }
+    const BigInt& prime() const { return prime_; }  // keys.prime, or zero for shares over the integers
+
+    std::size_t size() const { return ids_.size(); }
+    long long id(std::size_t i) const { return ids_[i]; }
+    int base(std::size_t i) const { return bases_[i]; }
+    std::string_view digits(std::size_t i) const { return source_.substr(digitOffsets_[i], digitLengths_[i]); }
+    BigInt value(std::size_t i) const {
+        return BigInt::fromLimbs(limbTape_.data() + limbOffsets_[i], limbOffsets_[i + 1] - limbOffsets_[i]);
+    }
+
+    /**
+     * value(i) into out, reusing its storage
+     */
+    void value(std::size_t i, BigInt& out) const {
+        out.assignLimbs(limbTape_.data() + limbOffsets_[i], limbOffsets_[i + 1] - limbOffsets_[i]);
+    }
+
+    const std::vector<Diagnostic>& diagnostics() const { return diagnostics_; }
+    const SolveTimings& timings() const { return timings_; }    // parse, convert and their total
+    const SolveCounters& counters() const { return counters_; }
+
+private:
+    friend class PolynomialSolver;
+
+    SolveStatus status_ = SolveStatus::EmptyInput;
+    int n_ = 0;
+    int k_ = 0;
+    BigInt prime_;
+    std::string_view source_;                       // the document built from
+    ShareDocument document_;                        // parser output, capacity reused
+    std::vector<long long> ids_;
+    std::vector<int> bases_;
+    std::vector<std::size_t> digitOffsets_;         // into source_
+    std::vector<std::size_t> digitLengths_;
+    std::vector<BigInt::Limb> limbTape_;
+    std::vector<std::size_t> limbOffsets_ = {0};    // size() + 1 entries
+    std::vector<Diagnostic> diagnostics_;
+    SolveTimings timings_;
+    SolveCounters counters_;
+
+    void clear();
+    void append(long long id, int base, std::size_t digitOffset, std::size_t digitLength, const BigInt& value);
+};
+
+enum class SolvePhase { Parse, Convert, Interpolate, Verify };
+constexpr int kSolvePhaseCount = 4;
+
+/**
+ * Lowercase name of a phase, e.g. "interpolate"
+ */
+const char* solvePhaseName(SolvePhase phase);
+
+/**
+ * Callbacks around the phases of solveFromJSON, for profilers and tracers.
+ * Parse spans the whole share scan; each share's Convert span is nested
+ * inside it. Called on the solving thread; keep them cheap.
+ */
+class SolveObserver {
+public:
+    virtual ~SolveObserver() = default;
+    virtual void phaseBegin(SolvePhase phase) = 0;
+    virtual void phaseEnd(SolvePhase phase) = 0;
+};
+
+/**
+ * Forwards every callback to several observers, in the order added
+ */
+class SolveObserverList : public SolveObserver {
+public:
+    void add(SolveObserver* observer) { observers_.push_back(observer); }
+    bool empty() const { return observers_.empty(); }
+
+    void phaseBegin(SolvePhase phase) override {
+        for (SolveObserver* observer : observers_) observer->phaseBegin(phase);
+    }
+    void phaseEnd(SolvePhase phase) override {
+        for (SolveObserver* observer : observers_) observer->phaseEnd(phase);
+    }
+
+private:
+    std::vector<SolveObserver*> observers_;
+};
+
+/**
+ * Big integer engine behind share decoding and exact interpolation
+ */
+enum class ExactBackend {
+    InTree,     // bigint.h
+    Gmp         // GNU MP (gmp_arithmetic.h), only when built with libgmp
+};
+
+/**
+ * Lowercase name, "bigint" or "gmp"
+ */
+const char* exactBackendName(ExactBackend backend);
+
+/**
+ * Parse a backend name as accepted by --backend
+ * @return: false for an unknown name
+ */
+bool parseExactBackend(const std::string& name, ExactBackend& backend);
+
+class PolynomialSolver {
+public:
+    using Point = BasicPoint<LongDoubleArithmetic>;
+
+    /**
+     * Solve polynomial from JSON input
+     * @param jsonContent: JSON string containing the share set
+     * @return: Structured result; check ok() before reading the secret
+     */
+    SolveResult solveFromJSON(const std::string& jsonContent) const;
+
+    /**
+     * Same as above, but fills a caller-owned result so its vectors keep
+     * their capacity across calls
+     * @param jsonContent: JSON string containing the share set
+     * @param result: Overwritten with the outcome of this solve
+     */
+    void solveFromJSON(const std::string& jsonContent, SolveResult& result) const;
+
+    /**
+     * Same again with a caller-owned tape as well, so repeated solves
+     * allocate nothing once the buffers have grown (used by the C ABI
+     * scratch contexts, server workers and batch loops)
+     * @param tape: Overwritten; holds this document afterwards
+     */
+    void solveFromJSON(const std::string& jsonContent, DocumentTape& tape, SolveResult& result) const;
+
+    /**
+     * Parse and decode a document onto a tape, with this solver's parse
+     * mode, backend and observer (Parse and Convert phases). Failures are
+     * recorded in the tape like solveFromJSON records them in a result.
+     * @param jsonContent: Must outlive the tape's use of digits()
+     * @return: tape.status()
+     */
+    SolveStatus buildTape(const std::string& jsonContent, DocumentTape& tape) const;
+    SolveStatus buildTape(std::string&& jsonContent, DocumentTape& tape) const = delete;
+
+    /**
+     * Secret from the tape's first k shares (Interpolate and Verify
+     * phases); solveFromJSON is buildTape followed by this. Modulo
+     * tape.prime() the in-tree engine is used whatever the backend.
+     * @param result: Overwritten, as by solveFromJSON
+     */
+    void recoverSecret(const DocumentTape& tape, SolveResult& result) const;
+
+    /**
+     * Coefficients a0..a(k-1) of the polynomial through the first k shares
+     * @return: false when some coefficient is not an integer; coefficients
+     *          is then left unchanged
+     * @throws invalid_argument: When the tape is not ok()
+     */
+    bool recoverCoefficients(const DocumentTape& tape, std::vector<BigInt>& coefficients) const;
+
+    /**
+     * P(x) of the polynomial through the first k shares
+     * @return: false when P(x) is not an integer; value is then left unchanged
+     * @throws invalid_argument: When the tape is not ok()
+     */
+    bool evaluateAt(const DocumentTape& tape, long long x, BigInt& value) const;
+
+    /**
+     * Check the shares past the first k against the polynomial through
+     * the first k
+     * @param mismatched: Set to the ids of shares not on it, ascending
+     * @return: Number of shares checked
+     * @throws invalid_argument: When the tape is not ok()
+     */
+    std::size_t verifyShares(const DocumentTape& tape, std::vector<long long>& mismatched) const;
+
+    /**
+     * Report phase boundaries of later solves to the observer (not owned;
+     * nullptr to stop)
+     */
+    void setObserver(SolveObserver* observer) { observer_ = observer; }
+
+    /**
+     * Decode and interpolate later solves with this engine; results are
+     * the same BigInt values whichever engine computed them
+     * @throws invalid_argument: When the backend was not built in
+     */
+    void setBackend(ExactBackend backend);
+    ExactBackend backend() const { return backend_; }
+
+    /**
+     * Whether this build includes the backend (GMP needs libgmp at build time)
+     */
+    static bool backendAvailable(ExactBackend backend);
+
+    /**
+     * How later solves read documents (share_parser.h); lenient by default
+     */
+    void setParseMode(ParseMode mode) { parseMode_ = mode; }
+    ParseMode parseMode() const { return parseMode_; }
+
+    /**
+     * Convert a number from any base (2-16) to decimal
+     * @param value: String representation of the number
+     * @param base: Base of the number system (2-16)
+     * @return: Decimal value as long double for precision
+     * @throws invalid_argument: For invalid input
+     */
+    static long double convertToDecimal(const std::string& value, int base);
+
+    /**
+     * Lagrange interpolation to find polynomial value at x
+     * @param points: Vector of points (x, y)
+     * @param k: Number of points to use for interpolation
+     * @param x: Point to evaluate polynomial at (default: 0 for secret)
+     * @return: Polynomial value at x
+     * @throws invalid_argument: For insufficient points or duplicate x values
+     */
+    static long double lagrangeInterpolation(const std::vector<Point>& points, int k, long double x = 0.0L);
+
+    /**
+     * Exact Lagrange interpolation at x = 0 over the integers
+     * @param shares: Shares to interpolate through (distinct ids)
+     * @param secret: Set to P(0) when it is an integer
+     * @return: false when P(0) is not an integer (shares inconsistent with
+     *          an integer secret); secret is then left unchanged
+     * @throws invalid_argument: For duplicate x values
+     */
+    static bool exactLagrangeInterpolation(const std::vector<Share>& shares, BigInt& secret);
+
+    /**
+     * Lagrange interpolation under an arithmetic policy (arithmetic.h);
+     * lagrangeInterpolation and exactLagrangeInterpolation are the
+     * LongDoubleArithmetic and BigIntArithmetic instantiations
+     * @param points: Points to interpolate through; the first k are used
+     * @param k: Number of points to use
+     * @param x: Point to evaluate the polynomial at
+     * @param result: Set to P(x) on success
+     * @return: false when P(x) is not in an integer policy's domain (not an
+     *          integer); result is then left unchanged
+     * @throws invalid_argument: For k out of range, duplicate x values or a
+     *         divisor the policy cannot invert (ids equal modulo a prime)
+     * @throws overflow_error: When a fixed-width policy overflows
+     */
+    template <class Arithmetic>
+    static bool interpolate(const std::vector<BasicPoint<Arithmetic>>& points, size_t k,
+                            const typename Arithmetic::Value& x, typename Arithmetic::Value& result);
+
+    /**
+     * Same through the first k shares (every share when k is omitted), with
+     * each decoded value mapped by Arithmetic::fromBigInt
+     */
+    template <class Arithmetic>
+    static bool interpolateShares(const std::vector<Share>& shares, size_t k, const typename Arithmetic::Value& x,
+                                  typename Arithmetic::Value& result);
+    template <class Arithmetic>
+    static bool interpolateShares(const std::vector<Share>& shares, const typename Arithmetic::Value& x,
+                                  typename Arithmetic::Value& result) {
+        return interpolateShares<Arithmetic>(shares, shares.size(), x, result);
+    }
+
+private:
+    SolveObserver* observer_ = nullptr;
+    ExactBackend backend_ = ExactBackend::InTree;
+    ParseMode parseMode_ = ParseMode::Lenient;
+};
+
+template <class Arithmetic>
+bool PolynomialSolver::interpolate(const std::vector<BasicPoint<Arithmetic>>& points, size_t k,
+                                   const typename Arithmetic::Value& x, typename Arithmetic::Value& result) {
+    using Value = typename Arithmetic::Value;
+    if (k == 0 || k > points.size()) {
+        throw std::invalid_argument("Invalid k value: " + std::to_string(k));
+    }
+    for (size_t i = 0; i < k; i++) {
+        for (size_t j = i + 1; j < k; j++) {
+            if (points[i].x == points[j].x) {
+                throw std::invalid_argument("Duplicate x values found: " + std::to_string(points[i].x));
+            }
+        }
+    }
+
+    if constexpr (!Arithmetic::kExact) {
+        // Rounded: apply each factor (x - xj) / (xi - xj) in turn so the term stays in range
+        Value sum = Arithmetic::fromInt(0);
+        for (size_t i = 0; i < k; i++) {
+            Value term = points[i].y;
+            Value xi = Arithmetic::fromInt(points[i].x);
+            for (size_t j = 0; j < k; j++) {
+                if (i == j) continue;
+                Value xj = Arithmetic::fromInt(points[j].x);
+                Value factor = x;
+                Arithmetic::sub(factor, xj);
+                Value denominator = xi;
+                Arithmetic::sub(denominator, xj);
+                Arithmetic::div(factor, denominator);
+                Arithmetic::mul(term, factor);
+            }
+            Arithmetic::add(sum, term);
+        }
+        result = sum;
+        return true;
+    }
+
+    std::vector<Value> xs;
+    xs.reserve(k);
+    for (size_t i = 0; i < k; i++) xs.push_back(Arithmetic::fromInt(points[i].x));
+
+    if constexpr (Arithmetic::kField) {
+        // P(x) = Σᵢ yᵢ·Nᵢ/dᵢ with Nᵢ = Πⱼ≠ᵢ(x − xⱼ) and dᵢ = Πⱼ≠ᵢ(xᵢ − xⱼ): one division per point
+        Value sum = Arithmetic::fromInt(0);
+        for (size_t i = 0; i < k; i++) {
+            if (Arithmetic::isZero(points[i].y)) continue;
+            Value term = points[i].y;
+            Value denominator = Arithmetic::fromInt(1);
+            for (size_t j = 0; j < k; j++) {
+                if (i == j) continue;
+                Arithmetic::mulDifference(term, x, xs[j]);
+                Arithmetic::mulDifference(denominator, xs[i], xs[j]);
+            }
+            Arithmetic::div(term, denominator);
+            Arithmetic::add(sum, term);
+        }
+        result = std::move(sum);
+        return true;
+    } else {
+        // Over the integers the sum is kept as numerator/denominator over
+        // lcm(d₁..dᵢ), so the denominator stays small
+        Value numerator = Arithmetic::fromInt(0);
+        Value denominator = Arithmetic::fromInt(1);
+        for (size_t i = 0; i < k; i++) {
+            if (Arithmetic::isZero(points[i].y)) continue;
+            Value term = points[i].y;
+            Value basisDenominator = Arithmetic::fromInt(1);
+            for (size_t j = 0; j < k; j++) {
+                if (i == j) continue;
+                Arithmetic::mulDifference(term, x, xs[j]);
+                Arithmetic::mulDifference(basisDenominator, xs[i], xs[j]);
+            }
+
+            // numerator/denominator + term/basisDenominator over their lcm
+            Value g = Arithmetic::gcd(denominator, basisDenominator);
+            Value scaleOld = Arithmetic::divExact(basisDenominator, g);
+            Value scaleNew = Arithmetic::divExact(denominator, g);
+            Arithmetic::mul(numerator, scaleOld);
+            Arithmetic::mul(term, scaleNew);
+            Arithmetic::add(numerator, term);
+            Arithmetic::mul(scaleNew, basisDenominator);
+            denominator = std::move(scaleNew);
+        }
+
+        // Usually exact; the product check costs one multiplication where long
+        // division would cost (numerator size) x (denominator size)
+        Value quotient = Arithmetic::divExact(numerator, denominator);
+        Value check = quotient;
+        Arithmetic::mul(check, denominator);
+        if (!(check == numerator)) return false;
+        result = std::move(quotient);
+        return true;
+    }
+}
+
+template <class Arithmetic>
+bool PolynomialSolver::interpolateShares(const std::vector<Share>& shares, size_t k,
+                                         const typename Arithmetic::Value& x, typename Arithmetic::Value& result) {
+    std::vector<BasicPoint<Arithmetic>> points;
+    points.reserve(std::min(k, shares.size()));
+    for (size_t i = 0; i < k && i < shares.size(); i++) {
+        points.emplace_back(shares[i].id, Arithmetic::fromBigInt(shares[i].exactY));
+    }
+    return interpolate<Arithmetic>(points, k, x, result);
+}
+
+#endif // POLYNOMIAL_SOLVER_H
@@ -0,0 +1,651 @@
+/**
+ * Polynomial Solver - core library implementation
+ *
+ * Parsing, base conversion and Lagrange interpolation with no console I/O.
+ * See polynomial_solver.h for the public interface.
+ */
+
+#include "polynomial_solver.h"
+#include "gmp_arithmetic.h"
+#include "probes.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <type_traits>
+
+using namespace std;
+
+namespace {
+
+using Clock = chrono::steady_clock;
+
+uint64_t elapsedNs(Clock::time_point since) {
+    return (uint64_t)chrono::duration_cast<chrono::nanoseconds>(Clock::now() - since).count();
+}
+
+/**
+ * Exact value of one share's digits with the selected engine
+ */
+BigInt decodeShare(string_view digits, int base, ExactBackend backend) {
+#ifdef POLYSOLVER_HAVE_GMP
+    if (backend == ExactBackend::Gmp) return GmpArithmetic::decode(digits, base);
+#endif
+    (void)backend;
+    return BigInt::fromString(digits, base);
+}
+
+/**
+ * exactLagrangeInterpolation through the first k shares with the selected engine
+ */
+bool interpolateSecret(const vector<Share>& shares, size_t k, BigInt& secret, ExactBackend backend) {
+#ifdef POLYSOLVER_HAVE_GMP
+    if (backend == ExactBackend::Gmp) {
+        GmpInteger value;
+        if (!PolynomialSolver::interpolateShares<GmpArithmetic>(shares, k, GmpArithmetic::fromInt(0), value)) {
+            return false;
+        }
+        secret = GmpArithmetic::toBigInt(value);
+        return true;
+    }
+#endif
+    (void)backend;
+    return PolynomialSolver::interpolateShares<BigIntArithmetic>(shares, k, BigInt(0), secret);
+}
+
+/**
+ * Leading integer of a share's base text, read as stoi reads it; the text
+ * ends at a quote or delimiter, so strtol stops inside the document
+ */
+int parseBase(const char* text) {
+    char* end;
+    errno = 0;
+    long base = strtol(text, &end, 10);
+    if (end == text) throw invalid_argument("stoi");
+    if (errno == ERANGE || base < INT_MIN || base > INT_MAX) throw out_of_range("stoi");
+    return (int)base;
+}
+
+/**
+ * Overwrite a share in place with the tape's share i, keeping its buffers
+ */
+void assignShare(const DocumentTape& tape, size_t i, Share& share) {
+    share.id = tape.id(i);
+    share.base = tape.base(i);
+    share.value.assign(tape.digits(i));
+    tape.value(i, share.exactY);
+    share.y = share.exactY.toLongDouble();
+}
+
+/**
+ * Least non-negative residue of a modulo m (m > 0)
+ */
+BigInt reduce(const BigInt& a, const BigInt& m) {
+    BigInt quotient, remainder;
+    BigInt::divMod(a, m, quotient, remainder);
+    return remainder.isNegative() ? remainder + m : remainder;
+}
+
+/**
+ * Inverse of a modulo m, by the extended Euclidean algorithm
+ * @throws invalid_argument: When a and m have a common factor, which for
+ *         ids below m means m is not prime
+ */
+BigInt inverseMod(const BigInt& a, const BigInt& m) {
+    BigInt r0 = m, r1 = reduce(a, m), s0(0), s1(1), quotient, remainder;
+    while (!r1.isZero()) {
+        BigInt::divMod(r0, r1, quotient, remainder);
+        r0 = std::move(r1);
+        r1 = std::move(remainder);
+        BigInt s = s0 - quotient * s1;
+        s0 = std::move(s1);
+        s1 = std::move(s);
+    }
+    if (r0 != BigInt(1)) throw invalid_argument("Modulus " + m.toString() + " is not prime");
+    return reduce(s0, m);
+}
+
+/**
+ * P(x) modulo the tape's prime, through its first k shares. The k Lagrange
+ * denominators are inverted together (Montgomery's trick), so one
+ * extended Euclid serves them all.
+ */
+BigInt modularInterpolate(const DocumentTape& tape, long long x) {
+    const BigInt& p = tape.prime();
+    size_t k = (size_t)tape.k();
+
+    // Numerator i is the product of (x - xj) over j != i: prefix times suffix
+    vector<BigInt> suffix(k + 1, BigInt(1));
+    for (size_t j = k; j-- > 0;) suffix[j] = reduce(suffix[j + 1] * (BigInt(x) - BigInt(tape.id(j))), p);
+
+    // Denominator i is the product of (xi - xj); small factors are gathered
+    // for a few limbs before each reduction
+    vector<BigInt> denominators(k), running(k);
+    for (size_t i = 0; i < k; i++) {
+        BigInt d(1);
+        for (size_t j = 0; j < k; j++) {
+            if (j == i) continue;
+            d *= tape.id(i) - tape.id(j);
+            if (d.limbCount() > p.limbCount() + 2) d = reduce(d, p);
+        }
+        denominators[i] = reduce(d, p);
+        running[i] = i > 0 ? reduce(running[i - 1] * denominators[i], p) : denominators[i];
+    }
+
+    BigInt inverse = inverseMod(running[k - 1], p);
+    BigInt prefix(1), sum(0), y;
+    vector<BigInt> terms(k);
+    for (size_t i = k; i-- > 0;) {
+        // inverse is 1 / (d0 * ... * di) here
+        terms[i] = i > 0 ? reduce(inverse * running[i - 1], p) : inverse;
+        inverse = reduce(inverse * denominators[i], p);
+    }
+    for (size_t i = 0; i < k; i++) {
+        tape.value(i, y);
+        sum += reduce(reduce(y * terms[i], p) * reduce(prefix * suffix[i + 1], p), p);
+        prefix = reduce(prefix * (BigInt(x) - BigInt(tape.id(i))), p);
+    }
+    return reduce(sum, p);
+}
+
+void requireSolvable(const DocumentTape& tape) {
+    if (!tape.ok()) {
+        throw invalid_argument(string("Document cannot be solved: ") + solveStatusName(tape.status()));
+    }
+}
+
+/**
+ * P(x) through the tape's first k shares under a policy
+ */
+template <class Arithmetic>
+bool interpolateTape(const DocumentTape& tape, long long x, BigInt& value) {
+    vector<BasicPoint<Arithmetic>> points;
+    points.reserve((size_t)tape.k());
+    for (size_t i = 0; i < (size_t)tape.k(); i++) {
+        if constexpr (is_same<typename Arithmetic::Value, BigInt>::value) {
+            points.emplace_back(tape.id(i), tape.value(i));
+        } else {
+            points.emplace_back(tape.id(i), Arithmetic::fromBigInt(tape.value(i)));
+        }
+    }
+    typename Arithmetic::Value result = Arithmetic::fromInt(0);
+    if (!PolynomialSolver::interpolate<Arithmetic>(points, points.size(), Arithmetic::fromInt(x), result)) {
+        return false;
+    }
+    if constexpr (is_same<typename Arithmetic::Value, BigInt>::value) {
+        value = std::move(result);
+    } else {
+        value = Arithmetic::toBigInt(result);
+    }
+    return true;
+}
+
+/**
+ * The polynomial P through the tape's first k shares, scaled to integers:
+ * D * P(x) = sum of numerators[t] * x^t, with D > 0 the least common
+ * denominator of the Lagrange weights. P need not have integer
+ * coefficients for this to be exact.
+ */
+void scaledPolynomial(const DocumentTape& tape, vector<BigInt>& numerators, BigInt& denominator) {
+    size_t k = (size_t)tape.k();
+
+    // M(x) = product of (x - xj), lowest coefficient first
+    vector<BigInt> product(1, BigInt(1));
+    for (size_t j = 0; j < k; j++) {
+        product.push_back(BigInt(0));
+        for (size_t t = product.size() - 1; t > 0; t--) {
+            product[t] = product[t - 1] - product[t] * tape.id(j);
+        }
+        product[0] *= -tape.id(j);
+    }
+
+    // Lagrange basis i is (M(x) / (x - xi)) / di, di = product of (xi - xj), j != i
+    vector<BigInt> weights(k);
+    denominator = BigInt(1);
+    for (size_t i = 0; i < k; i++) {
+        BigInt di(1);
+        for (size_t j = 0; j < k; j++) {
+            if (j != i) di *= BigInt(tape.id(i)) - BigInt(tape.id(j));
+        }
+        weights[i] = di;
+        BigInt magnitude = di.isNegative() ? -di : di;
+        denominator = BigInt::divExact(denominator, BigInt::gcd(denominator, magnitude)) * magnitude;
+    }
+
+    numerators.assign(k, BigInt(0));
+    vector<BigInt> quotient(k);
+    for (size_t i = 0; i < k; i++) {
+        // Synthetic division of M by (x - xi)
+        quotient[k - 1] = product[k];
+        for (size_t t = k - 1; t > 0; t--) quotient[t - 1] = product[t] + quotient[t] * tape.id(i);
+        BigInt weight = tape.value(i) * BigInt::divExact(denominator, weights[i]);
+        for (size_t t = 0; t < k; t++) numerators[t] += weight * quotient[t];
+    }
+}
+
+} // namespace
+
+const char* exactBackendName(ExactBackend backend) {
+    switch (backend) {
+        case ExactBackend::InTree: return "bigint";
+        case ExactBackend::Gmp:    return "gmp";
+    }
+    return "unknown";
+}
+
+bool parseExactBackend(const string& name, ExactBackend& backend) {
+    if (name == "bigint") { backend = ExactBackend::InTree; return true; }
+    if (name == "gmp")    { backend = ExactBackend::Gmp;    return true; }
+    return false;
+}
+
+bool PolynomialSolver::backendAvailable(ExactBackend backend) {
+#ifdef POLYSOLVER_HAVE_GMP
+    (void)backend;
+    return true;
+#else
+    return backend == ExactBackend::InTree;
+#endif
+}
+
+void PolynomialSolver::setBackend(ExactBackend backend) {
+    if (!backendAvailable(backend)) {
+        throw invalid_argument(string("Backend not built in: ") + exactBackendName(backend));
+    }
+    backend_ = backend;
+}
+
+const char* solveStatusName(SolveStatus status) {
+    switch (status) {
+        case SolveStatus::Ok:                  return "ok";
+        case SolveStatus::EmptyInput:          return "empty_input";
+        case SolveStatus::InvalidKeys:         return "invalid_keys";
+        case SolveStatus::NotEnoughShares:     return "not_enough_shares";
+        case SolveStatus::InterpolationFailed: return "interpolation_failed";
+        case SolveStatus::MalformedDocument:   return "malformed_document";
+    }
+    return "unknown";
+}
+
+const char* solvePhaseName(SolvePhase phase) {
+    switch (phase) {
+        case SolvePhase::Parse:       return "parse";
+        case SolvePhase::Convert:     return "convert";
+        case SolvePhase::Interpolate: return "interpolate";
+        case SolvePhase::Verify:      return "verify";
+    }
+    return "unknown";
+}
+
+string SolveResult::secretString(int base) const {
+    if (exact) return exactSecret.toString(base);
+    if (fitsInt64) return BigInt(secretInt64).toString(base);
+
+    // Largest finite long double has 4933 integer digits
+    char digits[5000];
+    int len = snprintf(digits, sizeof digits, "%.0Lf", secret);
+    string decimal(digits, len > 0 ? (size_t)len : 0);
+    if (base == 10 || decimal.empty()) return decimal;
+
+    bool negative = decimal[0] == '-';
+    BigInt value = BigInt::fromString(negative ? decimal.substr(1) : decimal, 10);
+    return (negative ? -value : value).toString(base);
+}
+
+string SolveResult::errorMessage() const {
+    for (const Diagnostic& d : diagnostics) {
+        if (d.level == DiagnosticLevel::Error) return d.message;
+    }
+    return "";
+}
+
+long double PolynomialSolver::convertToDecimal(const string& value, int base) {
+    if (value.empty() || base < 2 || base > 16) {
+        throw invalid_argument("Invalid base (" + to_string(base) + ") or empty value");
+    }
+
+    long double result = 0.0L;
+    long double power = 1.0L;
+
+    // Process digits from right to left
+    for (int i = (int)value.length() - 1; i >= 0; i--) {
+        char digit = (char)tolower((unsigned char)value[i]);  // Fixed: Convert to lowercase for consistency
+        int digitValue;
+
+        if (digit >= '0' && digit <= '9') {
+            digitValue = digit - '0';
+        } else if (digit >= 'a' && digit <= 'f') {
+            digitValue = digit - 'a' + 10;
+        } else {
+            throw invalid_argument("Invalid character '" + string(1, digit) + "' in number");
+        }
+
+        if (digitValue >= base) {
+            throw invalid_argument("Digit " + to_string(digitValue) + " invalid for base " + to_string(base));
+        }
+
+        result += digitValue * power;
+        power *= base;
+    }
+
+    return result;
+}
+
+long double PolynomialSolver::lagrangeInterpolation(const vector<Point>& points, int k, long double x) {
+    if (k <= 0 || k > (int)points.size()) {
+        throw invalid_argument("Invalid k value: " + to_string(k));
+    }
+    long double result = 0.0L;
+    interpolate<LongDoubleArithmetic>(points, (size_t)k, x, result);
+    return result;
+}
+
+bool PolynomialSolver::exactLagrangeInterpolation(const vector<Share>& shares, BigInt& secret) {
+    if (shares.empty()) {
+        secret = BigInt(0);
+        return true;
+    }
+    return interpolateShares<BigIntArithmetic>(shares, BigInt(0), secret);
+}
+
+SolveResult PolynomialSolver::solveFromJSON(const string& jsonContent) const {
+    SolveResult result;
+    solveFromJSON(jsonContent, result);
+    return result;
+}
+
+void PolynomialSolver::solveFromJSON(const string& jsonContent, SolveResult& result) const {
+    DocumentTape tape;
+    solveFromJSON(jsonContent, tape, result);
+}
+
+void PolynomialSolver::solveFromJSON(const string& jsonContent, DocumentTape& tape, SolveResult& result) const {
+    // Document probes bracket whole solves only, so one tape recovered
+    // several times is not counted as several documents
+    PS_PROBE1(document__start, jsonContent.size());
+    buildTape(jsonContent, tape);
+    recoverSecret(tape, result);
+    PS_PROBE2(document__done, (int)result.status, result.timings.totalNs);
+}
+
+void DocumentTape::clear() {
+    status_ = SolveStatus::Ok;
+    n_ = k_ = 0;
+    prime_ = BigInt();
+    source_ = string_view();
+    ids_.clear();
+    bases_.clear();
+    digitOffsets_.clear();
+    digitLengths_.clear();
+    limbTape_.clear();
+    limbOffsets_.assign(1, 0);
+    diagnostics_.clear();
+    timings_ = SolveTimings();
+    counters_ = SolveCounters();
+}
+
+void DocumentTape::append(long long id, int base, size_t digitOffset, size_t digitLength, const BigInt& value) {
+    ids_.push_back(id);
+    bases_.push_back(base);
+    digitOffsets_.push_back(digitOffset);
+    digitLengths_.push_back(digitLength);
+    limbTape_.insert(limbTape_.end(), value.limbs().begin(), value.limbs().end());
+    limbOffsets_.push_back(limbTape_.size());
+}
+
+SolveStatus PolynomialSolver::buildTape(const string& jsonContent, DocumentTape& tape) const {
+    Clock::time_point start = Clock::now();
+    tape.clear();
+    tape.source_ = jsonContent;
+
+    SolveObserver* observer = observer_;
+    if (observer) observer->phaseBegin(SolvePhase::Parse);
+
+    auto fail = [&](SolveStatus status, const string& message) {
+        tape.status_ = status;
+        tape.diagnostics_.push_back({DiagnosticLevel::Error, 0, message});
+        tape.timings_.totalNs = elapsedNs(start);
+        return status;
+    };
+
+    if (jsonContent.empty()) {
+        if (observer) observer->phaseEnd(SolvePhase::Parse);
+        return fail(SolveStatus::EmptyInput, "Empty JSON content");
+    }
+
+    // One pass over the document, into buffers the tape keeps
+    ShareDocument& document = tape.document_;
+    if (!parseShareDocument(jsonContent, parseMode_, document)) {
+        if (observer) observer->phaseEnd(SolvePhase::Parse);
+        return fail(SolveStatus::MalformedDocument, "Malformed document: " + document.error);
+    }
+    tape.n_ = document.n;
+    tape.k_ = document.k;
+    int n = tape.n_;
+    int k = tape.k_;
+
+    if (n <= 0 || k <= 0 || k > n) {  // Fixed: Added k > n check
+        if (observer) observer->phaseEnd(SolvePhase::Parse);
+        return fail(SolveStatus::InvalidKeys,
+                    "Invalid n=" + to_string(n) + " or k=" + to_string(k) + " (k must be ≤ n)");
+    }
+    if (document.primeLength > 0) {
+        // Ids 1..n must stay distinct modulo the prime
+        string_view text = tape.source_.substr(document.primeOffset, document.primeLength);
+        bool valid = false;
+        try {
+            tape.prime_ = BigInt::fromString(text, 10);
+            valid = BigInt(n) < tape.prime_;
+        } catch (const invalid_argument&) {
+        }
+        if (!valid) {
+            if (observer) observer->phaseEnd(SolvePhase::Parse);
+            return fail(SolveStatus::InvalidKeys, "Invalid prime '" + string(text) + "' (must be a decimal above n)");
+        }
+    }
+
+    // Decoding each share is timed as Convert, nested inside Parse; the
+    // two clocks are accumulated separately.
+    uint64_t convertNs = 0;
+
+    for (const ParsedShare& parsed : document.shares) {
+        if (parsed.id > n) break;
+        long long i = parsed.id;
+        tape.counters_.shareBytes += parsed.objectLength;
+
+        if (parsed.baseLength > 0 && parsed.valueLength > 0) {
+            if (observer) observer->phaseBegin(SolvePhase::Convert);
+            Clock::time_point convertStart = Clock::now();
+            string_view digits = tape.source_.substr(parsed.valueOffset, parsed.valueLength);
+            int base = 0;
+            bool decoded = false;
+            try {
+                base = parseBase(jsonContent.c_str() + parsed.baseOffset);
+                tape.append(i, base, parsed.valueOffset, parsed.valueLength, decodeShare(digits, base, backend_));
+                tape.counters_.sharesDecoded++;
+                tape.counters_.digitsDecoded += digits.size();
+                decoded = true;
+            } catch (const exception& e) {
+                tape.diagnostics_.push_back({DiagnosticLevel::Warning, i,
+                                             "Skipping point " + to_string(i) + " - " + e.what()});
+            }
+            uint64_t shareNs = elapsedNs(convertStart);
+            convertNs += shareNs;
+            PS_PROBE5(share__convert, i, base, digits.size(), shareNs, decoded);
+            if (observer) observer->phaseEnd(SolvePhase::Convert);
+        }
+    }
+
+    tape.timings_.convertNs = convertNs;
+    tape.timings_.parseNs = elapsedNs(start) - convertNs;
+    if (observer) observer->phaseEnd(SolvePhase::Parse);
+
+    if ((int)tape.size() < k) {
+        return fail(SolveStatus::NotEnoughShares,
+                    "Not enough valid points (" + to_string(tape.size()) + " found, " + to_string(k) +
+                    " required)");
+    }
+    tape.timings_.totalNs = elapsedNs(start);
+    return SolveStatus::Ok;
+}
+
+void PolynomialSolver::recoverSecret(const DocumentTape& tape, SolveResult& result) const {
+    Clock::time_point start = Clock::now();
+
+    result.status = tape.status();
+    result.n = tape.n();
+    result.k = tape.k();
+    result.secret = 0.0L;
+    result.fitsInt64 = false;
+    result.secretInt64 = 0;
+    result.exact = false;
+    result.exactSecret = BigInt();
+    result.diagnostics = tape.diagnostics();
+    result.timings = tape.timings();
+    result.counters = tape.counters();
+
+    // Every decoded share is reported but only the first k are interpolated;
+    // shares already in the result are overwritten in place so their buffers
+    // are reused
+    result.sharesUsed = tape.ok() ? (size_t)tape.k() : tape.size();
+    vector<Share>& shares = result.shares;
+    if (shares.size() > tape.size()) shares.erase(shares.begin() + (ptrdiff_t)tape.size(), shares.end());
+    for (size_t i = 0; i < tape.size(); i++) {
+        if (i < shares.size()) {
+            assignShare(tape, i, shares[i]);
+        } else {
+            shares.emplace_back(tape.id(i), tape.base(i), string(tape.digits(i)), tape.value(i));
+        }
+    }
+
+    auto done = [&] { result.timings.totalNs = tape.timings().totalNs + elapsedNs(start); };
+    if (!tape.ok()) {
+        done();
+        return;
+    }
+
+    SolveObserver* observer = observer_;
+    int k = tape.k();
+    if (observer) observer->phaseBegin(SolvePhase::Interpolate);
+    PS_PROBE1(interpolate__start, k);
+    Clock::time_point interpolateStart = Clock::now();
+    try {
+        if (!tape.prime().isZero()) {
+            result.exactSecret = modularInterpolate(tape, 0);
+            result.exact = true;
+        } else {
+            result.exact = interpolateSecret(result.shares, result.sharesUsed, result.exactSecret, backend_);
+        }
+        if (result.exact) {
+            result.secret = result.exactSecret.toLongDouble();
+        } else {
+            // Not an integer: fall back to the rounded floating point value
+            vector<Point> points;
+            points.reserve(result.sharesUsed);
+            for (size_t i = 0; i < result.sharesUsed; i++) {
+                points.push_back(Point(result.shares[i].id, result.shares[i].y));
+            }
+            result.secret = lagrangeInterpolation(points, k, 0.0L);
+            result.diagnostics.push_back({DiagnosticLevel::Warning, 0,
+                                          "Secret is not an integer; reporting rounded value"});
+        }
+    } catch (const exception& e) {
+        result.timings.interpolateNs = elapsedNs(interpolateStart);
+        if (observer) observer->phaseEnd(SolvePhase::Interpolate);
+        PS_PROBE3(interpolate__done, k, false, result.timings.interpolateNs);
+        result.status = SolveStatus::InterpolationFailed;
+        result.diagnostics.push_back({DiagnosticLevel::Error, 0, e.what()});
+        done();
+        return;
+    }
+    result.timings.interpolateNs = elapsedNs(interpolateStart);
+    if (observer) observer->phaseEnd(SolvePhase::Interpolate);
+    PS_PROBE3(interpolate__done, k, result.exact, result.timings.interpolateNs);
+    for (size_t i = 0; i < result.sharesUsed; i++) result.counters.limbsTouched += result.shares[i].exactY.limbCount();
+    result.counters.limbsTouched += result.exactSecret.limbCount();
+
+    // Report overflow explicitly instead of folding it into a sentinel value
+    if (observer) observer->phaseBegin(SolvePhase::Verify);
+    Clock::time_point verifyStart = Clock::now();
+    if (result.exact) {
+        result.fitsInt64 = result.exactSecret.fitsInt64();
+        if (result.fitsInt64) {
+            result.secretInt64 = result.exactSecret.toInt64();
+        } else {
+            result.diagnostics.push_back({DiagnosticLevel::Warning, 0, "Result exceeds long long range"});
+        }
+    } else if (result.secret >= (long double)LLONG_MIN && result.secret <= (long double)LLONG_MAX) {
+        result.fitsInt64 = true;
+        result.secretInt64 = llroundl(result.secret);
+    } else {
+        result.diagnostics.push_back({DiagnosticLevel::Warning, 0, "Result exceeds long long range"});
+    }
+    result.timings.verifyNs = elapsedNs(verifyStart);
+    if (observer) observer->phaseEnd(SolvePhase::Verify);
+    done();
+}
+
+bool PolynomialSolver::recoverCoefficients(const DocumentTape& tape, vector<BigInt>& coefficients) const {
+    requireSolvable(tape);
+    vector<BigInt> numerators;
+    BigInt denominator;
+    scaledPolynomial(tape, numerators, denominator);
+
+    const BigInt& p = tape.prime();
+    if (!p.isZero()) {
+        // Modulo a prime every coefficient is a residue; D is invertible
+        BigInt inverse = inverseMod(denominator, p);
+        for (BigInt& numerator : numerators) numerator = reduce(numerator * inverse, p);
+        coefficients = std::move(numerators);
+        return true;
+    }
+
+    vector<BigInt> exact(numerators.size());
+    BigInt remainder;
+    for (size_t t = 0; t < numerators.size(); t++) {
+        BigInt::divMod(numerators[t], denominator, exact[t], remainder);
+        if (!remainder.isZero()) return false;
+    }
+    coefficients = std::move(exact);
+    return true;
+}
+
+bool PolynomialSolver::evaluateAt(const DocumentTape& tape, long long x, BigInt& value) const {
+    requireSolvable(tape);
+    if (!tape.prime().isZero()) {
+        value = modularInterpolate(tape, x);
+        return true;
+    }
+#ifdef POLYSOLVER_HAVE_GMP
+    if (backend_ == ExactBackend::Gmp) return interpolateTape<GmpArithmetic>(tape, x, value);
+#endif
+    return interpolateTape<BigIntArithmetic>(tape, x, value);
+}
+
+size_t PolynomialSolver::verifyShares(const DocumentTape& tape, vector<long long>& mismatched) const {
+    requireSolvable(tape);
+    vector<BigInt> numerators;
+    BigInt denominator;
+    scaledPolynomial(tape, numerators, denominator);
+
+    // D * y must equal D * P(x), evaluated by Horner
+    mismatched.clear();
+    BigInt y;
+    for (size_t i = (size_t)tape.k(); i < tape.size(); i++) {
+        BigInt scaled = numerators.back();
+        for (size_t t = numerators.size() - 1; t-- > 0;) {
+            scaled *= tape.id(i);
+            scaled += numerators[t];
+        }
+        tape.value(i, y);
+        y *= denominator;
+        bool on = tape.prime().isZero() ? scaled == y : reduce(scaled - y, tape.prime()).isZero();
+        if (!on) mismatched.push_back(tape.id(i));
+    }
+    return tape.size() - (size_t)tape.k();
+}
@@ -0,0 +1,126 @@
+/**
+ * Polynomial Solver - C ABI (libpolysolver.so)
+ *
+ * Stable C interface over the solver core for in-process callers (Python
+ * ctypes/cffi, Go cgo, ...). No C++ types or exceptions cross this boundary.
+ *
+ * Handles:
+ *   ps_solver  - solver configuration; immutable after creation, so one
+ *                handle may be shared by any number of threads
+ *   ps_scratch - per-call working memory and the last result; reuse one per
+ *                thread to avoid allocating on every request. A scratch must
+ *                not be used by two threads at the same time.
+ *
+ * Typical use:
+ *   ps_solver* solver = ps_solver_create();
+ *   ps_scratch* scratch = ps_scratch_create();
+ *   ps_result result;
+ *   if (ps_solve(solver, scratch, json, json_len, &result) == PS_OK) {
+ *       char secret[128];
+ *       ps_scratch_secret(scratch, secret, sizeof secret, NULL);
+ *   }
+ *   ps_scratch_free(scratch);
+ *   ps_solver_free(solver);
+ */
+
+#ifndef POLYSOLVER_H
+#define POLYSOLVER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#define PS_API __declspec(dllexport)
+#else
+#define PS_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bumped only on incompatible changes to the functions or structs below */
+#define PS_ABI_VERSION 1
+
+typedef enum ps_status {
+    PS_OK = 0,
+    PS_ERR_EMPTY_INPUT = 1,         /* no JSON content at all */
+    PS_ERR_INVALID_KEYS = 2,        /* n/k missing, non-positive or k > n */
+    PS_ERR_NOT_ENOUGH_SHARES = 3,   /* fewer than k shares decoded */
+    PS_ERR_INTERPOLATION = 4,       /* duplicate or degenerate x values */
+    PS_ERR_INVALID_ARGUMENT = 5,    /* NULL handle or pointer */
+    PS_ERR_BUFFER_TOO_SMALL = 6,    /* output truncated; see *needed */
+    PS_ERR_OUT_OF_MEMORY = 7,
+    PS_ERR_INTERNAL = 8,
+    PS_ERR_MALFORMED = 9            /* not a share document; the error text has the byte offset */
+} ps_status;
+
+typedef struct ps_solver ps_solver;
+typedef struct ps_scratch ps_scratch;
+
+/**
+ * Fixed-size summary of one solve. Variable-length data (secret digits,
+ * error text, shares) is copied out of the scratch into caller buffers.
+ */
+typedef struct ps_result {
+    int32_t n;
+    int32_t k;
+    int32_t fits_int64;         /* secret_int64 is valid */
+    int32_t warnings;           /* number of warning diagnostics */
+    int64_t secret_int64;
+    double secret;              /* approximate; use ps_scratch_secret for digits */
+    uint64_t shares_used;
+    uint64_t parse_ns;
+    uint64_t convert_ns;
+    uint64_t interpolate_ns;
+    uint64_t total_ns;
+} ps_result;
+
+typedef struct ps_share {
+    int64_t id;                 /* x coordinate */
+    int32_t base;
+    int32_t reserved;
+    double y;                   /* decoded value (approximate) */
+} ps_share;
+
+PS_API uint32_t ps_abi_version(void);
+PS_API const char* ps_status_string(ps_status status);
+
+PS_API ps_solver* ps_solver_create(void);
+PS_API void ps_solver_free(ps_solver* solver);
+
+PS_API ps_scratch* ps_scratch_create(void);
+PS_API void ps_scratch_free(ps_scratch* scratch);
+
+/**
+ * Solve one share document. json need not be NUL-terminated.
+ * The full result stays in scratch until the next ps_solve on it.
+ * out may be NULL when only the scratch accessors are wanted.
+ */
+PS_API ps_status ps_solve(const ps_solver* solver, ps_scratch* scratch,
+                          const char* json, size_t json_len, ps_result* out);
+
+/**
+ * Copy the last secret as decimal digits (NUL-terminated) into buf.
+ * On PS_ERR_BUFFER_TOO_SMALL nothing is written; *needed (if non-NULL)
+ * always receives the required size including the terminator. Returns the
+ * status of the last ps_solve when that solve did not succeed.
+ */
+PS_API ps_status ps_scratch_secret(const ps_scratch* scratch, char* buf, size_t buf_len, size_t* needed);
+
+/**
+ * Copy the last error message (NUL-terminated, "" on success) into buf.
+ * Same sizing contract as ps_scratch_secret.
+ */
+PS_API ps_status ps_scratch_error(const ps_scratch* scratch, char* buf, size_t buf_len, size_t* needed);
+
+/**
+ * Copy up to capacity used shares into shares; *count receives the total.
+ */
+PS_API ps_status ps_scratch_shares(const ps_scratch* scratch, ps_share* shares, size_t capacity, size_t* count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* POLYSOLVER_H */
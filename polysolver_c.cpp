@@ -0,0 +1,171 @@
+/**
+ * Polynomial Solver - C ABI implementation
+ *
+ * Thin adapter from polysolver.h onto PolynomialSolver. Every entry point
+ * catches C++ exceptions and maps them onto ps_status codes.
+ */
+
+#include "polysolver.h"
+#include "polynomial_solver.h"
+
+#include <cstring>
+#include <new>
+#include <string>
+
+using namespace std;
+
+struct ps_solver {
+    PolynomialSolver solver;
+};
+
+struct ps_scratch {
+    string input;           // copy of the caller's bytes, capacity reused
+    DocumentTape tape;      // parse and decode buffers for input
+    SolveResult result;     // vectors reused across solves
+    string secretDigits;
+    ps_status lastStatus = PS_ERR_INVALID_ARGUMENT;
+};
+
+namespace {
+
+ps_status toStatus(SolveStatus status) {
+    switch (status) {
+        case SolveStatus::Ok:                  return PS_OK;
+        case SolveStatus::EmptyInput:          return PS_ERR_EMPTY_INPUT;
+        case SolveStatus::InvalidKeys:         return PS_ERR_INVALID_KEYS;
+        case SolveStatus::NotEnoughShares:     return PS_ERR_NOT_ENOUGH_SHARES;
+        case SolveStatus::InterpolationFailed: return PS_ERR_INTERPOLATION;
+        case SolveStatus::MalformedDocument:   return PS_ERR_MALFORMED;
+    }
+    return PS_ERR_INTERNAL;
+}
+
+/**
+ * Copy text plus terminator into a caller buffer, or report the size needed
+ */
+ps_status copyOut(const string& text, char* buf, size_t bufLen, size_t* needed) {
+    if (needed) *needed = text.size() + 1;
+    if (!buf || bufLen < text.size() + 1) return PS_ERR_BUFFER_TOO_SMALL;
+    memcpy(buf, text.data(), text.size());
+    buf[text.size()] = '\0';
+    return PS_OK;
+}
+
+} // namespace
+
+extern "C" {
+
+uint32_t ps_abi_version(void) {
+    return PS_ABI_VERSION;
+}
+
+const char* ps_status_string(ps_status status) {
+    switch (status) {
+        case PS_OK:                    return "ok";
+        case PS_ERR_EMPTY_INPUT:       return "empty input";
+        case PS_ERR_INVALID_KEYS:      return "invalid n/k keys";
+        case PS_ERR_NOT_ENOUGH_SHARES: return "not enough valid shares";
+        case PS_ERR_INTERPOLATION:     return "interpolation failed";
+        case PS_ERR_INVALID_ARGUMENT:  return "invalid argument";
+        case PS_ERR_BUFFER_TOO_SMALL:  return "buffer too small";
+        case PS_ERR_OUT_OF_MEMORY:     return "out of memory";
+        case PS_ERR_INTERNAL:          return "internal error";
+        case PS_ERR_MALFORMED:         return "malformed document";
+    }
+    return "unknown status";
+}
+
+ps_solver* ps_solver_create(void) {
+    return new (nothrow) ps_solver();
+}
+
+void ps_solver_free(ps_solver* solver) {
+    delete solver;
+}
+
+ps_scratch* ps_scratch_create(void) {
+    return new (nothrow) ps_scratch();
+}
+
+void ps_scratch_free(ps_scratch* scratch) {
+    delete scratch;
+}
+
+ps_status ps_solve(const ps_solver* solver, ps_scratch* scratch,
+                   const char* json, size_t json_len, ps_result* out) {
+    if (!solver || !scratch || (!json && json_len > 0)) return PS_ERR_INVALID_ARGUMENT;
+
+    try {
+        scratch->input.assign(json ? json : "", json_len);
+        solver->solver.solveFromJSON(scratch->input, scratch->tape, scratch->result);
+
+        const SolveResult& result = scratch->result;
+        scratch->lastStatus = toStatus(result.status);
+        scratch->secretDigits = result.ok() ? result.secretString() : string();
+
+        if (out) {
+            int32_t warnings = 0;
+            for (const Diagnostic& d : result.diagnostics) {
+                if (d.level == DiagnosticLevel::Warning) warnings++;
+            }
+            out->n = result.n;
+            out->k = result.k;
+            out->fits_int64 = result.fitsInt64 ? 1 : 0;
+            out->warnings = warnings;
+            out->secret_int64 = result.fitsInt64 ? result.secretInt64 : 0;
+            out->secret = (double)result.secret;
+            out->shares_used = result.sharesUsed;
+            out->parse_ns = result.timings.parseNs;
+            out->convert_ns = result.timings.convertNs;
+            out->interpolate_ns = result.timings.interpolateNs;
+            out->total_ns = result.timings.totalNs;
+        }
+        return scratch->lastStatus;
+    } catch (const bad_alloc&) {
+        scratch->lastStatus = PS_ERR_OUT_OF_MEMORY;
+    } catch (...) {
+        scratch->lastStatus = PS_ERR_INTERNAL;
+    }
+    return scratch->lastStatus;
+}
+
+ps_status ps_scratch_secret(const ps_scratch* scratch, char* buf, size_t buf_len, size_t* needed) {
+    if (!scratch) return PS_ERR_INVALID_ARGUMENT;
+    if (scratch->lastStatus != PS_OK) {
+        if (needed) *needed = 0;
+        return scratch->lastStatus;
+    }
+    return copyOut(scratch->secretDigits, buf, buf_len, needed);
+}
+
+ps_status ps_scratch_error(const ps_scratch* scratch, char* buf, size_t buf_len, size_t* needed) {
+    if (!scratch) return PS_ERR_INVALID_ARGUMENT;
+    try {
+        string message = scratch->result.errorMessage();
+        if (message.empty() && scratch->lastStatus != PS_OK) {
+            message = ps_status_string(scratch->lastStatus);
+        }
+        return copyOut(message, buf, buf_len, needed);
+    } catch (...) {
+        return PS_ERR_OUT_OF_MEMORY;
+    }
+}
+
+ps_status ps_scratch_shares(const ps_scratch* scratch, ps_share* shares, size_t capacity, size_t* count) {
+    if (!scratch || (!shares && capacity > 0)) return PS_ERR_INVALID_ARGUMENT;
+
+    const vector<Share>& decoded = scratch->result.shares;
+    size_t used = scratch->result.sharesUsed;
+    if (count) *count = used;
+
+    size_t copied = capacity < used ? capacity : used;
+    for (size_t i = 0; i < copied; i++) {
+        shares[i].id = decoded[i].id;
+        shares[i].base = decoded[i].base;
+        shares[i].reserved = 0;
+        shares[i].y = (double)decoded[i].y;
+    }
+    return copied < used ? PS_ERR_BUFFER_TOO_SMALL : PS_OK;
+}
+
+} // extern "C"
@@ -0,0 +1,52 @@
+/**
+ * Polynomial Solver - USDT static probes
+ *
+ * Statically defined tracepoints on the solver hot paths, for bpftrace,
+ * perf and SystemTap on live processes. A disabled probe is a single nop
+ * in the instruction stream, so they stay compiled in. Without
+ * <sys/sdt.h> (systemtap-sdt-dev), or with -DPOLYSOLVER_NO_USDT, the
+ * macros expand to nothing.
+ *
+ * Provider "polysolver":
+ *   document__start(bytes)                     solveFromJSON entered
+ *   document__done(status, total_ns)           solveFromJSON returning
+ *   share__convert(id, base, digits, ns, ok)   one share value decoded
+ *   interpolate__start(k)
+ *   interpolate__done(k, exact, ns)            also when interpolation throws
+ *   power__cache__hit(base, level)             chunk power reused
+ *   power__cache__miss(base, level)            chunk power computed
+ *
+ * The document probes bracket solveFromJSON only. buildTape and
+ * recoverSecret called directly fire the others but no document__start or
+ * document__done, so one tape recovered several times is not counted as
+ * several documents.
+ *
+ * e.g. bpftrace -e 'usdt:./polynomial_solver:polysolver:document__done
+ *                   { @ns = hist(arg1); }'
+ */
+
+#ifndef PROBES_H
+#define PROBES_H
+
+#if !defined(POLYSOLVER_NO_USDT) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define POLYSOLVER_HAVE_USDT 1
+#endif
+#endif
+
+#ifdef POLYSOLVER_HAVE_USDT
+#define PS_PROBE1(name, a) DTRACE_PROBE1(polysolver, name, a)
+#define PS_PROBE2(name, a, b) DTRACE_PROBE2(polysolver, name, a, b)
+#define PS_PROBE3(name, a, b, c) DTRACE_PROBE3(polysolver, name, a, b, c)
+#define PS_PROBE5(name, a, b, c, d, e) DTRACE_PROBE5(polysolver, name, a, b, c, d, e)
+#else
+// sizeof keeps the arguments "used" without evaluating them
+#define PS_PROBE1(name, a) do { (void)sizeof(a); } while (0)
+#define PS_PROBE2(name, a, b) do { (void)sizeof(a); (void)sizeof(b); } while (0)
+#define PS_PROBE3(name, a, b, c) do { (void)sizeof(a); (void)sizeof(b); (void)sizeof(c); } while (0)
+#define PS_PROBE5(name, a, b, c, d, e) \
+    do { (void)sizeof(a); (void)sizeof(b); (void)sizeof(c); (void)sizeof(d); (void)sizeof(e); } while (0)
+#endif
+
+#endif // PROBES_H
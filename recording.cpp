@@ -0,0 +1,123 @@
+/**
+ * Polynomial Solver - workload capture and replay implementation
+ */
+
+#include "recording.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+using namespace std;
+
+namespace {
+
+const char kSegmentMagic[8] = {'P', 'S', 'R', 'E', 'C', '1', '\0', '\0'};
+const char kDocumentTag = 'D';
+const uint64_t kMaxDocumentBytes = 1ULL << 32;
+
+uint64_t wallClockNs() {
+    return (uint64_t)chrono::duration_cast<chrono::nanoseconds>(
+        chrono::system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+WorkloadRecorder::WorkloadRecorder(const string& path)
+    : out_(path, ios::binary | ios::app), lastNs_(wallClockNs()) {
+    if (!out_.is_open()) throw runtime_error("Cannot write recording: " + path);
+    out_.write(kSegmentMagic, sizeof kSegmentMagic);
+    for (int byte = 0; byte < 8; byte++) out_.put((char)(lastNs_ >> (8 * byte)));
+}
+
+void WorkloadRecorder::writeVarint(uint64_t value) {
+    while (value >= 0x80) {
+        out_.put((char)(value | 0x80));
+        value >>= 7;
+    }
+    out_.put((char)value);
+}
+
+void WorkloadRecorder::record(const string& document, uint64_t stream) {
+    lock_guard<mutex> lock(mutex_);
+    // The wall clock can step back; a log never does
+    uint64_t now = max(wallClockNs(), lastNs_);
+    out_.put(kDocumentTag);
+    writeVarint(now - lastNs_);
+    writeVarint(stream);
+    writeVarint(document.size());
+    out_.write(document.data(), (streamsize)document.size());
+    lastNs_ = now;
+}
+
+bool WorkloadRecorder::finish() {
+    lock_guard<mutex> lock(mutex_);
+    out_.flush();
+    return (bool)out_;
+}
+
+WorkloadReplay::WorkloadReplay(const string& path, double speed)
+    : in_(path, ios::binary), path_(path), speed_(speed) {
+    if (!in_.is_open()) throw runtime_error("Cannot read recording: " + path);
+    if (in_.peek() != kSegmentMagic[0]) throw runtime_error("Not a recording: " + path);
+}
+
+bool WorkloadReplay::readVarint(uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int byte = in_.get();
+        if (byte == EOF) return false;
+        value |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+void WorkloadReplay::readSegmentHeader() {
+    char magic[sizeof kSegmentMagic];
+    unsigned char start[8];
+    if (!in_.read(magic, sizeof magic) || memcmp(magic, kSegmentMagic, sizeof magic) != 0 ||
+        !in_.read(reinterpret_cast<char*>(start), sizeof start)) {
+        throw runtime_error("Corrupt recording (bad segment header): " + path_);
+    }
+    clockNs_ = 0;
+    for (int byte = 0; byte < 8; byte++) clockNs_ |= (uint64_t)start[byte] << (8 * byte);
+}
+
+bool WorkloadReplay::next(RecordedDocument& document) {
+    for (;;) {
+        int tag = in_.peek();
+        if (tag == EOF) return false;
+        if (tag == kSegmentMagic[0]) {
+            readSegmentHeader();
+            continue;
+        }
+        if (tag != kDocumentTag) throw runtime_error("Corrupt recording (unknown record): " + path_);
+        in_.get();
+
+        uint64_t gap, length;
+        if (!readVarint(gap) || !readVarint(document.stream) || !readVarint(length) ||
+            length > kMaxDocumentBytes) {
+            throw runtime_error("Corrupt recording (bad record header): " + path_);
+        }
+        document.document.resize((size_t)length);
+        if (length > 0 && !in_.read(&document.document[0], (streamsize)length)) {
+            throw runtime_error("Truncated recording: " + path_);
+        }
+        clockNs_ += gap;
+        offsetNs_ += gap;
+        document.arrivalNs = clockNs_;
+        return true;
+    }
+}
+
+chrono::steady_clock::time_point WorkloadReplay::due() {
+    if (!started_) {
+        started_ = true;
+        firstOffsetNs_ = offsetNs_;
+        origin_ = chrono::steady_clock::now();
+    }
+    if (speed_ <= 0.0) return origin_;
+    double offsetNs = (double)(offsetNs_ - firstOffsetNs_) / speed_;
+    return origin_ + chrono::nanoseconds((long long)offsetNs);
+}
@@ -0,0 +1,97 @@
+/**
+ * Polynomial Solver - workload capture and replay (--record, --replay)
+ *
+ * --record appends every document the CLI or the server receives, with its
+ * arrival time, to a compact binary log; --replay feeds a log back at the
+ * recorded pace (or faster), so an incident can be reproduced byte for
+ * byte against another build.
+ *
+ * Log layout: one segment per recording run, so runs can be appended.
+ *   segment: the 8-byte magic "PSREC1\0\0", then u64 start time (ns since
+ *            the Unix epoch, little-endian)
+ *   record:  'D', then LEB128 varints gapNs (since the previous record of
+ *            the segment, or its start), stream (connection, 0 outside
+ *            --serve) and length, then length document bytes
+ */
+
+#ifndef RECORDING_H
+#define RECORDING_H
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+
+struct RecordedDocument {
+    std::uint64_t arrivalNs = 0;    // since the Unix epoch
+    std::uint64_t stream = 0;
+    std::string document;
+};
+
+class WorkloadRecorder {
+public:
+    /**
+     * Open the log for appending and start a segment
+     * @throws runtime_error: When the file cannot be opened
+     */
+    explicit WorkloadRecorder(const std::string& path);
+
+    /**
+     * Append one document, stamped with the current time. Thread-safe.
+     */
+    void record(const std::string& document, std::uint64_t stream = 0);
+
+    /**
+     * Flush everything to the file
+     * @return: false when a write failed
+     */
+    bool finish();
+
+private:
+    void writeVarint(std::uint64_t value);
+
+    std::mutex mutex_;
+    std::ofstream out_;
+    std::uint64_t lastNs_;
+};
+
+class WorkloadReplay {
+public:
+    /**
+     * @param speed: Replay this many times faster than recorded; 0 replays
+     *               back to back with no pauses
+     * @throws runtime_error: When the file cannot be read or is not a log
+     */
+    WorkloadReplay(const std::string& path, double speed);
+
+    /**
+     * Read the next document
+     * @return: false at the end of the log
+     * @throws runtime_error: For a truncated or corrupt log
+     */
+    bool next(RecordedDocument& document);
+
+    /**
+     * When the document last returned by next() is due: its offset from
+     * the first document, divided by the speed, counted from the first call
+     * to due(). Appended runs follow each other directly; the time between
+     * the runs is not replayed.
+     */
+    std::chrono::steady_clock::time_point due();
+
+private:
+    bool readVarint(std::uint64_t& value);
+    void readSegmentHeader();
+
+    std::ifstream in_;
+    std::string path_;
+    double speed_;
+    std::uint64_t clockNs_ = 0;     // arrival of the last record read
+    std::uint64_t offsetNs_ = 0;    // its replay offset: record gaps summed over every segment
+    bool started_ = false;
+    std::uint64_t firstOffsetNs_ = 0;
+    std::chrono::steady_clock::time_point origin_;
+};
+
+#endif // RECORDING_H
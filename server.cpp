@@ -0,0 +1,554 @@
+/**
+ * Polynomial Solver - server mode implementation
+ */
+
+#include "server.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <poll.h>
+#include <sstream>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace {
+
+uint64_t nanosBetween(chrono::steady_clock::time_point from, chrono::steady_clock::time_point to) {
+    return to > from ? (uint64_t)chrono::duration_cast<chrono::nanoseconds>(to - from).count() : 0;
+}
+
+sockaddr_un unixAddress(const string& path) {
+    sockaddr_un address;
+    memset(&address, 0, sizeof address);
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof address.sun_path) {
+        throw runtime_error("Invalid socket path: '" + path + "'");
+    }
+    memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return address;
+}
+
+/**
+ * Bound, listening Unix stream socket at path
+ * @throws runtime_error: When the path is taken by a live server or by
+ *                        something that is not a socket, or binding fails
+ */
+int listenUnix(const string& path) {
+    sockaddr_un address = unixAddress(path);
+    struct stat info;
+    if (lstat(path.c_str(), &info) == 0) {
+        if (!S_ISSOCK(info.st_mode)) throw runtime_error("Not a socket, refusing to replace: " + path);
+        int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        bool live = probe >= 0 && connect(probe, (const sockaddr*)&address, sizeof address) == 0;
+        if (probe >= 0) close(probe);
+        if (live) throw runtime_error("Another server is listening on " + path);
+        unlink(path.c_str());
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (fd < 0) throw runtime_error(string("Cannot create socket: ") + strerror(errno));
+    if (::bind(fd, (const sockaddr*)&address, sizeof address) != 0 || listen(fd, SOMAXCONN) != 0) {
+        string error = strerror(errno);
+        close(fd);
+        throw runtime_error("Cannot listen on " + path + ": " + error);
+    }
+    return fd;
+}
+
+} // namespace
+
+/**
+ * One client. The connection thread owns the read side; the reply side is
+ * shared by the workers under the mutex. Workers format replies into the
+ * outbox and send what the socket takes without blocking; the connection
+ * thread sends the rest once the client reads. The socket closes when the
+ * client has hung up and the last reply has been sent.
+ */
+struct SolveServer::Connection {
+    Connection(int fd_val, uint64_t id_val, string label_val, const ServerConfig& config, ServerMetrics& metrics_ref)
+        : fd(fd_val), id(id_val), label(std::move(label_val)), metrics(metrics_ref),
+          writer(new OutputWriter(outbox, config.format, 1 << 16)) {
+        writer->setSecretBase(config.secretBase);
+        metrics.connectionOpened();
+    }
+
+    ~Connection() {
+        close(fd);
+        metrics.connectionClosed();
+    }
+
+    /**
+     * Send as much of the outbox as the socket takes right now; with
+     * replyMutex held. A client that has gone away marks the connection
+     * broken and stops being read.
+     */
+    void sendOutbox() {
+        size_t sent = 0;
+        while (!broken && sent < outbox.size()) {
+            ssize_t written = ::write(fd, outbox.data() + sent, outbox.size() - sent);
+            if (written > 0) {
+                sent += (size_t)written;
+            } else if (written < 0 && errno == EAGAIN) {
+                break;
+            } else if (written >= 0 || errno != EINTR) {
+                broken = true;
+            }
+        }
+        if (broken) {
+            outbox.clear();
+            shutdown(fd, SHUT_RD);      // the connection thread sees end of file
+        } else {
+            outbox.erase(0, sent);
+        }
+    }
+
+    struct Pending {
+        SolveResult result;
+        uint64_t line;
+        chrono::steady_clock::time_point received;
+        chrono::steady_clock::time_point solved;    // since when it waits for an earlier reply
+    };
+
+    int fd;
+    uint64_t id;                // stream number in recordings
+    string label;
+    ServerMetrics& metrics;
+
+    // Thread reading the client only
+    string partial;             // bytes after the last newline
+    uint64_t lines = 0;
+    uint64_t documents = 0;
+    bool reading = true;        // until end of file or a read error
+
+    mutex replyMutex;           // guards everything below
+    string outbox;              // replies the socket has not taken yet
+    unique_ptr<OutputWriter> writer;
+    uint64_t nextReply = 0;
+    map<uint64_t, Pending> waiting;     // solved ahead of an earlier document
+    bool broken = false;        // client went away; replies are dropped
+    bool hungUp = false;        // reading is over, so documents is final
+};
+
+SolveServer::SolveServer(const ServerConfig& config)
+    : config_(config),
+      metrics_(config.workers > 0 ? config.workers : max(1, (int)thread::hardware_concurrency())) {
+    config_.workers = metrics_.workerCount();
+    if (config_.queueLimit == 0) config_.queueLimit = 1024 * (size_t)config_.workers;
+    if (config_.metricsIntervalMs < 1) config_.metricsIntervalMs = 1;
+    try {
+        if (pipe2(wakePipe_, O_CLOEXEC | O_NONBLOCK) != 0) {
+            throw runtime_error(string("Cannot create pipe: ") + strerror(errno));
+        }
+        listenFd_ = listenUnix(config_.socketPath);
+        if (!config_.metricsSocket.empty()) metricsFd_ = listenUnix(config_.metricsSocket);
+    } catch (...) {
+        closeSockets();
+        throw;
+    }
+}
+
+SolveServer::~SolveServer() {
+    {
+        lock_guard<mutex> lock(mutex_);
+        draining_ = true;
+    }
+    queued_.notify_all();
+    for (thread& worker : workers_) {
+        if (worker.joinable()) worker.join();
+    }
+    closeSockets();
+}
+
+void SolveServer::closeSockets() {
+    if (listenFd_ >= 0) {
+        close(listenFd_);
+        unlink(config_.socketPath.c_str());
+        listenFd_ = -1;
+    }
+    if (metricsFd_ >= 0) {
+        close(metricsFd_);
+        unlink(config_.metricsSocket.c_str());
+        metricsFd_ = -1;
+    }
+    for (int& fd : wakePipe_) {
+        if (fd >= 0) close(fd);
+        fd = -1;
+    }
+}
+
+const ServerMetrics& SolveServer::metrics() const {
+    return metrics_;
+}
+
+void SolveServer::stop() {
+    stopping_.store(true);
+    wake();
+}
+
+void SolveServer::wake() {
+    ssize_t written = write(wakePipe_[1], "x", 1);
+    (void)written;      // a full pipe already holds a wake-up
+}
+
+string SolveServer::renderMetrics() {
+    lock_guard<mutex> lock(exportMutex_);
+    ostringstream out;
+    metrics_.writePrometheus(out, scrapeWindow_);
+    return out.str();
+}
+
+void SolveServer::run() {
+    // A client that hangs up early must cost its replies, not the process
+    signal(SIGPIPE, SIG_IGN);
+    for (int i = 0; i < config_.workers; i++) workers_.emplace_back(&SolveServer::workerLoop, this, i);
+
+    chrono::milliseconds interval(config_.metricsIntervalMs);
+    chrono::steady_clock::time_point nextExport = chrono::steady_clock::now() + interval;
+    vector<pollfd> fds;
+    for (;;) {
+        fds.clear();
+        fds.push_back({wakePipe_[0], POLLIN, 0});
+        fds.push_back({listenFd_, POLLIN, 0});
+        if (metricsFd_ >= 0) fds.push_back({metricsFd_, POLLIN, 0});
+        size_t firstClient = fds.size();
+
+        // Past the queue limit clients are not read, so they block in write;
+        // the same goes for one client whose unread replies pile up
+        bool full;
+        {
+            lock_guard<mutex> lock(mutex_);
+            full = queue_.size() >= config_.queueLimit;
+        }
+        for (auto entry = connections_.begin(); entry != connections_.end();) {
+            Connection& connection = *entry->second;
+            short events = 0;
+            bool backlog, done;
+            {
+                lock_guard<mutex> lock(connection.replyMutex);
+                if (!connection.outbox.empty()) events |= POLLOUT;
+                backlog = connection.outbox.size() >= kOutboxLimit;
+                done = connection.hungUp && connection.nextReply == connection.documents &&
+                       connection.outbox.empty();
+            }
+            if (done) {
+                entry = connections_.erase(entry);
+                continue;
+            }
+            if (connection.reading && !full && !backlog) events |= POLLIN;
+            if (events) fds.push_back({entry->first, events, 0});
+            ++entry;
+        }
+        int timeout = full ? 10 : -1;
+        if (!config_.metricsFile.empty()) {
+            auto wait = chrono::duration_cast<chrono::milliseconds>(nextExport - chrono::steady_clock::now());
+            int untilExport = (int)max<long long>(0, wait.count());
+            timeout = timeout < 0 ? untilExport : min(timeout, untilExport);
+        }
+
+        if (poll(fds.data(), fds.size(), timeout) < 0 && errno != EINTR) {
+            throw runtime_error(string("poll failed: ") + strerror(errno));
+        }
+        if (fds[0].revents) {
+            // stop(), or a worker that left replies in an outbox
+            char drained[64];
+            while (read(wakePipe_[0], drained, sizeof drained) > 0) {}
+            if (stopping_.load()) break;
+        }
+        if (fds[1].revents) acceptClient();
+        if (metricsFd_ >= 0 && fds[2].revents) serveScrape();
+        for (size_t i = firstClient; i < fds.size(); i++) {
+            if (!fds[i].revents) continue;
+            const shared_ptr<Connection>& connection = connections_.at(fds[i].fd);
+            if (fds[i].revents & (POLLOUT | POLLERR | POLLHUP)) {
+                lock_guard<mutex> lock(connection->replyMutex);
+                connection->sendOutbox();
+            }
+            if (connection->reading && (fds[i].revents & (POLLIN | POLLERR | POLLHUP)) &&
+                !readClient(connection)) {
+                connection->reading = false;
+                lock_guard<mutex> lock(connection->replyMutex);
+                connection->hungUp = true;
+            }
+        }
+        if (!config_.metricsFile.empty() && chrono::steady_clock::now() >= nextExport) {
+            rewriteMetricsFile();
+            nextExport = max(nextExport + interval, chrono::steady_clock::now());
+        }
+    }
+
+    // Stop reading; queued documents still get their replies
+    {
+        lock_guard<mutex> lock(mutex_);
+        draining_ = true;
+    }
+    queued_.notify_all();
+    for (thread& worker : workers_) worker.join();
+    workers_.clear();
+    drainConnections();
+    connections_.clear();
+    if (!config_.metricsFile.empty()) rewriteMetricsFile();
+    closeSockets();
+}
+
+void SolveServer::drainConnections() {
+    chrono::steady_clock::time_point deadline = chrono::steady_clock::now() + kDrainTimeout;
+    vector<pollfd> fds;
+    for (;;) {
+        fds.clear();
+        for (const auto& entry : connections_) {
+            lock_guard<mutex> lock(entry.second->replyMutex);
+            if (!entry.second->outbox.empty()) fds.push_back({entry.first, POLLOUT, 0});
+        }
+        auto left = chrono::duration_cast<chrono::milliseconds>(deadline - chrono::steady_clock::now());
+        if (fds.empty() || left.count() <= 0) return;
+        if (poll(fds.data(), fds.size(), (int)left.count()) < 0 && errno != EINTR) return;
+        for (const pollfd& ready : fds) {
+            if (!ready.revents) continue;
+            Connection& connection = *connections_.at(ready.fd);
+            lock_guard<mutex> lock(connection.replyMutex);
+            connection.sendOutbox();
+        }
+    }
+}
+
+void SolveServer::acceptClient() {
+    for (;;) {
+        // Non-blocking, so a client that stops reading never holds up a worker
+        int fd = accept4(listenFd_, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            return;     // EAGAIN: no more pending; anything else: retry on the next poll
+        }
+        uint64_t id = nextConnection_++;
+        connections_[fd] = make_shared<Connection>(fd, id, "client" + to_string(id), config_, metrics_);
+    }
+}
+
+bool SolveServer::readClient(const shared_ptr<Connection>& connection) {
+    char buffer[1 << 16];
+    ssize_t got = read(connection->fd, buffer, sizeof buffer);
+    if (got < 0) return errno == EINTR || errno == EAGAIN;
+    if (got == 0) {
+        // Like --batch, a last line without a newline is still a document
+        if (!connection->partial.empty()) enqueue(connection, std::move(connection->partial));
+        return false;
+    }
+
+    string& partial = connection->partial;
+    partial.append(buffer, (size_t)got);
+    size_t start = 0;
+    for (size_t newline; (newline = partial.find('\n', start)) != string::npos; start = newline + 1) {
+        enqueue(connection, partial.substr(start, newline - start));
+    }
+    partial.erase(0, start);
+    return true;
+}
+
+void SolveServer::enqueue(const shared_ptr<Connection>& connection, string line) {
+    connection->lines++;
+    if (line.find_first_not_of(" \t\r") == string::npos) return;
+    metrics_.received(line.size());
+    if (recorder_) recorder_->record(line, connection->id);
+
+    Job job;
+    job.connection = connection;
+    job.sequence = connection->documents++;
+    job.line = connection->lines;
+    job.document = std::move(line);
+    job.received = chrono::steady_clock::now();
+    {
+        lock_guard<mutex> lock(mutex_);
+        queue_.push_back(std::move(job));
+    }
+    queued_.notify_one();
+}
+
+void SolveServer::serveScrape() {
+    int fd = accept4(metricsFd_, nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd < 0) return;
+    // A scraper that never reads must not stall the connection thread
+    timeval timeout = {1, 0};
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof timeout);
+    string text = renderMetrics();
+    const char* data = text.data();
+    size_t left = text.size();
+    while (left > 0) {
+        ssize_t written = write(fd, data, left);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) break;
+        data += written;
+        left -= (size_t)written;
+    }
+    close(fd);
+}
+
+void SolveServer::rewriteMetricsFile() {
+    string text;
+    {
+        lock_guard<mutex> lock(exportMutex_);
+        ostringstream out;
+        metrics_.writePrometheus(out, fileWindow_);
+        text = out.str();
+    }
+    // Readers see the old file or the new one, never half of one
+    string temporary = config_.metricsFile + ".tmp";
+    ofstream file(temporary, ios::trunc);
+    file << text;
+    file.close();
+    bool ok = file && rename(temporary.c_str(), config_.metricsFile.c_str()) == 0;
+    if (!ok && !metricsFileFailed_) cerr << "Cannot write metrics: " << config_.metricsFile << endl;
+    metricsFileFailed_ = !ok;
+}
+
+void SolveServer::workerLoop(int index) {
+    WorkerMetrics& worker = metrics_.worker(index);
+    PolynomialSolver solver;
+    solver.setBackend(config_.backend);
+    solver.setParseMode(config_.parseMode);
+    DocumentTape tape;
+    SolveResult result;
+    TraceWriter* trace = config_.trace;
+    unique_ptr<TracePhaseObserver> tracePhases;
+    if (trace) {
+        trace->nameThread("worker " + to_string(index));     // as labelled in the metrics
+        tracePhases.reset(new TracePhaseObserver(*trace));
+        solver.setObserver(tracePhases.get());
+    }
+    for (;;) {
+        Job job;
+        {
+            unique_lock<mutex> lock(mutex_);
+            queued_.wait(lock, [&] { return !queue_.empty() || draining_; });
+            if (queue_.empty()) return;
+            job = std::move(queue_.front());
+            queue_.pop_front();
+        }
+
+        bumpCounter(worker.started);
+        chrono::steady_clock::time_point dequeued = chrono::steady_clock::now();
+        uint64_t queueNs = nanosBetween(job.received, dequeued);
+        worker.latency[(int)ServerStage::QueueWait].record(queueNs);
+        uint64_t traceStart = trace ? trace->now() : 0;
+        solver.solveFromJSON(job.document, tape, result);
+        worker.latency[(int)ServerStage::Parse].record(result.timings.parseNs + result.timings.convertNs);
+        worker.latency[(int)ServerStage::Solve].record(result.timings.interpolateNs + result.timings.verifyNs);
+
+        // The cache is per thread, so its lifetime counts are this worker's
+        BigInt::PowerCacheCounts lookups = BigInt::powerCacheCounts();
+        worker.cacheHits.store(lookups.hits, memory_order_relaxed);
+        worker.cacheMisses.store(lookups.misses, memory_order_relaxed);
+
+        if (!trace) {
+            reply(job, result, worker);
+            continue;
+        }
+        // The result may move into the connection's waiting replies
+        string args = string("\"status\":\"") + solveStatusName(result.status) + "\",\"n\":" +
+                      to_string(result.n) + ",\"k\":" + to_string(result.k) + ",\"bytes\":" +
+                      to_string(job.document.size()) + ",\"queue_ns\":" + to_string(queueNs);
+        string source = job.connection->label + ":" + to_string(job.line);
+        uint64_t replyStart = trace->now();
+        reply(job, result, worker);
+        uint64_t end = trace->now();
+        trace->complete("output", "phase", replyStart, end);
+        trace->complete(source, "document", traceStart, end, args);
+    }
+}
+
+void SolveServer::reply(Job& job, SolveResult& result, WorkerMetrics& worker) {
+    Connection& connection = *job.connection;
+    lock_guard<mutex> lock(connection.replyMutex);
+    if (job.sequence != connection.nextReply) {
+        connection.waiting.emplace(job.sequence, Connection::Pending{std::move(result), job.line, job.received,
+                                                                     chrono::steady_clock::now()});
+        return;
+    }
+
+    // This reply, then every later one that was only waiting for it
+    vector<chrono::steady_clock::time_point> received;
+    auto write = [&](const SolveResult& solved, uint64_t line, chrono::steady_clock::time_point arrived) {
+        if (!connection.broken) {
+            try {
+                connection.writer->writeResult(connection.label + ":" + to_string(line), solved);
+            } catch (const exception&) {
+                connection.broken = true;
+            }
+        }
+        connection.nextReply++;
+        bumpCounter(worker.completed);
+        if (!solved.ok()) bumpCounter(worker.failures);
+        received.push_back(arrived);
+    };
+    write(result, job.line, job.received);
+    for (auto it = connection.waiting.begin();
+         it != connection.waiting.end() && it->first == connection.nextReply; it = connection.waiting.erase(it)) {
+        TraceWriter* trace = config_.trace;
+        uint64_t waitNs = nanosBetween(it->second.solved, chrono::steady_clock::now());
+        uint64_t writeStart = trace ? trace->now() : 0;
+        write(it->second.result, it->second.line, it->second.received);
+        if (trace) {
+            trace->complete(connection.label + ":" + to_string(it->second.line), "reorder", writeStart,
+                            trace->now(), "\"wait_ns\":" + to_string(waitNs));
+        }
+    }
+
+    if (!connection.broken) {
+        connection.writer->flush();     // into the outbox
+        connection.sendOutbox();
+    }
+    // The connection thread sends the rest, or closes a finished connection
+    if (!connection.outbox.empty() || (connection.hungUp && connection.nextReply == connection.documents)) {
+        wake();
+    }
+
+    chrono::steady_clock::time_point now = chrono::steady_clock::now();
+    for (chrono::steady_clock::time_point arrived : received) {
+        worker.latency[(int)ServerStage::Total].record(nanosBetween(arrived, now));
+    }
+}
+
+void SolveServer::replay(WorkloadReplay& log) {
+    int fd = dup(STDOUT_FILENO);
+    if (fd < 0) throw runtime_error(string("Cannot duplicate stdout: ") + strerror(errno));
+    shared_ptr<Connection> connection = make_shared<Connection>(fd, 0, "replay", config_, metrics_);
+
+    RecordedDocument document;
+    while (!stopping_.load() && log.next(document)) {
+        // Short naps so stop() is not held up by a long recorded pause
+        chrono::steady_clock::time_point due = log.due();
+        for (chrono::steady_clock::time_point now; !stopping_.load() && (now = chrono::steady_clock::now()) < due;) {
+            this_thread::sleep_for(min<chrono::steady_clock::duration>(due - now, chrono::milliseconds(50)));
+        }
+        // A replay faster than the workers waits like a client would
+        for (;;) {
+            {
+                lock_guard<mutex> lock(mutex_);
+                if (queue_.size() < config_.queueLimit) break;
+            }
+            if (stopping_.load()) return;
+            this_thread::sleep_for(chrono::milliseconds(1));
+        }
+        // Blank lines were never recorded, so this enqueues every document
+        enqueue(connection, std::move(document.document));
+    }
+
+    for (;;) {
+        {
+            lock_guard<mutex> lock(connection->replyMutex);
+            if (connection->nextReply == connection->documents) break;
+        }
+        if (stopping_.load()) break;    // run() drains what is left
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+}
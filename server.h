@@ -0,0 +1,161 @@
+/**
+ * Polynomial Solver - long-running server mode (--serve)
+ *
+ * Listens on a Unix stream socket. Clients write share documents, one
+ * JSON document per line, and read one result per document back in the
+ * order they were sent (same record layouts as --format). A single
+ * connection thread accepts clients and splits their lines into a shared
+ * queue; a pool of worker threads, each with its own PolynomialSolver,
+ * solves them and writes the replies.
+ *
+ * Client sockets are non-blocking. A worker sends what the socket takes and
+ * leaves the rest to the connection thread, so a client that stops reading
+ * holds up only itself: once kOutboxLimit bytes of its replies are unsent,
+ * the server stops reading from it too.
+ *
+ * Metrics (see metrics.h) can be scraped in Prometheus text format from a
+ * second Unix socket (every connection gets one exposition, then EOF) and
+ * be rewritten to a file at a fixed interval, e.g. for node_exporter's
+ * textfile collector. The file is replaced atomically by a rename.
+ *
+ * A --record log captures every document as it arrives, and replay()
+ * feeds one back through the same queue and workers.
+ *
+ * With a trace (trace.h) every worker gets a track named after its metrics
+ * label, holding one document event per job (its queue wait in the args)
+ * with the solver phases and the reply nested in it. A reply written by a
+ * later worker, because an earlier line was still being solved, shows up
+ * there as a "reorder" event with the time it waited.
+ */
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "metrics.h"
+#include "output_writer.h"
+#include "recording.h"
+#include "trace.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct ServerConfig {
+    std::string socketPath;
+    int workers = 0;                        // 0: one per hardware thread
+    OutputFormat format = OutputFormat::NDJSON;
+    int secretBase = 10;
+    std::size_t queueLimit = 0;             // documents waiting; 0: 1024 per worker
+    std::string metricsSocket;              // empty: no scrape socket
+    std::string metricsFile;                // empty: no metrics file
+    int metricsIntervalMs = 1000;           // metrics file rewrite period
+    ExactBackend backend = ExactBackend::InTree;
+    ParseMode parseMode = ParseMode::Lenient;
+    TraceWriter* trace = nullptr;           // timeline of every job (not owned); null: none
+};
+
+class SolveServer {
+public:
+    /**
+     * Bind the sockets, replacing stale socket files but never one a live
+     * server still answers on
+     * @throws runtime_error: When a socket cannot be created or bound
+     */
+    explicit SolveServer(const ServerConfig& config);
+    ~SolveServer();
+
+    SolveServer(const SolveServer&) = delete;
+    SolveServer& operator=(const SolveServer&) = delete;
+
+    /**
+     * Start the workers and serve until stop(); then stop reading, answer
+     * every complete line already received (clients get kDrainTimeout to
+     * take the replies) and remove the socket files
+     * @throws runtime_error: When poll(2) fails
+     */
+    void run();
+
+    /**
+     * Ask run() (and replay()) to return. Async-signal-safe, callable from
+     * any thread.
+     */
+    void stop();
+
+    /**
+     * Append every document received from now on to a recording (not
+     * owned); call before run()
+     */
+    void setRecorder(WorkloadRecorder* recorder) { recorder_ = recorder; }
+
+    /**
+     * Feed a recording through the queue at its pace, as one more client
+     * whose replies go to stdout, while run() serves on another thread.
+     * Returns once every replayed document is answered, or after stop().
+     * @throws runtime_error: For a corrupt recording
+     */
+    void replay(WorkloadReplay& log);
+
+    const ServerMetrics& metrics() const;
+
+    /**
+     * One Prometheus exposition, as the scrape socket would send it
+     */
+    std::string renderMetrics();
+
+    static constexpr std::size_t kOutboxLimit = 1 << 22;    // unsent reply bytes per client
+    static constexpr std::chrono::milliseconds kDrainTimeout{1000};
+
+private:
+    struct Connection;
+
+    struct Job {
+        std::shared_ptr<Connection> connection;    // kept open until every reply is written
+        std::uint64_t sequence = 0;                 // reply order on the connection
+        std::uint64_t line = 0;                     // 1-based, for the source label
+        std::string document;
+        std::chrono::steady_clock::time_point received;
+    };
+
+    void acceptClient();
+    bool readClient(const std::shared_ptr<Connection>& connection);
+    void enqueue(const std::shared_ptr<Connection>& connection, std::string line);
+    void serveScrape();
+    void rewriteMetricsFile();
+    void workerLoop(int index);
+    void reply(Job& job, SolveResult& result, WorkerMetrics& worker);
+    void wake();
+    void drainConnections();
+    void closeSockets();
+
+    ServerConfig config_;
+    ServerMetrics metrics_;
+    int listenFd_ = -1;
+    int metricsFd_ = -1;
+    int wakePipe_[2] = {-1, -1};
+
+    std::mutex mutex_;                          // guards queue_ and draining_
+    std::condition_variable queued_;
+    std::deque<Job> queue_;
+    bool draining_ = false;
+    std::vector<std::thread> workers_;
+
+    std::map<int, std::shared_ptr<Connection>> connections_;   // by fd, still being read
+    std::uint64_t nextConnection_ = 1;
+    WorkloadRecorder* recorder_ = nullptr;
+    std::atomic<bool> stopping_{false};
+    std::mutex exportMutex_;                    // renderMetrics() may race the file writer
+    LatencySnapshot scrapeWindow_[kServerStageCount];
+    LatencySnapshot fileWindow_[kServerStageCount];
+    bool metricsFileFailed_ = false;            // report a failing file once, not every interval
+};
+
+#endif // SERVER_H
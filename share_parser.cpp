@@ -0,0 +1,360 @@
+/**
+ * Polynomial Solver - share document parser implementation
+ */
+
+#include "share_parser.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+using namespace std;
+
+namespace {
+
+// Object the cursor is in
+enum class Context { Root, Keys, Share };
+
+// What comes next inside it
+enum class State { Open, Key, Colon, Value, Next, Done };
+
+// Member whose value comes next
+enum class Field { Keys, Share, N, K, Prime, Base, Value, Skip };
+
+class ShareDocumentParser {
+public:
+    ShareDocumentParser(const string& json, ParseMode mode, ShareDocument& document)
+        : text_(json.data()), size_(json.size()), strict_(mode == ParseMode::Strict), document_(document) {}
+
+    bool run() {
+        Field field = Field::Skip;
+        size_t memberStart = 0;     // opening quote of the current key, for strict errors
+        bool empty = false;         // no member read yet in the current object
+
+        for (;;) {
+            skipSpace();
+            if (state_ == State::Done) {
+                return !strict_ || pos_ == size_ || fail("end of document");
+            }
+            if (pos_ == size_) return fail(state_ == State::Open ? "'{'" : "more input");
+            char c = text_[pos_];
+
+            switch (state_) {
+                case State::Open:
+                    if (c != '{') return fail("'{'");
+                    pos_++;
+                    state_ = State::Key;
+                    empty = true;
+                    break;
+
+                case State::Key: {
+                    if (c == '}' && (!strict_ || empty)) {
+                        // Empty object, or a lenient trailing comma
+                        if (!closeObject()) return false;
+                        break;
+                    }
+                    memberStart = pos_;
+                    empty = false;
+                    size_t start = 0, length = 0;
+                    if (!readString(start, length)) return false;
+                    field = classify(text_ + start, length);
+                    if (field == Field::Share) share_.keyOffset = memberStart;
+                    if (strict_) {
+                        bool* seen = field == Field::Keys ? &sawKeys_ : field == Field::N ? &sawN_
+                                   : field == Field::K ? &sawK_ : field == Field::Prime ? &sawPrime_
+                                   : field == Field::Base ? &sawBase_ : field == Field::Value ? &sawValue_
+                                   : nullptr;
+                        if (field == Field::Skip || (seen && *seen)) {
+                            pos_ = memberStart;
+                            return fail(field != Field::Skip ? "no repeated member"
+                                        : context_ == Context::Root ? "\"keys\" or a share id"
+                                        : context_ == Context::Keys ? "\"n\", \"k\" or \"prime\""
+                                                                    : "\"base\" or \"value\"");
+                        }
+                    }
+                    state_ = State::Colon;
+                    break;
+                }
+
+                case State::Colon:
+                    if (c != ':') return fail("':'");
+                    pos_++;
+                    state_ = State::Value;
+                    break;
+
+                case State::Value:
+                    state_ = State::Next;
+                    if (field == Field::Keys || field == Field::Share) {
+                        if (c != '{') {
+                            if (strict_) return fail("'{'");
+                            if (!skipValue()) return false;
+                            break;
+                        }
+                        pos_++;
+                        empty = true;
+                        if (field == Field::Keys) {
+                            sawKeys_ = true;
+                            context_ = Context::Keys;
+                        } else {
+                            shareStart_ = pos_ - 1;
+                            sawBase_ = sawValue_ = false;
+                            context_ = Context::Share;
+                        }
+                        state_ = State::Key;
+                    } else if (field == Field::N || field == Field::K) {
+                        bool& seen = field == Field::N ? sawN_ : sawK_;
+                        int& target = field == Field::N ? document_.n : document_.k;
+                        if (c >= '0' && c <= '9') {
+                            size_t start = pos_;
+                            int value = readInteger();
+                            if (pos_ < size_ && isNumberChar(text_[pos_])) {
+                                // Fraction or exponent: the integer part counts, as before
+                                if (strict_) return fail("a plain integer");
+                                while (pos_ < size_ && isNumberChar(text_[pos_])) pos_++;
+                            }
+                            if (strict_ && value < 0) {
+                                pos_ = start;
+                                return fail("an integer below 2^31");
+                            }
+                            if (!seen) target = value;
+                        } else {
+                            if (strict_) return fail("a plain integer");
+                            if (!skipValue()) return false;
+                        }
+                        seen = true;
+                    } else if (field == Field::Base || field == Field::Value || field == Field::Prime) {
+                        size_t start = 0, length = 0;
+                        if (c == '"') {
+                            if (!readString(start, length)) return false;
+                        } else if (!strict_ && isNumberChar(c)) {
+                            start = pos_;
+                            while (pos_ < size_ && isNumberChar(text_[pos_])) pos_++;
+                            length = pos_ - start;
+                        } else {
+                            if (strict_) return fail("a string");
+                            if (!skipValue()) return false;
+                            break;
+                        }
+                        if (field != Field::Value && strict_ &&
+                            (length == 0 || !all_of(text_ + start, text_ + start + length,
+                                                    [](char d) { return d >= '0' && d <= '9'; }))) {
+                            pos_ = start;
+                            return fail(field == Field::Base ? "a decimal base" : "a decimal prime");
+                        }
+                        if (field == Field::Prime) {
+                            if (!sawPrime_) {
+                                document_.primeOffset = start;
+                                document_.primeLength = length;
+                            }
+                            sawPrime_ = true;
+                        } else if (field == Field::Base) {
+                            share_.baseOffset = start;
+                            share_.baseLength = length;
+                            sawBase_ = true;
+                        } else {
+                            share_.valueOffset = start;
+                            share_.valueLength = length;
+                            sawValue_ = true;
+                        }
+                    } else if (!skipValue()) {
+                        return false;
+                    }
+                    break;
+
+                case State::Next:
+                    if (c == ',') {
+                        pos_++;
+                        state_ = State::Key;
+                    } else if (c == '}') {
+                        if (!closeObject()) return false;
+                    } else {
+                        return fail("',' or '}'");
+                    }
+                    break;
+
+                case State::Done:
+                    break;
+            }
+        }
+    }
+
+private:
+    const char* text_;
+    size_t size_;
+    bool strict_;
+    ShareDocument& document_;
+    size_t pos_ = 0;
+    Context context_ = Context::Root;
+    State state_ = State::Open;
+    ParsedShare share_ = {};        // share being read
+    size_t shareStart_ = 0;         // its '{'
+    bool sawKeys_ = false, sawN_ = false, sawK_ = false, sawPrime_ = false, sawBase_ = false, sawValue_ = false;
+
+    static bool isNumberChar(char c) {
+        return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+    }
+
+    bool fail(const char* expected) {
+        document_.errorOffset = pos_;
+        document_.error = string("expected ") + expected + " at byte " + to_string(pos_);
+        return false;
+    }
+
+    void skipSpace() {
+        for (; pos_ < size_; pos_++) {
+            char c = text_[pos_];
+            if (c != ' ' && c != '\n' && c != '\r' && c != '\t') break;
+        }
+    }
+
+    /**
+     * Member key or value string at pos_; leaves pos_ past the closing quote
+     */
+    bool readString(size_t& start, size_t& length) {
+        if (text_[pos_] != '"') return fail("'\"'");
+        start = pos_ + 1;
+        const char* close = (const char*)memchr(text_ + start, '"', size_ - start);
+        if (!close) return fail("a closing '\"'");
+        const char* escape = (const char*)memchr(text_ + start, '\\', (size_t)(close - text_) - start);
+        if (escape) {
+            if (strict_) {
+                pos_ = (size_t)(escape - text_);
+                return fail("a string without escapes");
+            }
+            size_t i = (size_t)(escape - text_);
+            while (i < size_ && text_[i] != '"') i += text_[i] == '\\' ? 2 : 1;
+            if (i >= size_) return fail("a closing '\"'");
+            close = text_ + i;
+        }
+        length = (size_t)(close - text_) - start;
+        pos_ = (size_t)(close - text_) + 1;
+        return true;
+    }
+
+    /**
+     * Leading decimal digits at pos_, -1 past INT_MAX (as stoi failing did)
+     */
+    int readInteger() {
+        long long value = 0;
+        for (; pos_ < size_ && text_[pos_] >= '0' && text_[pos_] <= '9'; pos_++) {
+            if (value <= INT_MAX) value = value * 10 + (text_[pos_] - '0');
+        }
+        return value <= INT_MAX ? (int)value : -1;
+    }
+
+    /**
+     * Step over any value (lenient mode only): string, number, literal,
+     * or an object or array of those
+     */
+    bool skipValue() {
+        int depth = 0;
+        do {
+            skipSpace();
+            if (pos_ == size_) return fail("a value");
+            char c = text_[pos_];
+            size_t start = 0, length = 0;
+            if (c == '"') {
+                if (!readString(start, length)) return false;
+            } else if (c == '{' || c == '[') {
+                depth++;
+                pos_++;
+            } else if (c == '}' || c == ']') {
+                if (depth == 0) return fail("a value");
+                depth--;
+                pos_++;
+            } else if (c == ',' || c == ':') {
+                if (depth == 0) return fail("a value");
+                pos_++;
+            } else if (isNumberChar(c) || (c >= 'a' && c <= 'z')) {
+                // Numbers and the literals true, false and null
+                while (pos_ < size_ && (isNumberChar(text_[pos_]) || (text_[pos_] >= 'a' && text_[pos_] <= 'z'))) {
+                    pos_++;
+                }
+            } else {
+                return fail("a value");
+            }
+        } while (depth > 0);
+        return true;
+    }
+
+    /**
+     * What a member key names in this context; share ids are decimal
+     * without leading zeros, as the solver writes them
+     */
+    Field classify(const char* key, size_t length) {
+        auto is = [&](const char* name) { return length == strlen(name) && memcmp(key, name, length) == 0; };
+        if (context_ == Context::Keys) {
+            return is("n") ? Field::N : is("k") ? Field::K : is("prime") ? Field::Prime : Field::Skip;
+        }
+        if (context_ == Context::Share) return is("base") ? Field::Base : is("value") ? Field::Value : Field::Skip;
+
+        if (length > 0 && length <= 18 && key[0] >= '1' && key[0] <= '9') {
+            long long id = 0;
+            size_t i = 0;
+            for (; i < length && key[i] >= '0' && key[i] <= '9'; i++) id = id * 10 + (key[i] - '0');
+            if (i == length) {
+                share_ = ParsedShare();
+                share_.id = id;
+                return Field::Share;
+            }
+        }
+        if (is("keys")) return Field::Keys;
+        if (!strict_ && (is("n") || is("k") || is("prime"))) {
+            return is("n") ? Field::N : is("k") ? Field::K : Field::Prime;
+        }
+        return Field::Skip;
+    }
+
+    bool closeObject() {
+        if (context_ == Context::Root) {
+            if (strict_ && !sawKeys_) return fail("\"keys\"");
+            pos_++;
+            state_ = State::Done;
+            return true;
+        }
+        if (context_ == Context::Keys) {
+            if (strict_ && !(sawN_ && sawK_)) return fail("\"n\" and \"k\"");
+        } else {
+            if (strict_ && !(sawBase_ && sawValue_)) return fail("\"base\" and \"value\"");
+            share_.objectLength = pos_ + 1 - shareStart_;
+            if (sawBase_ && sawValue_) document_.shares.push_back(share_);
+        }
+        pos_++;
+        context_ = Context::Root;
+        state_ = State::Next;
+        return true;
+    }
+};
+
+} // namespace
+
+const char* parseModeName(ParseMode mode) {
+    return mode == ParseMode::Strict ? "strict" : "lenient";
+}
+
+bool parseShareDocument(const string& json, ParseMode mode, ShareDocument& document) {
+    document.n = document.k = -1;
+    document.primeOffset = document.primeLength = 0;
+    document.shares.clear();
+    document.error.clear();
+    document.errorOffset = 0;
+    if (!ShareDocumentParser(json, mode, document).run()) return false;
+
+    // Generated and hand-written documents list ids in order; sort otherwise
+    vector<ParsedShare>& shares = document.shares;
+    auto byId = [](const ParsedShare& a, const ParsedShare& b) { return a.id < b.id; };
+    if (!is_sorted(shares.begin(), shares.end(), byId)) stable_sort(shares.begin(), shares.end(), byId);
+    auto repeated = adjacent_find(shares.begin(), shares.end(),
+                                  [](const ParsedShare& a, const ParsedShare& b) { return a.id == b.id; });
+    if (repeated == shares.end()) return true;
+    if (mode == ParseMode::Strict) {
+        document.errorOffset = (repeated + 1)->keyOffset;
+        document.error = "expected no repeated share id (" + to_string(repeated->id) + ") at byte " +
+                         to_string(document.errorOffset);
+        return false;
+    }
+    shares.erase(unique(shares.begin(), shares.end(),
+                        [](const ParsedShare& a, const ParsedShare& b) { return a.id == b.id; }),
+                 shares.end());
+    return true;
+}
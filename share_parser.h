@@ -0,0 +1,80 @@
+/**
+ * Polynomial Solver - share document parser
+ *
+ * Reads the one document shape the solver takes,
+ *
+ *   {"keys": {"n": <int>, "k": <int>}, "<id>": {"base": "<b>", "value": "<digits>"}, ...}
+ *
+ * in a single pass over the bytes. A small state machine (which object we
+ * are in, what token comes next) replaces the repeated key searches of the
+ * old extractors; no generic JSON tree is built and nothing is copied. The
+ * result points into the document by byte offset.
+ *
+ * "keys" may also hold "prime": "<decimal>" for shares taken modulo that
+ * prime (as --generate --gen-prime writes them).
+ *
+ * Both modes stop at the first syntax error (unbalanced braces, a missing
+ * ':' or ',', an unterminated string) and report its byte offset.
+ *
+ *   Strict    exactly the shape above: no unknown or repeated members, base
+ *             and value strings in every share, n and k plain integers, a
+ *             decimal prime string, no escapes, nothing after the closing
+ *             brace
+ *   Lenient   (default) what the solver always accepted: unknown members
+ *             are skipped, n/k/prime may also sit at the top level, numbers
+ *             for base, value and prime, a trailing comma, shares missing
+ *             base or value are dropped, the first of repeated ids (and
+ *             keys) wins, and text after the document is ignored
+ */
+
+#ifndef SHARE_PARSER_H
+#define SHARE_PARSER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+enum class ParseMode {
+    Lenient,
+    Strict
+};
+
+/**
+ * Lowercase name, "lenient" or "strict"
+ */
+const char* parseModeName(ParseMode mode);
+
+/**
+ * One share member, as byte ranges of the document
+ */
+struct ParsedShare {
+    long long id;               // the member key
+    std::size_t keyOffset;      // its opening quote
+    std::size_t objectLength;   // '{' through '}'
+    std::size_t baseOffset;     // base text, without quotes
+    std::size_t baseLength;
+    std::size_t valueOffset;    // digits, without quotes
+    std::size_t valueLength;
+};
+
+struct ShareDocument {
+    int n = -1;                         // -1 when absent or not an integer
+    int k = -1;
+    std::size_t primeOffset = 0;        // prime text, without quotes; no prime
+    std::size_t primeLength = 0;        // when the length is 0
+    std::vector<ParsedShare> shares;    // ascending id, one per id
+    std::string error;                  // why parsing stopped, with the byte offset
+    std::size_t errorOffset = 0;
+};
+
+/**
+ * Parse a share document; the vectors of document keep their capacity
+ * @param json: The document
+ * @param mode: Strict or lenient, see above
+ * @param document: Overwritten; byte ranges refer to json
+ * @return: false on a syntax error, or on any departure from the schema in
+ *          strict mode; document.error then says what was expected where
+ */
+bool parseShareDocument(const std::string& json, ParseMode mode, ShareDocument& document);
+
+#endif // SHARE_PARSER_H
@@ -0,0 +1,225 @@
+/**
+ * Polynomial Solver - per-phase statistics implementation
+ */
+
+#include "stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <ostream>
+
+using namespace std;
+
+namespace {
+
+StatsPhase statsPhase(SolvePhase phase) {
+    switch (phase) {
+        case SolvePhase::Parse:       return StatsPhase::Parse;
+        case SolvePhase::Convert:     return StatsPhase::Convert;
+        case SolvePhase::Interpolate: return StatsPhase::Interpolate;
+        case SolvePhase::Verify:      return StatsPhase::Verify;
+    }
+    return StatsPhase::Parse;
+}
+
+/**
+ * Points the thread's allocation slot at the running solver phase and
+ * back at the enclosing one (Convert nests in Parse) when it ends
+ */
+class AllocPhaseObserver : public SolveObserver {
+public:
+    void phaseBegin(SolvePhase phase) override {
+        int previous = alloc_accounting::setSlot((int)statsPhase(phase));
+        if (depth_ < kMaxDepth) saved_[depth_] = previous;
+        depth_++;
+    }
+    void phaseEnd(SolvePhase) override {
+        if (depth_ == 0) return;
+        depth_--;
+        if (depth_ < kMaxDepth) alloc_accounting::setSlot(saved_[depth_]);
+    }
+
+private:
+    static constexpr int kMaxDepth = 4;
+    int saved_[kMaxDepth] = {};
+    int depth_ = 0;
+};
+
+} // namespace
+
+void Histogram::record(uint64_t value) {
+    int bucket = value == 0 ? 0 : 64 - __builtin_clzll(value);
+    buckets_[bucket]++;
+    min_ = count_ == 0 ? value : std::min(min_, value);
+    max_ = std::max(max_, value);
+    count_++;
+    sum_ += value;
+}
+
+uint64_t Histogram::bucketLimit(int bucket) {
+    return bucket >= 64 ? UINT64_MAX : (uint64_t)1 << bucket;
+}
+
+uint64_t Histogram::quantile(double q) const {
+    if (count_ == 0) return 0;
+    uint64_t rank = std::max<uint64_t>(1, (uint64_t)ceil(q * (double)count_));
+    uint64_t seen = 0;
+    for (int bucket = 0; bucket < kBuckets; bucket++) {
+        seen += buckets_[bucket];
+        if (seen >= rank) return std::min(bucketLimit(bucket), max_);
+    }
+    return max_;
+}
+
+void Histogram::writeJson(ostream& out) const {
+    out << "{\"count\":" << count_ << ",\"sum\":" << sum_ << ",\"min\":" << min() << ",\"max\":" << max_
+        << ",\"p50\":" << quantile(0.5) << ",\"p99\":" << quantile(0.99) << ",\"buckets\":[";
+    bool first = true;
+    for (int bucket = 0; bucket < kBuckets; bucket++) {
+        if (buckets_[bucket] == 0) continue;
+        out << (first ? "" : ",") << "[" << bucketLimit(bucket) << "," << buckets_[bucket] << "]";
+        first = false;
+    }
+    out << "]}";
+}
+
+const char* statsPhaseName(StatsPhase phase) {
+    switch (phase) {
+        case StatsPhase::Read:        return "read";
+        case StatsPhase::Parse:       return "parse";
+        case StatsPhase::Convert:     return "convert";
+        case StatsPhase::Interpolate: return "interpolate";
+        case StatsPhase::Verify:      return "verify";
+        case StatsPhase::Output:      return "output";
+    }
+    return "unknown";
+}
+
+SolveObserver* SolveStats::attachCounters() {
+    counters_.reset(new PerfCounterGroup());
+    if (!counters_->available()) return nullptr;
+    observer_.reset(new PerfPhaseObserver(*counters_));
+    return observer_.get();
+}
+
+SolveObserver* SolveStats::attachAllocations() {
+    static_assert(kStatsPhaseCount < alloc_accounting::kUnattributed, "one slot per phase");
+    allocObserver_.reset(new AllocPhaseObserver());
+    for (int slot = 0; slot < alloc_accounting::kSlots; slot++) allocSeen_[slot] = alloc_accounting::read(slot);
+    alloc_accounting::enable(true);
+    return allocObserver_.get();
+}
+
+void SolveStats::enterPhase(StatsPhase phase) {
+    if (allocObserver_) alloc_accounting::setSlot((int)phase);
+}
+
+void SolveStats::record(const SolveResult& result, uint64_t readNs, uint64_t outputNs) {
+    documents_++;
+    if (!result.ok()) failures_++;
+
+    // How far the solve got: keys are checked before any share is parsed,
+    // interpolation needs k shares, verification a successful interpolation
+    bool parsed = result.status != SolveStatus::EmptyInput && result.status != SolveStatus::InvalidKeys &&
+                  result.status != SolveStatus::MalformedDocument;
+    bool interpolated = result.ok() || result.status == SolveStatus::InterpolationFailed;
+
+    phases_[(int)StatsPhase::Read].record(readNs);
+    if (parsed) {
+        phases_[(int)StatsPhase::Parse].record(result.timings.parseNs);
+        phases_[(int)StatsPhase::Convert].record(result.timings.convertNs);
+    }
+    if (interpolated) phases_[(int)StatsPhase::Interpolate].record(result.timings.interpolateNs);
+    if (result.ok()) phases_[(int)StatsPhase::Verify].record(result.timings.verifyNs);
+    phases_[(int)StatsPhase::Output].record(outputNs);
+    total_.record(readNs + result.timings.totalNs + outputNs);
+
+    shareBytes_.record(result.counters.shareBytes);
+    digitsDecoded_.record(result.counters.digitsDecoded);
+    limbsTouched_.record(result.counters.limbsTouched);
+
+    if (allocObserver_) {
+        for (int phase = 0; phase < kStatsPhaseCount; phase++) {
+            alloc_accounting::Counts now = alloc_accounting::read(phase);
+            allocPerDocument_[phase].record(now.allocations - allocSeen_[phase].allocations);
+            allocSeen_[phase] = now;
+        }
+    }
+
+    if (observer_) {
+        for (int phase = 0; phase < kSolvePhaseCount; phase++) {
+            hardware_[phase] += observer_->phase((SolvePhase)phase);
+        }
+        hardwareShares_ += result.counters.sharesDecoded;
+        observer_->reset();
+    }
+}
+
+void SolveStats::writeJson(ostream& out) const {
+    out << "{\"stats\":\"polynomial_solver\",\"documents\":" << documents_ << ",\"failures\":" << failures_
+        << ",\"phases_ns\":{";
+    for (int phase = 0; phase < kStatsPhaseCount; phase++) {
+        out << (phase ? "," : "") << "\"" << statsPhaseName((StatsPhase)phase) << "\":";
+        phases_[phase].writeJson(out);
+    }
+    out << ",\"total\":";
+    total_.writeJson(out);
+    out << "},\"counters\":{\"share_bytes\":";
+    shareBytes_.writeJson(out);
+    out << ",\"digits_decoded\":";
+    digitsDecoded_.writeJson(out);
+    out << ",\"limbs_touched\":";
+    limbsTouched_.writeJson(out);
+    out << "}";
+
+    if (counters_) {
+        out << ",\"hardware\":{\"available\":" << (observer_ ? "true" : "false");
+        if (!observer_) {
+            out << ",\"reason\":\"" << counters_->unavailableReason() << "\"}";
+        } else {
+            out << ",\"shares\":" << hardwareShares_ << ",\"phases\":{";
+            double shares = (double)max<uint64_t>(hardwareShares_, 1);
+            for (int phase = 0; phase < kSolvePhaseCount; phase++) {
+                const HardwareCounts& counts = hardware_[phase];
+                out << (phase ? "," : "") << "\"" << solvePhaseName((SolvePhase)phase) << "\":{";
+                for (int event = 0; event < kHardwareEventCount; event++) {
+                    out << "\"" << hardwareEventName((HardwareEvent)event) << "\":";
+                    if (counters_->has((HardwareEvent)event)) {
+                        out << counts.values[event];
+                    } else {
+                        out << "null";
+                    }
+                    out << ",";
+                }
+                out << "\"ipc\":" << counts.ipc();
+                for (HardwareEvent event : {HardwareEvent::CacheMisses, HardwareEvent::BranchMisses}) {
+                    out << ",\"" << hardwareEventName(event) << "_per_share\":";
+                    if (counters_->has(event)) {
+                        out << (double)counts[event] / shares;
+                    } else {
+                        out << "null";
+                    }
+                }
+                out << "}";
+            }
+            out << "}}";
+        }
+    }
+
+    if (allocObserver_) {
+        out << ",\"allocations\":{";
+        for (int slot = 0; slot <= kStatsPhaseCount; slot++) {
+            bool phase = slot < kStatsPhaseCount;
+            alloc_accounting::Counts counts = alloc_accounting::read(phase ? slot : alloc_accounting::kUnattributed);
+            out << (slot ? "," : "") << "\"" << (phase ? statsPhaseName((StatsPhase)slot) : "unattributed")
+                << "\":{\"allocations\":" << counts.allocations << ",\"bytes\":" << counts.bytes;
+            if (phase) {
+                out << ",\"per_document\":";
+                allocPerDocument_[slot].writeJson(out);
+            }
+            out << "}";
+        }
+        out << "}";
+    }
+    out << "}\n";
+}
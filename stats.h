@@ -0,0 +1,129 @@
+/**
+ * Polynomial Solver - per-phase statistics (--stats)
+ *
+ * Aggregates the phase timings and work counters of every solve in a run
+ * into log2 histograms and dumps them as one JSON object at exit, so a
+ * slow batch can be attributed to reading, parsing, conversion,
+ * interpolation, verification or output.
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include "alloc_accounting.h"
+#include "perf_counters.h"
+#include "polynomial_solver.h"
+
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+
+/**
+ * Power-of-two histogram of unsigned values: bucket 0 counts zeros and
+ * bucket b counts values in [2^(b-1), 2^b)
+ */
+class Histogram {
+public:
+    static constexpr int kBuckets = 65;
+
+    void record(std::uint64_t value);
+
+    std::uint64_t count() const { return count_; }
+    std::uint64_t sum() const { return sum_; }
+    std::uint64_t min() const { return count_ ? min_ : 0; }
+    std::uint64_t max() const { return max_; }
+    std::uint64_t bucketCount(int bucket) const { return buckets_[bucket]; }
+
+    /**
+     * Exclusive upper bound of a bucket (1 for the zero bucket)
+     */
+    static std::uint64_t bucketLimit(int bucket);
+
+    /**
+     * Upper bound of the bucket holding the q-th quantile, capped at max()
+     * @param q: Quantile in [0, 1]
+     */
+    std::uint64_t quantile(double q) const;
+
+    /**
+     * {"count":..,"sum":..,"min":..,"max":..,"p50":..,"p99":..,
+     *  "buckets":[[limit,count],...]} with empty buckets left out
+     */
+    void writeJson(std::ostream& out) const;
+
+private:
+    std::uint64_t count_ = 0;
+    std::uint64_t sum_ = 0;
+    std::uint64_t min_ = 0;
+    std::uint64_t max_ = 0;
+    std::uint64_t buckets_[kBuckets] = {};
+};
+
+enum class StatsPhase { Read, Parse, Convert, Interpolate, Verify, Output };
+constexpr int kStatsPhaseCount = 6;
+
+const char* statsPhaseName(StatsPhase phase);
+
+class SolveStats {
+public:
+    /**
+     * Open hardware counters for the calling thread. The returned observer
+     * (owned by this object) must be installed on the solver whose results
+     * are recorded. When the counters cannot be opened this returns null
+     * and the JSON reports why instead.
+     */
+    SolveObserver* attachCounters();
+
+    /**
+     * Start counting allocations per phase (see alloc_accounting.h); the
+     * returned observer (owned by this object) attributes the solver's
+     * phases and must be installed like the counters one. Reading and
+     * output are attributed through enterPhase().
+     */
+    SolveObserver* attachAllocations();
+
+    /**
+     * Attribute the calling thread's allocations to a phase from now on
+     * (no-op unless attachAllocations() was called)
+     */
+    void enterPhase(StatsPhase phase);
+
+    /**
+     * Add one solve. Phases the solve never reached (e.g. interpolation
+     * after a parse failure) are not counted.
+     * @param readNs: Time spent reading this document's bytes
+     * @param outputNs: Time spent formatting its result
+     */
+    void record(const SolveResult& result, std::uint64_t readNs, std::uint64_t outputNs);
+
+    std::uint64_t documents() const { return documents_; }
+    const Histogram& phase(StatsPhase phase) const { return phases_[(int)phase]; }
+
+    /**
+     * Single-line JSON object: documents, failures, then per-phase time
+     * histograms (ns), per-document counter histograms and, when attached,
+     * hardware totals per phase with IPC and misses per share and
+     * allocation totals per phase with a per-document histogram
+     */
+    void writeJson(std::ostream& out) const;
+
+private:
+    std::unique_ptr<PerfCounterGroup> counters_;
+    std::unique_ptr<PerfPhaseObserver> observer_;
+    HardwareCounts hardware_[kSolvePhaseCount];
+    std::uint64_t hardwareShares_ = 0;
+
+    std::unique_ptr<SolveObserver> allocObserver_;
+    alloc_accounting::Counts allocSeen_[alloc_accounting::kSlots];   // totals at the last record()
+    Histogram allocPerDocument_[kStatsPhaseCount];
+
+    std::uint64_t documents_ = 0;
+    std::uint64_t failures_ = 0;
+    Histogram phases_[kStatsPhaseCount];
+    Histogram total_;
+    Histogram shareBytes_;
+    Histogram digitsDecoded_;
+    Histogram limbsTouched_;
+};
+
+#endif // STATS_H
@@ -0,0 +1,108 @@
+/**
+ * Polynomial Solver - timeline export implementation
+ */
+
+#include "trace.h"
+
+#include <atomic>
+#include <cstdio>
+#include <stdexcept>
+#include <unistd.h>
+
+using namespace std;
+
+namespace {
+
+/**
+ * Microseconds with nanosecond resolution, as Chrome's "ts"/"dur" expect
+ */
+string micros(uint64_t ns) {
+    char text[32];
+    snprintf(text, sizeof text, "%llu.%03llu", (unsigned long long)(ns / 1000), (unsigned long long)(ns % 1000));
+    return text;
+}
+
+} // namespace
+
+string traceEscape(const string& text) {
+    string escaped;
+    escaped.reserve(text.size());
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if ((unsigned char)c < 0x20) {
+            char code[8];
+            snprintf(code, sizeof code, "\\u%04x", (unsigned)c);
+            escaped += code;
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+TraceWriter::TraceWriter(const string& path) : out_(path), origin_(chrono::steady_clock::now()) {
+    if (!out_.is_open()) throw runtime_error("Cannot write trace: " + path);
+    out_ << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    writeEventPrefix("M", 0);
+    out_ << ",\"name\":\"process_name\",\"args\":{\"name\":\"polynomial_solver\"}}";
+}
+
+TraceWriter::~TraceWriter() {
+    finish();
+}
+
+uint64_t TraceWriter::now() const {
+    return (uint64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - origin_).count();
+}
+
+int TraceWriter::threadId() {
+    // Small stable ids read better in the viewer than kernel tids
+    static atomic<int> next{1};
+    thread_local int id = next++;
+    return id;
+}
+
+void TraceWriter::writeEventPrefix(const char* phase, int tid) {
+    out_ << (first_ ? "\n" : ",\n") << "{\"ph\":\"" << phase << "\",\"pid\":" << getpid() << ",\"tid\":" << tid;
+    first_ = false;
+}
+
+void TraceWriter::nameThread(const string& name) {
+    int tid = threadId();
+    lock_guard<mutex> lock(mutex_);
+    if (finished_) return;
+    writeEventPrefix("M", tid);
+    out_ << ",\"name\":\"thread_name\",\"args\":{\"name\":\"" << traceEscape(name) << "\"}}";
+}
+
+void TraceWriter::complete(const string& name, const char* category, uint64_t startNs, uint64_t endNs,
+                           const string& args) {
+    int tid = threadId();
+    lock_guard<mutex> lock(mutex_);
+    if (finished_) return;
+    writeEventPrefix("X", tid);
+    out_ << ",\"name\":\"" << traceEscape(name) << "\",\"cat\":\"" << category << "\",\"ts\":" << micros(startNs)
+         << ",\"dur\":" << micros(endNs > startNs ? endNs - startNs : 0);
+    if (!args.empty()) out_ << ",\"args\":{" << args << "}";
+    out_ << "}";
+}
+
+bool TraceWriter::finish() {
+    lock_guard<mutex> lock(mutex_);
+    if (!finished_) {
+        out_ << "\n]}\n";
+        out_.flush();
+        finished_ = true;
+    }
+    return (bool)out_;
+}
+
+void TracePhaseObserver::phaseBegin(SolvePhase phase) {
+    started_[(int)phase] = trace_.now();
+}
+
+void TracePhaseObserver::phaseEnd(SolvePhase phase) {
+    trace_.complete(solvePhaseName(phase), "phase", started_[(int)phase], trace_.now());
+}
@@ -0,0 +1,92 @@
+/**
+ * Polynomial Solver - timeline export (--trace)
+ *
+ * Writes Chrome trace format events ({"traceEvents":[...]}, loadable in
+ * chrome://tracing and ui.perfetto.dev): one complete event per document,
+ * nested events for reading, each solver phase and output, and a named
+ * track per thread. Safe to use from several threads; events are written
+ * as they finish, so a long run streams to disk instead of piling up.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "polynomial_solver.h"
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+
+class TraceWriter {
+public:
+    /**
+     * @throws runtime_error: When the file cannot be created
+     */
+    explicit TraceWriter(const std::string& path);
+
+    /**
+     * Closes the event array; see finish()
+     */
+    ~TraceWriter();
+
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    /**
+     * Nanoseconds since the trace started, the time base of every event
+     */
+    std::uint64_t now() const;
+
+    /**
+     * Label the calling thread's track (e.g. "main", "worker 2")
+     */
+    void nameThread(const std::string& name);
+
+    /**
+     * Event spanning [startNs, endNs) on the calling thread's track
+     * @param args: Contents of the "args" object (already JSON), or empty
+     */
+    void complete(const std::string& name, const char* category, std::uint64_t startNs,
+                  std::uint64_t endNs, const std::string& args = "");
+
+    /**
+     * Terminate the JSON and flush
+     * @return: false when any write failed
+     */
+    bool finish();
+
+private:
+    std::ofstream out_;
+    std::mutex mutex_;
+    std::chrono::steady_clock::time_point origin_;
+    bool first_ = true;
+    bool finished_ = false;
+
+    int threadId();
+    void writeEventPrefix(const char* phase, int tid);
+};
+
+/**
+ * Emits one event per solver phase (and per share conversion) of the
+ * solves it observes, on the solving thread's track
+ */
+class TracePhaseObserver : public SolveObserver {
+public:
+    explicit TracePhaseObserver(TraceWriter& trace) : trace_(trace) {}
+
+    void phaseBegin(SolvePhase phase) override;
+    void phaseEnd(SolvePhase phase) override;
+
+private:
+    TraceWriter& trace_;
+    std::uint64_t started_[kSolvePhaseCount] = {};
+};
+
+/**
+ * Escape a string for use inside a JSON string literal
+ */
+std::string traceEscape(const std::string& text);
+
+#endif // TRACE_H
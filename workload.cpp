@@ -0,0 +1,182 @@
+/**
+ * Polynomial Solver - synthetic share document implementation
+ */
+
+#include "workload.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+
+using namespace std;
+
+BigInt WorkloadGenerator::randomValue(size_t digits) {
+    string text(digits, '0');
+    text[0] = (char)('1' + rng_() % 9);
+    for (size_t i = 1; i < digits; i++) text[i] = (char)('0' + rng_() % 10);
+    return BigInt::fromString(text, 10);
+}
+
+GeneratedDocument WorkloadGenerator::next(const WorkloadSpec& spec) {
+    if (spec.n < 1 || spec.k < 1 || spec.k > spec.n) {
+        throw invalid_argument("Invalid n=" + to_string(spec.n) + " or k=" + to_string(spec.k));
+    }
+    if (spec.bases.empty() || spec.digits == 0) {
+        throw invalid_argument("Workload needs at least one base and one digit");
+    }
+    for (int base : spec.bases) {
+        if (base < 2 || base > 16) throw invalid_argument("Invalid base: " + to_string(base));
+    }
+    if (!(spec.corruptFraction >= 0.0 && spec.corruptFraction <= 1.0)) {
+        throw invalid_argument("Corrupt fraction must be between 0 and 1");
+    }
+    bool modular = !spec.prime.isZero();
+    if (modular && (spec.prime.isNegative() || !(BigInt(spec.n) < spec.prime))) {
+        throw invalid_argument("Prime must be larger than n");
+    }
+
+    BigInt quotient, remainder;
+    auto reduce = [&](BigInt& value) {
+        if (!modular) return;
+        BigInt::divMod(value, spec.prime, quotient, remainder);
+        value = remainder;
+    };
+
+    vector<BigInt> coefficients;
+    coefficients.reserve((size_t)spec.k);
+    for (int i = 0; i < spec.k; i++) {
+        coefficients.push_back(randomValue(spec.digits));
+        reduce(coefficients.back());
+    }
+
+    GeneratedDocument document;
+    document.n = spec.n;
+    document.k = spec.k;
+    document.prime = spec.prime;
+    document.secret = coefficients[0];
+
+    // Pick the corrupted ids up front (partial Fisher-Yates)
+    size_t corruptCount = (size_t)llround(spec.corruptFraction * spec.n);
+    vector<bool> corrupt((size_t)spec.n + 1, false);
+    if (corruptCount > 0) {
+        vector<int> ids((size_t)spec.n);
+        for (int i = 0; i < spec.n; i++) ids[(size_t)i] = i + 1;
+        for (size_t i = 0; i < corruptCount; i++) {
+            size_t j = i + (size_t)(rng_() % (ids.size() - i));
+            swap(ids[i], ids[j]);
+            corrupt[(size_t)ids[i]] = true;
+            document.corruptedIds.push_back(ids[i]);
+        }
+        sort(document.corruptedIds.begin(), document.corruptedIds.end());
+    }
+
+    document.shares.reserve((size_t)spec.n);
+    for (int x = 1; x <= spec.n; x++) {
+        // Horner; coefficients and x are positive, so every share is too
+        BigInt y = coefficients.back();
+        for (size_t j = coefficients.size() - 1; j-- > 0;) {
+            y *= (long long)x;
+            y += coefficients[j];
+            reduce(y);
+        }
+        if (corrupt[(size_t)x]) {
+            BigInt original = y;
+            y += BigInt((long long)(rng_() % 1000000 + 1));
+            reduce(y);
+            if (y == original) {    // the offset was a multiple of the prime
+                y += BigInt(1);
+                reduce(y);
+            }
+        }
+
+        int base = spec.bases[spec.bases.size() == 1 ? 0 : rng_() % spec.bases.size()];
+        document.shares.push_back({x, base, y.toString(base)});
+    }
+    return document;
+}
+
+string GeneratedDocument::toJson(bool compact) const {
+    size_t estimate = 64;
+    for (const GeneratedShare& share : shares) estimate += share.value.size() + 48;
+    string json;
+    json.reserve(estimate);
+
+    const char* open = compact ? "{" : "{\n";
+    const char* indent = compact ? "" : "    ";
+    const char* indent2 = compact ? "" : "        ";
+    const char* colon = compact ? ":" : ": ";
+    const char* separator = compact ? "," : ",\n";
+
+    json += open;
+    json += indent;
+    json += "\"keys\"";
+    json += colon;
+    json += open;
+    json += indent2;
+    json += "\"n\"";
+    json += colon;
+    json += to_string(n);
+    json += separator;
+    json += indent2;
+    json += "\"k\"";
+    json += colon;
+    json += to_string(k);
+    if (!prime.isZero()) {
+        json += separator;
+        json += indent2;
+        json += "\"prime\"";
+        json += colon;
+        json += "\"" + prime.toString() + "\"";
+    }
+    json += compact ? "}" : "\n    }";
+
+    for (const GeneratedShare& share : shares) {
+        json += separator;
+        json += indent;
+        json += "\"" + to_string(share.id) + "\"";
+        json += colon;
+        json += open;
+        json += indent2;
+        json += "\"base\"";
+        json += colon;
+        json += "\"" + to_string(share.base) + "\"";
+        json += separator;
+        json += indent2;
+        json += "\"value\"";
+        json += colon;
+        json += "\"" + share.value + "\"";
+        json += compact ? "}" : "\n    }";
+    }
+    json += compact ? "}" : "\n}";
+    return json;
+}
+
+bool parseDocumentFormat(const string& name, DocumentFormat& format) {
+    if (name == "json")   { format = DocumentFormat::JSON;   return true; }
+    if (name == "ndjson") { format = DocumentFormat::NDJSON; return true; }
+    if (name == "binary") { format = DocumentFormat::Binary; return true; }
+    return false;
+}
+
+void writeDocument(ostream& out, const GeneratedDocument& document, DocumentFormat format, bool first) {
+    switch (format) {
+        case DocumentFormat::JSON:
+            out << document.toJson(false) << '\n';
+            break;
+        case DocumentFormat::NDJSON:
+            out << document.toJson() << '\n';
+            break;
+        case DocumentFormat::Binary: {
+            if (first) out.write("PSDOCS1\0", 8);
+            string json = document.toJson();
+            uint32_t length = (uint32_t)json.size();
+            char bytes[sizeof length];
+            memcpy(bytes, &length, sizeof length);   // little-endian hosts only, as in output_writer
+            out.write(bytes, sizeof bytes);
+            out.write(json.data(), (streamsize)json.size());
+            break;
+        }
+    }
+}
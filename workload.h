@@ -0,0 +1,93 @@
+/**
+ * Polynomial Solver - synthetic share documents
+ *
+ * Builds valid share documents from random polynomials with a known secret,
+ * reproducibly from a seed: over the integers or modulo a prime, with an
+ * optional fraction of deliberately corrupted shares. Used by --generate,
+ * the benchmark harness and tests that need inputs larger than the two
+ * built-in cases.
+ */
+
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include "bigint.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * Shape of one generated document
+ */
+struct WorkloadSpec {
+    int n = 10;                     // shares written, ids 1..n
+    int k = 3;                      // threshold; the polynomial has degree k-1
+    std::vector<int> bases = {10};  // each share picks one of these at random
+    size_t digits = 20;             // decimal digits per coefficient (secret included)
+    BigInt prime;                   // nonzero: coefficients and shares reduced mod prime
+    double corruptFraction = 0.0;   // share of values replaced by wrong ones (0-1)
+};
+
+struct GeneratedShare {
+    int id;
+    int base;
+    std::string value;
+};
+
+struct GeneratedDocument {
+    int n = 0;
+    int k = 0;
+    BigInt prime;                   // zero for integer shares
+    BigInt secret;                  // P(0) (mod prime)
+    std::vector<GeneratedShare> shares;
+    std::vector<int> corruptedIds;  // ascending
+
+    /**
+     * Render as a share document; compact is a single line without a
+     * trailing newline, otherwise the indented layout of testcase1.json.
+     * A prime is written as "keys": {..., "prime": "<decimal>"}.
+     */
+    std::string toJson(bool compact = true) const;
+};
+
+/**
+ * Deterministic document source: the same seed and the same sequence of
+ * specs always produce the same documents
+ */
+class WorkloadGenerator {
+public:
+    explicit WorkloadGenerator(std::uint64_t seed) : rng_(seed) {}
+
+    /**
+     * Next document for the spec
+     * @throws invalid_argument: For n < 1, k outside 1..n, an empty base
+     *         list, a base outside 2-16, zero digits, a corrupt fraction
+     *         outside 0-1 or a prime not above n
+     */
+    GeneratedDocument next(const WorkloadSpec& spec);
+
+private:
+    std::mt19937_64 rng_;
+
+    BigInt randomValue(size_t digits);
+};
+
+enum class DocumentFormat {
+    JSON,       // indented documents, one after another
+    NDJSON,     // one compact document per line (--batch input)
+    Binary      // "PSDOCS1\0", then per document: u32 length, compact JSON bytes
+};
+
+bool parseDocumentFormat(const std::string& name, DocumentFormat& format);
+
+/**
+ * Append one document; the binary magic is written before the first one
+ */
+void writeDocument(std::ostream& out, const GeneratedDocument& document, DocumentFormat format,
+                   bool first);
+
+#endif // WORKLOAD_H